@@ -0,0 +1,541 @@
+// Host microbenchmarks for the Arduino-free core: protocol, poller,
+// history, graph scaling, formatting, alerts, trip statistics, the
+// fleet scheduler, the speed filter, the screen layout interpreter, the
+// loop latency histogram and the per-pack cell decode
+//
+//   g++ -O2 -Iinclude bench/core_bench.cpp src/M365Protocol.cpp src/M365Poller.cpp src/CellPack.cpp src/HistoryStore.cpp src/GraphScale.cpp src/FastFormat.cpp src/TelemetryFields.cpp src/AlertEngine.cpp src/TripStats.cpp src/FleetScheduler.cpp src/SpeedFilter.cpp src/ScreenLayout.cpp src/LogEncoder.cpp src/LatencyHistogram.cpp -o core_bench
+//   ./core_bench [--json out.json] [--filter name] [--min-ms 50]
+//
+// or through PlatformIO: pio run -e native && .pio/build/native/program
+//
+// Each case is calibrated to run for at least --min-ms, then measured
+// five times; the median is reported as ns/op. Heap allocations made
+// inside the timed loop are counted through operator new and, on glibc,
+// malloc. The JSON output keeps a fixed field order and case order so
+// two runs can be diffed with tools/bench_compare.py.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "M365Protocol.h"
+#include "M365Poller.h"
+#include "CellPack.h"
+#include "HistoryStore.h"
+#include "GraphScale.h"
+#include "FastFormat.h"
+#include "TelemetryFields.h"
+#include "AlertEngine.h"
+#include "TripStats.h"
+#include "FleetScheduler.h"
+#include "SpeedFilter.h"
+#include "ScreenLayout.h"
+#include "layout_classic.h"
+#include "LatencyHistogram.h"
+
+#define BENCH_SCHEMA    1
+#define BENCH_SAMPLES   5
+
+// ========== Allocation counting ==========
+static uint64_t allocCount = 0;
+
+#ifdef __GLIBC__
+// Count C allocations too; operator new goes straight to glibc so it
+// isn't counted twice
+extern "C" void* __libc_malloc(size_t n);
+extern "C" void* malloc(size_t n) {
+    allocCount++;
+    return __libc_malloc(n);
+}
+#define RAW_MALLOC  __libc_malloc
+#else
+#define RAW_MALLOC  malloc
+#endif
+
+void* operator new(size_t n) {
+    allocCount++;
+    void* p = RAW_MALLOC(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t n) {
+    allocCount++;
+    void* p = RAW_MALLOC(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Keeps results alive without a memory barrier on every iteration
+static volatile uint32_t sink;
+
+// ========== Harness ==========
+struct Result {
+    const char* name;
+    double nsPerOp;
+    double allocsPerOp;
+    uint64_t iterations;
+};
+
+typedef void (*BenchFn)(uint64_t iterations);
+
+struct Case {
+    const char* name;
+    BenchFn fn;
+};
+
+static double runOnce(BenchFn fn, uint64_t iterations, uint64_t& allocs) {
+    uint64_t before = allocCount;
+    auto start = std::chrono::steady_clock::now();
+    fn(iterations);
+    auto end = std::chrono::steady_clock::now();
+    allocs = allocCount - before;
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static Result measure(const Case& c, double minMs) {
+    uint64_t allocs;
+    uint64_t iterations = 1;
+    // Grow until one run is long enough to time reliably
+    for (;;) {
+        double ns = runOnce(c.fn, iterations, allocs);
+        if (ns >= minMs * 1e6 || iterations >= (1ULL << 40)) break;
+        double scale = ns > 0 ? minMs * 1e6 / ns : 100;
+        iterations = (uint64_t)(iterations * (scale < 100 ? scale * 1.2 + 1 : 100));
+    }
+
+    double samples[BENCH_SAMPLES];
+    uint64_t allocTotal = 0;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        samples[i] = runOnce(c.fn, iterations, allocs) / iterations;
+        allocTotal += allocs;
+    }
+    std::sort(samples, samples + BENCH_SAMPLES);
+
+    Result r;
+    r.name = c.name;
+    r.nsPerOp = samples[BENCH_SAMPLES / 2];
+    r.allocsPerOp = (double)allocTotal / (iterations * BENCH_SAMPLES);
+    r.iterations = iterations;
+    return r;
+}
+
+// ========== Fixtures ==========
+static uint8_t makeFrame(uint8_t* out, uint8_t addr, uint8_t reg, const uint8_t* data, uint8_t n) {
+    out[0] = 0x55;
+    out[1] = 0xAA;
+    out[2] = n + 2;
+    out[3] = addr;
+    out[4] = CMD_READ;
+    out[5] = reg;
+    memcpy(out + 6, data, n);
+    uint16_t sum = M365Protocol::checksum(out + 2, n + 4);
+    out[6 + n] = sum & 0xFF;
+    out[7 + n] = sum >> 8;
+    return 8 + n;
+}
+
+static uint8_t speedFrame[16];
+static uint8_t speedFrameLen;
+static uint8_t cellsFrame[40];
+static uint8_t cellsFrameLen;
+static std::vector<uint8_t> mixedStream;
+static uint32_t mixedFrames;
+
+static HistoryStore history;
+static HistoryBucket series[HISTORY_MAX_SIZE];
+static uint16_t seriesLen;
+
+static ScooterData sample(uint32_t i) {
+    ScooterData d;
+    d.speedRaw = (int16_t)(15000 + (i * 37) % 8000);
+    d.currentRaw = (int16_t)(800 + (i * 13) % 900);
+    d.voltageRaw = 3800 - (i / 100) % 300;
+    d.power = d.currentRaw * d.voltageRaw / 10000;
+    d.tempESCRaw = 350 + i % 50;
+    d.tempBMS1 = 28;
+    d.tempBMS2 = 29;
+    for (int c = 0; c < 10; c++) d.cellMv[c] = 3800 + (c * 7 + i) % 30;
+    d.minCellMv = 3800;
+    d.maxCellMv = 3829;
+    return d;
+}
+
+static void setupFixtures() {
+    uint8_t speed[2] = { 0x98, 0x3A };
+    speedFrameLen = makeFrame(speedFrame, ADDR_ESC_REPLY, REG_ESC_SPEED, speed, 2);
+
+    uint8_t cells[20];
+    for (int i = 0; i < 10; i++) {
+        cells[i * 2] = (3800 + i) & 0xFF;
+        cells[i * 2 + 1] = (3800 + i) >> 8;
+    }
+    cellsFrameLen = makeFrame(cellsFrame, ADDR_BMS_REPLY, REG_BMS_CELLS, cells, 20);
+
+    // One full poll cycle's worth of replies, repeated
+    static const uint8_t regs[][3] = {
+        { ADDR_ESC_REPLY, REG_ESC_SPEED, 2 }, { ADDR_ESC_REPLY, REG_ESC_BATTERY, 1 },
+        { ADDR_BMS_REPLY, REG_BMS_CURRENT, 4 }, { ADDR_ESC_REPLY, REG_ESC_MODE, 1 },
+        { ADDR_ESC_REPLY, REG_ESC_ODOMETER, 4 }, { ADDR_ESC_REPLY, REG_ESC_TRIP, 2 },
+        { ADDR_ESC_REPLY, REG_ESC_FRAME_TEMP, 2 }, { ADDR_BMS_REPLY, REG_BMS_TEMP, 2 },
+        { ADDR_ESC_REPLY, REG_ESC_RANGE, 2 }, { ADDR_BMS_REPLY, REG_BMS_CAPACITY, 2 },
+        { ADDR_BMS_REPLY, REG_BMS_CELLS, 20 }, { ADDR_ESC_REPLY, REG_ESC_AVERAGE, 2 },
+        { ADDR_ESC_REPLY, REG_ESC_ERROR, 1 },
+    };
+    uint8_t payload[20];
+    for (int i = 0; i < 20; i++) payload[i] = 0x40 + i;
+    for (int rep = 0; rep < 80; rep++) {
+        for (size_t r = 0; r < sizeof(regs) / sizeof(regs[0]); r++) {
+            uint8_t f[40];
+            uint8_t n = makeFrame(f, regs[r][0], regs[r][1], payload, regs[r][2]);
+            mixedStream.insert(mixedStream.end(), f, f + n);
+            mixedFrames++;
+        }
+    }
+
+    // Five hours of samples so every tier is full
+    for (uint32_t i = 0; i < 5 * 3600 * 4 + 10; i++) history.addSample(sample(i), i * 250);
+    seriesLen = history.getSeries(HIST_POWER, TIER_1MIN, series, HISTORY_MAX_SIZE);
+}
+
+// ========== Cases ==========
+static void benchChecksum(uint64_t n) {
+    uint8_t cmd[M365_COMMAND_LEN];
+    M365Protocol::buildCommand(cmd, ADDR_ESC, CMD_READ, REG_ESC_SPEED, 2);
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        cmd[5] = (uint8_t)i;
+        acc += M365Protocol::checksum(cmd + 2, 5);
+    }
+    sink = acc;
+}
+
+static void benchBuildCommand(uint64_t n) {
+    uint8_t cmd[M365_COMMAND_LEN];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        M365Protocol::buildCommand(cmd, ADDR_ESC, CMD_READ, (uint8_t)i, 2);
+        acc += cmd[7];
+    }
+    sink = acc;
+}
+
+static void benchDecodeSpeed(uint64_t n) {
+    M365Protocol p;
+    for (uint64_t i = 0; i < n; i++) p.processResponse(speedFrame, speedFrameLen);
+    sink = p.getFrames();
+}
+
+// Cells reply arrives as a 20-byte notification plus the tail
+static void benchDecodeCellsFragmented(uint64_t n) {
+    M365Protocol p;
+    for (uint64_t i = 0; i < n; i++) {
+        p.processResponse(cellsFrame, 20);
+        p.processResponse(cellsFrame + 20, cellsFrameLen - 20);
+    }
+    sink = p.getFrames();
+}
+
+// Per frame, over a realistic register mix
+static void benchDecodeMixed(uint64_t n) {
+    M365Protocol p;
+    uint64_t done = 0;
+    while (done < n) {
+        p.processResponse(mixedStream.data(), mixedStream.size());
+        done += mixedFrames;
+    }
+    sink = p.getFrames();
+}
+
+// Through the table, as the protocol calls it once a pack is detected
+static void cellsDecode(uint64_t n, uint8_t cells) {
+    const CellPackInfo& pack = cellPackFor(cells);
+    uint8_t payload[CELLS_MAX * 2];
+    for (uint8_t i = 0; i < CELLS_MAX; i++) {
+        payload[i * 2] = (uint8_t)(3900 + i);
+        payload[i * 2 + 1] = (3900 + i) >> 8;
+    }
+    ScooterData d;
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        payload[0] = (uint8_t)i;
+        acc += pack.decode(d, payload, pack.readLen);
+    }
+    sink = acc + d.minCellMv;
+}
+
+static void benchCells10(uint64_t n) { cellsDecode(n, 10); }
+static void benchCells16(uint64_t n) { cellsDecode(n, 16); }
+
+static void benchPollerDue(uint64_t n) {
+    M365Poller poller;
+    M365Request req;
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (poller.due((uint32_t)i * 10, req)) acc += req.reg;
+    }
+    sink = acc;
+}
+
+static void benchHistoryAdd(uint64_t n) {
+    static HistoryStore h;
+    ScooterData d = sample(0);
+    for (uint64_t i = 0; i < n; i++) {
+        d.speedRaw = (int16_t)(i & 0x3FFF);
+        h.addSample(d, (uint32_t)i * 250);
+    }
+    sink = h.tierVersion(TIER_RAW);
+}
+
+static void benchHistorySeries(uint64_t n) {
+    HistoryBucket out[HISTORY_MAX_SIZE];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        acc += history.getSeries((HistoryChannel)(i % HIST_CHANNELS), TIER_1MIN, out, HISTORY_MAX_SIZE);
+    }
+    sink = acc;
+}
+
+// Everything drawGraph() computes for one 300 px graph of the 5 h tier
+static void benchGraphLayout(uint64_t n) {
+    int32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        int32_t maxVal = graphScale(series, seriesLen, 50);
+        uint16_t points = graphPoints(seriesLen, 290);
+        for (uint16_t j = 0; j < points; j++) {
+            GraphColumn col;
+            if (!graphColumn(series, seriesLen, points, j, col)) continue;
+            acc += graphPixel(col.hi, maxVal, 60) + graphPixel(col.lo, maxVal, 60) + graphPixel(col.avg, maxVal, 60);
+        }
+    }
+    sink = acc;
+}
+
+static void benchNiceScale(uint64_t n) {
+    int32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) acc += niceScale((int32_t)(i % 30000), 50);
+    sink = acc;
+}
+
+static void benchFmtTime(uint64_t n) {
+    char buf[16];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) acc += fmtTime(buf, (uint32_t)(i % 20000));
+    sink = acc;
+}
+
+static void benchFmtFixed(uint64_t n) {
+    char buf[16];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) acc += fmtFixed(buf, (int32_t)(i % 100000) - 50000, 1);
+    sink = acc;
+}
+
+static void benchFmtUint(uint64_t n) {
+    char buf[16];
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) acc += fmtUint(buf, (uint32_t)i);
+    sink = acc;
+}
+
+// All fields of one sample, as the logger and stream do
+static void benchTelemetryValues(uint64_t n) {
+    ScooterData d = sample(7);
+    int32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        d.speedRaw = (int16_t)i;
+        for (uint8_t f = 0; f < TF_COUNT; f++) acc += telemetryValue(d, f);
+    }
+    sink = acc;
+}
+
+// Only unbound fields change: no rule is looked at
+static void benchAlertsIdle(uint64_t n) {
+    AlertEngine e;
+    ScooterData d = sample(7);
+    e.update(d, 0);
+    for (uint64_t i = 0; i < n; i++) {
+        d.speedRaw = (int16_t)i;
+        e.update(d, (uint32_t)i);
+    }
+    sink = e.getVersion();
+}
+
+// ESC temperature moves every update: its two rules are evaluated
+static void benchAlertsChange(uint64_t n) {
+    AlertEngine e;
+    ScooterData d = sample(7);
+    for (uint64_t i = 0; i < n; i++) {
+        d.tempESCRaw = (int16_t)(300 + (i & 1));
+        e.update(d, (uint32_t)i);
+    }
+    sink = e.getVersion();
+}
+
+// One accepted sample: five channels of mean/variance and three P2 markers
+static void benchTripAdd(uint64_t n) {
+    TripStats t;
+    for (uint64_t i = 0; i < n; i++) {
+        ScooterData d = sample((uint32_t)i);
+        t.add(d, (uint32_t)i * TRIP_SAMPLE_MS);
+    }
+    TripSummary s;
+    t.summarize(s);
+    sink = s.samples;
+}
+
+// Three links with shifting readiness, one grant per tick
+static void benchFleetNext(uint64_t n) {
+    FleetScheduler s;
+    uint32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        acc += s.next((uint32_t)i * FLEET_TICK_MS, (uint32_t)(i % 7) + 1) + 1;
+    }
+    sink = acc;
+}
+
+// One sample per ~400 ms reply and eight frame estimates in between
+static void benchSpeedFilter(uint64_t n) {
+    SpeedFilter f;
+    int32_t acc = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t t = (uint32_t)i * 50;
+        if ((i & 7) == 0) f.add(15000 + (int32_t)(i % 23) * 40, t);
+        acc += f.estimate(t + 10);
+    }
+    sink = acc;
+}
+
+// What each loop iteration adds: one duration, spread over many bins
+static void benchLatencyAdd(uint64_t n) {
+    LatencyHistogram h;
+    for (uint64_t i = 0; i < n; i++) h.add((uint32_t)(i * 2654435761u) >> 10);
+    sink = h.count();
+}
+
+// The dirty check of every dynamic widget on the classic main screen,
+// which is all a frame costs when nothing moved
+static void layoutFrame(uint64_t n, bool moving) {
+    static ScreenLayout l;
+    l.load(LAYOUT_CLASSIC, sizeof(LAYOUT_CLASSIC));
+    const LayoutScreen* s = l.find(0);
+    ScooterData d = sample(7);
+    AlertEngine alerts;
+    LayoutContext ctx = { &d, &alerts, 18, 27 };
+    uint8_t from = s->first + s->chromeCount;
+    uint8_t to = from + s->dynamicCount;
+    char buf[LAYOUT_TEXT_MAX];
+    uint16_t color;
+    uint32_t drawn = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        if (moving) {
+            d.voltageRaw = (uint16_t)(3900 + (i & 63));
+            d.currentRaw = (int16_t)(i & 1023);
+            d.power = (int16_t)(i & 511);
+        }
+        for (uint8_t w = from; w < to; w++) {
+            if (l.item(w).type == LW_VALUE && l.refresh(w, ctx, false, buf, color)) drawn++;
+        }
+    }
+    sink = drawn;
+}
+
+static void benchLayoutIdle(uint64_t n) { layoutFrame(n, false); }
+static void benchLayoutMoving(uint64_t n) { layoutFrame(n, true); }
+
+static void benchLayoutLoad(uint64_t n) {
+    static ScreenLayout l;
+    uint32_t ok = 0;
+    for (uint64_t i = 0; i < n; i++) ok += l.load(LAYOUT_CLASSIC, sizeof(LAYOUT_CLASSIC));
+    sink = ok;
+}
+
+static const Case CASES[] = {
+    { "protocol.checksum",              benchChecksum },
+    { "protocol.buildCommand",          benchBuildCommand },
+    { "protocol.decode.speed",          benchDecodeSpeed },
+    { "protocol.decode.cellsFragmented", benchDecodeCellsFragmented },
+    { "protocol.decode.mixed",          benchDecodeMixed },
+    { "cells.decode.10s",               benchCells10 },
+    { "cells.decode.16s",               benchCells16 },
+    { "poller.due",                     benchPollerDue },
+    { "history.addSample",              benchHistoryAdd },
+    { "history.getSeries.5h",           benchHistorySeries },
+    { "graph.layout.300",               benchGraphLayout },
+    { "graph.niceScale",                benchNiceScale },
+    { "format.time",                    benchFmtTime },
+    { "format.fixed",                   benchFmtFixed },
+    { "format.uint",                    benchFmtUint },
+    { "telemetry.allFields",            benchTelemetryValues },
+    { "alerts.update.idle",             benchAlertsIdle },
+    { "alerts.update.change",           benchAlertsChange },
+    { "trip.add",                       benchTripAdd },
+    { "fleet.next",                     benchFleetNext },
+    { "speed.filter",                   benchSpeedFilter },
+    { "loop.histogram.add",             benchLatencyAdd },
+    { "layout.frame.idle",              benchLayoutIdle },
+    { "layout.frame.moving",            benchLayoutMoving },
+    { "layout.load",                    benchLayoutLoad },
+};
+#define CASE_COUNT  (sizeof(CASES) / sizeof(CASES[0]))
+
+static void writeJson(FILE* f, const std::vector<Result>& results) {
+    fprintf(f, "{\n  \"schema\": %d,\n  \"suite\": \"core\",\n", BENCH_SCHEMA);
+#ifdef __VERSION__
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f, \"iterations\": %llu}%s\n",
+                r.name, r.nsPerOp, r.allocsPerOp, (unsigned long long)r.iterations,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    const char* jsonPath = nullptr;
+    const char* filter = nullptr;
+    double minMs = 50;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json") && i + 1 < argc) jsonPath = argv[++i];
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-ms") && i + 1 < argc) minMs = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--json out.json] [--filter name] [--min-ms 50]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    setupFixtures();
+
+    std::vector<Result> results;
+    results.reserve(CASE_COUNT);
+    printf("%-34s %12s %10s %14s\n", "case", "ns/op", "allocs/op", "iterations");
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        if (filter && !strstr(CASES[i].name, filter)) continue;
+        Result r = measure(CASES[i], minMs);
+        results.push_back(r);
+        printf("%-34s %12.2f %10.3f %14llu\n", r.name, r.nsPerOp, r.allocsPerOp,
+               (unsigned long long)r.iterations);
+    }
+
+    if (jsonPath) {
+        FILE* f = strcmp(jsonPath, "-") ? fopen(jsonPath, "w") : stdout;
+        if (!f) {
+            perror(jsonPath);
+            return 1;
+        }
+        writeJson(f, results);
+        if (f != stdout) fclose(f);
+    }
+    return 0;
+}
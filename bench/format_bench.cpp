@@ -0,0 +1,111 @@
+// Host microbenchmark: FastFormat vs snprintf
+//
+//   g++ -O2 -Iinclude bench/format_bench.cpp src/FastFormat.cpp -o format_bench
+//   ./format_bench
+//
+// Before timing, every formatter is checked against snprintf over its
+// full display range so the comparison is between equivalent outputs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+#include "FastFormat.h"
+
+static volatile uint32_t sink;
+
+static bool checkFixed(int32_t from, int32_t to, uint8_t decimals) {
+    char a[24], b[24];
+    static const double div[] = { 1, 10, 100, 1000, 10000 };
+    for (int32_t v = from; v <= to; v++) {
+        fmtFixed(a, v, decimals);
+        // Formatting the exact decimal quotient avoids binary rounding noise
+        if (decimals == 0) snprintf(b, sizeof(b), "%ld", (long)v);
+        else snprintf(b, sizeof(b), "%s%ld.%0*ld", v < 0 ? "-" : "",
+                      labs(v) / (long)div[decimals], decimals, labs(v) % (long)div[decimals]);
+        if (strcmp(a, b) != 0) {
+            printf("MISMATCH fixed %ld/%u: '%s' vs '%s'\n", (long)v, decimals, a, b);
+            return false;
+        }
+        // Round trip: parse back and compare against the scaled input
+        if (lround(strtod(a, nullptr) * div[decimals]) != v) {
+            printf("ROUNDTRIP fixed %ld/%u: '%s'\n", (long)v, decimals, a);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkTime() {
+    char a[16], b[16];
+    for (uint32_t s = 0; s < 100 * 3600; s++) {
+        fmtTime(a, s);
+        uint32_t h = s / 3600, m = (s % 3600) / 60, sec = s % 60;
+        if (h > 0) snprintf(b, sizeof(b), "%lu:%02lu:%02lu", (unsigned long)h, (unsigned long)m, (unsigned long)sec);
+        else snprintf(b, sizeof(b), "%02lu:%02lu", (unsigned long)m, (unsigned long)sec);
+        if (strcmp(a, b) != 0) {
+            printf("MISMATCH time %lu: '%s' vs '%s'\n", (unsigned long)s, a, b);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkRight() {
+    char a[24], b[24];
+    for (int32_t v = -99999; v <= 99999; v++) {
+        fmtFixedRight(a, v, 2, 9);
+        snprintf(b, sizeof(b), "%9.2f", v / 100.0);
+        if (strcmp(a, b) != 0) {
+            printf("MISMATCH right %ld: '%s' vs '%s'\n", (long)v, a, b);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename F>
+static double nsPerOp(F fn, int iterations) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn(i);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+int main() {
+    bool ok = checkFixed(-200000, 200000, 0) && checkFixed(-200000, 200000, 1) &&
+              checkFixed(-200000, 200000, 2) && checkFixed(0, 100000, 3) &&
+              checkTime() && checkRight();
+    if (!ok) return 1;
+    printf("equivalence checks passed\n\n");
+
+    const int N = 5000000;
+    char buf[32];
+
+    // Typical render values: voltage 0..60 V, cells 3.00..4.20 V, trip km, timer
+    printf("%-22s %10s %10s\n", "case", "fast ns", "sprintf ns");
+
+    double f = nsPerOp([&](int i) { sink += fmtFixed(buf, 3000 + i % 3000, 1); }, N);
+    double s = nsPerOp([&](int i) { sink += snprintf(buf, sizeof(buf), "%.1f", (3000 + i % 3000) / 10.0f); }, N);
+    printf("%-22s %10.1f %10.1f\n", "voltage %.1f", f, s);
+
+    f = nsPerOp([&](int i) { sink += fmtFixed(buf, 300 + i % 120, 2); }, N);
+    s = nsPerOp([&](int i) { sink += snprintf(buf, sizeof(buf), "%.2f", (300 + i % 120) / 100.0f); }, N);
+    printf("%-22s %10.1f %10.1f\n", "cell %.2f", f, s);
+
+    f = nsPerOp([&](int i) { sink += fmtUint(buf, i % 2000); }, N);
+    s = nsPerOp([&](int i) { sink += snprintf(buf, sizeof(buf), "%d", i % 2000); }, N);
+    printf("%-22s %10.1f %10.1f\n", "power %d", f, s);
+
+    f = nsPerOp([&](int i) { sink += fmtTime(buf, i % 20000); }, N);
+    s = nsPerOp([&](int i) {
+        uint32_t v = i % 20000, h = v / 3600, m = (v % 3600) / 60, sec = v % 60;
+        if (h > 0) sink += snprintf(buf, sizeof(buf), "%lu:%02lu:%02lu", (unsigned long)h, (unsigned long)m, (unsigned long)sec);
+        else sink += snprintf(buf, sizeof(buf), "%02lu:%02lu", (unsigned long)m, (unsigned long)sec);
+    }, N);
+    printf("%-22s %10.1f %10.1f\n", "formatTime", f, s);
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#ifndef LAYOUT_CLASSIC_H
+#define LAYOUT_CLASSIC_H
+
+#include <stdint.h>
+
+// Generated by tools/layout_compile.py - do not edit by hand.
+static const uint8_t LAYOUT_CLASSIC[1731] = {
+    0x4D, 0x33, 0x36, 0x35, 0x4C, 0x59, 0x54, 0x00, 0x01, 0x00, 0x03, 0x3B,
+    0x0E, 0x00, 0xAB, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x01, 0x1C, 0x0A, 0x00,
+    0x02, 0x26, 0x15, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x1E, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x9B, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0xCD, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x80, 0x08, 0x04, 0xA0, 0x00, 0x55, 0x00,
+    0xA0, 0x00, 0x4C, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x04, 0xA0, 0x00, 0x84, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x03, 0x00, 0x21, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x00, 0x00, 0x05, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x04, 0x00, 0x03, 0x00, 0x2C, 0x00,
+    0x4B, 0x00, 0x00, 0x00, 0xFF, 0x07, 0x01, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+    0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x03, 0x00, 0x49, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x02, 0x04, 0x00, 0x03, 0x00, 0x54, 0x00,
+    0x4B, 0x00, 0x00, 0x00, 0xE0, 0xFF, 0x01, 0x01, 0x00, 0x01, 0xFF, 0xFF,
+    0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x03, 0x00, 0x71, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x01, 0x00, 0x09, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x04, 0x00, 0x03, 0x00, 0x7C, 0x00,
+    0x4B, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x01, 0x01, 0x01, 0xFF, 0xFF,
+    0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x3D, 0x01, 0x21, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x02, 0x00, 0x0B, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x06, 0x04, 0x02, 0x3D, 0x01, 0x2C, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x02, 0x03, 0x0F, 0x00,
+    0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x3D, 0x01, 0x49, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x05, 0x00, 0x11, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x81, 0x04, 0x02, 0x3D, 0x01, 0x54, 0x00,
+    0x48, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x05, 0x03, 0x0F, 0x00,
+    0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00, 0xA0, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x15, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x0C, 0x04, 0x00, 0x05, 0x00, 0xAD, 0x00,
+    0x64, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x01, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x71, 0x00, 0xA0, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x1C, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x0D, 0x04, 0x00, 0x71, 0x00, 0xAD, 0x00,
+    0x5F, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x02, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0xDA, 0x00, 0xA0, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x24, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x0E, 0x04, 0x00, 0xDA, 0x00, 0xAD, 0x00,
+    0x64, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x02, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00, 0xD7, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x29, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x05, 0x02, 0x00, 0x2D, 0x00, 0xD7, 0x00,
+    0x3C, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x01, 0x00, 0x08, 0x00, 0x2F, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x73, 0x00, 0xD7, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x32, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x82, 0x02, 0x00, 0x91, 0x00, 0xD7, 0x00,
+    0x32, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x01, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0xD7, 0x00, 0xD7, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x36, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x83, 0x02, 0x00, 0xF5, 0x00, 0xD7, 0x00,
+    0x32, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0xA0, 0x00, 0x0F, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x08, 0x00, 0x3A, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x23, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x02, 0x00, 0x0A, 0x00, 0x2D, 0x00,
+    0x2C, 0x01, 0x50, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x08, 0x00, 0x4A, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x01, 0x02, 0x00, 0x0A, 0x00, 0x87, 0x00,
+    0x2C, 0x01, 0x50, 0x00, 0xE0, 0xFF, 0x00, 0x00, 0x08, 0x00, 0x54, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x14, 0x00, 0xDE, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x08, 0x00, 0x60, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x02, 0x00, 0x3A, 0x00, 0xDE, 0x00,
+    0x41, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x01, 0x08, 0x00, 0x09, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x82, 0x00, 0xDE, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xE0, 0xFF, 0x00, 0x00, 0x08, 0x00, 0x65, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x02, 0x02, 0x00, 0xA6, 0x00, 0xDE, 0x00,
+    0x4B, 0x00, 0x00, 0x00, 0xE0, 0xFF, 0x01, 0x01, 0x08, 0x00, 0x07, 0x00,
+    0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0xFA, 0x00, 0xDE, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x08, 0x00, 0x6A, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x00, 0x0A, 0x01, 0xDE, 0x00,
+    0x36, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x01, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0xA0, 0x00, 0x0F, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x08, 0x00, 0x6D, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x20, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x82, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0xC8, 0x00,
+    0x40, 0x01, 0x00, 0x00, 0x08, 0x42, 0x00, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x05, 0x00, 0x8A, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x08, 0x00, 0x75, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x09, 0x07, 0x04, 0x37, 0x00, 0x4A, 0x00,
+    0x5F, 0x00, 0x32, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x08, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x05, 0x09, 0x02, 0x00, 0x0A, 0x00, 0x6C, 0x00,
+    0x5A, 0x00, 0x06, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x08, 0x01, 0xFF, 0xFF,
+    0x00, 0x00, 0x64, 0x00, 0x00, 0x00, 0x02, 0x00, 0x6E, 0x00, 0x28, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x09, 0x00, 0x7B, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x02, 0x3B, 0x01, 0x28, 0x00,
+    0x78, 0x00, 0x00, 0x00, 0xFF, 0x07, 0x02, 0x00, 0x09, 0x00, 0x05, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x6E, 0x00, 0x3A, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x09, 0x00, 0x83, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x02, 0x02, 0x02, 0x3B, 0x01, 0x3A, 0x00,
+    0x78, 0x00, 0x00, 0x00, 0xE0, 0xFF, 0x02, 0x00, 0x09, 0x00, 0x07, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x6E, 0x00, 0x4C, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x09, 0x00, 0x8B, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x02, 0x02, 0x3B, 0x01, 0x4C, 0x00,
+    0x78, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x09, 0x00, 0x09, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x6E, 0x00, 0x5E, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x09, 0x00, 0x91, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x0A, 0x02, 0x02, 0x3B, 0x01, 0x5E, 0x00,
+    0x78, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x09, 0x00, 0x9A, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x6E, 0x00, 0x70, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x09, 0x00, 0x9E, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x06, 0x02, 0x02, 0x0E, 0x01, 0x70, 0x00,
+    0x32, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x09, 0x01, 0x0F, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x04, 0x81, 0x02, 0x02, 0x3B, 0x01, 0x70, 0x00,
+    0x28, 0x00, 0x00, 0x00, 0x20, 0xFD, 0x00, 0x00, 0x0A, 0x01, 0x0F, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x08, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x0B, 0x00, 0xFF, 0xFF,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00, 0xD4, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xEF, 0x7B, 0x00, 0x00, 0x0B, 0x00, 0xA3, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x04, 0x84, 0x02, 0x00, 0x32, 0x00, 0xD4, 0x00,
+    0x5F, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x0B, 0x03, 0xA8, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0xF8,
+    0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0xE0, 0xFF, 0x02, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0xFF, 0x07, 0x01, 0x00, 0x00, 0x00, 0x02, 0x01, 0x00, 0xF8,
+    0x03, 0x00, 0x00, 0x00, 0x02, 0x01, 0xE0, 0xFF, 0x02, 0x00, 0x00, 0x00,
+    0x02, 0x01, 0xFF, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8,
+    0x14, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0xF8, 0x03, 0x00, 0x00, 0x00,
+    0x02, 0x01, 0x00, 0xF8, 0x03, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00, 0xF8,
+    0x03, 0x00, 0x00, 0x00, 0x02, 0x02, 0xE0, 0xFF, 0x02, 0x00, 0x00, 0x00,
+    0x02, 0x02, 0xFF, 0x07, 0x01, 0x00, 0x00, 0x00, 0x6B, 0x6D, 0x2F, 0x68,
+    0x00, 0x56, 0x00, 0x41, 0x00, 0x57, 0x00, 0x45, 0x53, 0x43, 0x00, 0x43,
+    0x00, 0x42, 0x41, 0x54, 0x00, 0x4F, 0x44, 0x4F, 0x20, 0x6B, 0x6D, 0x00,
+    0x54, 0x52, 0x49, 0x50, 0x20, 0x6B, 0x6D, 0x00, 0x54, 0x49, 0x4D, 0x45,
+    0x00, 0x52, 0x41, 0x4E, 0x47, 0x45, 0x00, 0x6B, 0x6D, 0x00, 0x41, 0x56,
+    0x47, 0x00, 0x4D, 0x41, 0x58, 0x00, 0x50, 0x4F, 0x57, 0x45, 0x52, 0x20,
+    0x26, 0x20, 0x43, 0x55, 0x52, 0x52, 0x45, 0x4E, 0x54, 0x00, 0x50, 0x4F,
+    0x57, 0x45, 0x52, 0x20, 0x28, 0x57, 0x29, 0x00, 0x43, 0x55, 0x52, 0x52,
+    0x45, 0x4E, 0x54, 0x20, 0x28, 0x41, 0x29, 0x00, 0x50, 0x57, 0x52, 0x3A,
+    0x00, 0x43, 0x55, 0x52, 0x3A, 0x00, 0x56, 0x3A, 0x00, 0x42, 0x41, 0x54,
+    0x54, 0x45, 0x52, 0x59, 0x00, 0x43, 0x45, 0x4C, 0x4C, 0x53, 0x00, 0x56,
+    0x6F, 0x6C, 0x74, 0x61, 0x67, 0x65, 0x00, 0x43, 0x75, 0x72, 0x72, 0x65,
+    0x6E, 0x74, 0x00, 0x50, 0x6F, 0x77, 0x65, 0x72, 0x00, 0x43, 0x61, 0x70,
+    0x61, 0x63, 0x69, 0x74, 0x79, 0x00, 0x6D, 0x41, 0x68, 0x00, 0x54, 0x65,
+    0x6D, 0x70, 0x00, 0x42, 0x41, 0x4C, 0x3A, 0x00, 0x6D, 0x56, 0x00, 0xB5,
+    0x21, 0x04, 0x3C,
+};
+
+#endif
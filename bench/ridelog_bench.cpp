@@ -0,0 +1,167 @@
+// Host benchmark: ride log encoder size and speed
+//
+//   g++ -O2 -Iinclude bench/ridelog_bench.cpp src/LogEncoder.cpp src/TelemetryFields.cpp -o ridelog_bench
+//   ./ridelog_bench [out.M3L]
+//
+// Encodes a synthetic 3 hour ride at the full 10 Hz poll rate, sealing
+// blocks on the same 5 s deadline as the device, and decodes every block
+// back to check the round trip. The optional file can be fed to
+// tools/decode_ridelog.py.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+
+#include "LogEncoder.h"
+
+#define RIDE_SECONDS    (3 * 3600)
+#define SAMPLE_MS       100
+#define SEAL_MS         5000
+
+static uint32_t rng = 12345;
+static int32_t rnd(int32_t span) {
+    rng = rng * 1103515245 + 12345;
+    return (int32_t)((rng >> 16) % (2 * span + 1)) - span;
+}
+
+// Plausible telemetry: speed wanders, current follows it, cells sag
+static void step(ScooterData& d, uint32_t t) {
+    int32_t speed = d.speedRaw + rnd(300);
+    if (speed < 0) speed = 0;
+    if (speed > 25000) speed = 25000;
+    d.speedRaw = speed;
+    d.averageSpeedRaw = 18000 + (t / 60000) % 50;
+    d.currentRaw = speed / 20 + rnd(40);
+    d.voltageRaw = 4100 - t / 4000 + rnd(3);
+    d.power = (int32_t)d.voltageRaw * d.currentRaw / 10000;
+    d.remainingRangeRaw = 3000 - t / 4000;
+    d.tempESCRaw = 300 + t / 60000 + rnd(1);
+    d.tempBMS1 = 25 + t / 900000;
+    d.tempBMS2 = d.tempBMS1;
+    d.batteryLevel = 100 - t / 110000;
+    d.capacityRemain = 12000 - t / 1000;
+    d.odometer += speed / 36000;
+    d.tripDistance += speed / 36000;
+    d.rideTime = t / 1000;
+    d.connected = true;
+    for (int i = 0; i < 10; i++) d.cellMv[i] = 4100 - t / 4000 + rnd(2);
+}
+
+static uint64_t getVarint(const uint8_t* b, uint16_t& pos) {
+    uint64_t v = 0;
+    for (uint8_t shift = 0;; shift += 7) {
+        uint8_t c = b[pos++];
+        v |= (uint64_t)(c & 0x7F) << shift;
+        if (c < 0x80) return v;
+    }
+}
+
+// Minimal decoder mirroring tools/decode_ridelog.py
+static bool checkBlock(const uint8_t* b, const std::vector<ScooterData>& src,
+                       const std::vector<uint32_t>& times, size_t& next) {
+    const uint8_t* t = b + LOG_BLOCK_SIZE - LOG_TRAILER_BYTES;
+    uint32_t crc = t[4] | t[5] << 8 | t[6] << 16 | (uint32_t)t[7] << 24;
+    if (logCrc32(b, LOG_BLOCK_SIZE - 4) != crc) return false;
+    uint16_t used = t[0] | t[1] << 8;
+    uint16_t count = t[2] | t[3] << 8;
+    uint32_t time = b[8] | b[9] << 8 | b[10] << 16 | (uint32_t)b[11] << 24;
+
+    int32_t values[TF_COUNT] = { 0 };
+    uint16_t pos = LOG_HEADER_BYTES;
+    for (uint16_t r = 0; r < count; r++, next++) {
+        time += getVarint(b, pos);
+        uint64_t mask = getVarint(b, pos);
+        for (uint8_t i = 0; i < TF_COUNT; i++) {
+            if (!(mask & (1ULL << i))) continue;
+            uint32_t z = getVarint(b, pos);
+            values[i] += (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+        }
+        if (time != times[next]) return false;
+        for (uint8_t i = 0; i < TF_COUNT; i++) {
+            if (values[i] != telemetryValue(src[next], i)) return false;
+        }
+    }
+    return pos == LOG_HEADER_BYTES + used;
+}
+
+int main(int argc, char** argv) {
+    // Standard check value for CRC-32
+    if (logCrc32((const uint8_t*)"123456789", 9) != 0xCBF43926) {
+        printf("CRC32 check value mismatch\n");
+        return 1;
+    }
+
+    std::vector<ScooterData> samples;
+    std::vector<uint32_t> times;
+    ScooterData d;
+    d.speedRaw = 15000;
+    for (uint32_t t = 0; t < RIDE_SECONDS * 1000u; t += SAMPLE_MS) {
+        step(d, t);
+        samples.push_back(d);
+        times.push_back(t + (uint32_t)rnd(3) + 3);
+    }
+
+    std::vector<uint8_t> file(LOG_BLOCK_SIZE);
+    logWriteSchema(file.data());
+
+    static uint8_t block[LOG_BLOCK_SIZE];
+    LogEncoder enc;
+    uint32_t seq = 0;
+    size_t blocks = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (enc.isOpen() && (times[i] - enc.openedAt() >= SEAL_MS || !enc.append(samples[i], times[i]))) {
+            enc.seal();
+            file.insert(file.end(), block, block + LOG_BLOCK_SIZE);
+            blocks++;
+        } else if (enc.isOpen()) {
+            continue;
+        }
+        enc.begin(block, seq++, times[i]);
+        enc.append(samples[i], times[i]);
+    }
+    enc.seal();
+    file.insert(file.end(), block, block + LOG_BLOCK_SIZE);
+    blocks++;
+    auto t1 = std::chrono::steady_clock::now();
+
+    size_t next = 0;
+    for (size_t b = 1; b <= blocks; b++) {
+        if (!checkBlock(&file[b * LOG_BLOCK_SIZE], samples, times, next)) {
+            printf("ROUNDTRIP block %zu failed near sample %zu\n", b, next);
+            return 1;
+        }
+    }
+    if (next != samples.size()) {
+        printf("ROUNDTRIP decoded %zu of %zu samples\n", next, samples.size());
+        return 1;
+    }
+
+    // Payload excluding block padding, to show the encoding itself
+    size_t payload = 0;
+    for (size_t b = 1; b <= blocks; b++) {
+        const uint8_t* p = &file[(b + 1) * LOG_BLOCK_SIZE - LOG_TRAILER_BYTES];
+        payload += p[0] | p[1] << 8;
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / samples.size();
+    double hours = RIDE_SECONDS / 3600.0;
+    printf("samples          %zu (%.1f h at %d Hz)\n", samples.size(), hours, 1000 / SAMPLE_MS);
+    printf("raw struct       %.2f MB/h\n", samples.size() * sizeof(ScooterData) / hours / 1e6);
+    printf("payload          %.1f B/sample, %.2f MB/h\n",
+           (double)payload / samples.size(), payload / hours / 1e6);
+    printf("file (%d B blocks) %.2f MB/h, %zu blocks\n", LOG_BLOCK_SIZE, file.size() / hours / 1e6, blocks);
+    printf("encode           %.0f ns/sample (host)\n", ns);
+    printf("round trip       OK\n");
+
+    if (argc > 1) {
+        FILE* f = fopen(argv[1], "wb");
+        if (!f) return 1;
+        fwrite(file.data(), 1, file.size(), f);
+        fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef ALERT_BUZZER_H
+#define ALERT_BUZZER_H
+
+#include <Arduino.h>
+
+// CYD "SPEAK" connector, driven through the on-board amplifier
+#define BUZZER_PIN          26
+#define BUZZER_LEDC_CH      1
+#define BUZZER_FREQ_HZ      2700
+#define BUZZER_BEEP_MS      120
+#define BUZZER_GAP_MS       120
+
+// Non-blocking beep sequences for the alert hook; update() from the
+// render loop advances them
+class AlertBuzzer {
+public:
+    AlertBuzzer();
+
+    void begin();
+    void beep(uint8_t count, uint32_t now);
+    void update(uint32_t now);
+
+private:
+    uint8_t remaining;      // beeps left, including the one sounding
+    bool sounding;
+    uint32_t nextMs;
+};
+
+#endif
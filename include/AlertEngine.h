@@ -0,0 +1,99 @@
+#ifndef ALERT_ENGINE_H
+#define ALERT_ENGINE_H
+
+#include <stdint.h>
+#include "ScooterData.h"
+
+// Values the rules can watch, derived once per update from ScooterData
+enum AlertInput : uint8_t {
+    AIN_TEMP_ESC = 0,   // 0.1 C
+    AIN_TEMP_BMS,       // 0.1 C, average of both sensors
+    AIN_IMBALANCE,      // mV, max - min cell
+    AIN_SAG,            // 10 mV below the last resting pack voltage
+    AIN_COUNT
+};
+
+enum AlertCompare : uint8_t {
+    ALERT_ABOVE = 0,
+    ALERT_BELOW
+};
+
+enum AlertSeverity : uint8_t {
+    ALERT_NONE = 0,
+    ALERT_INFO,
+    ALERT_WARN,
+    ALERT_CRIT
+};
+
+// Active rules are tracked in a 32-bit mask
+#define ALERT_MAX_RULES     32
+
+// Pack counts as resting below this current (10 mA)
+#define ALERT_REST_CURRENT_RAW  100
+
+// Raised once the value has been past 'threshold' for 'holdMs'; cleared
+// once it is back past threshold -/+ 'hysteresis' on the safe side
+struct AlertRule {
+    AlertInput input;
+    AlertCompare cmp;
+    int16_t threshold;
+    int16_t hysteresis;
+    uint16_t holdMs;
+    AlertSeverity severity;
+    const char* text;
+};
+
+extern const AlertRule ALERT_RULES[];
+extern const uint8_t ALERT_RULE_COUNT;
+
+// Called on every raise (raised = true) and clear
+typedef void (*AlertHook)(void* ctx, const AlertRule& rule, bool raised);
+
+// Evaluates ALERT_RULES incrementally: a rule is only looked at when its
+// input changed or while its hold timer runs, so an update that touches
+// nothing costs the same however long the table gets.
+class AlertEngine {
+public:
+    AlertEngine();
+
+    void reset();
+    void update(const ScooterData& data, uint32_t now);
+    void setHook(AlertHook fn, void* ctx) { hook = fn; hookCtx = ctx; }
+
+    // Highest active severity among the rules bound to 'in'
+    AlertSeverity level(AlertInput in) const { return inputLevel[in]; }
+    // Most severe active rule (latest raised on a tie), or nullptr
+    const AlertRule* top() const { return topRule < 0 ? nullptr : &ALERT_RULES[topRule]; }
+    uint8_t activeCount() const;
+    // Incremented on every raise and clear
+    uint32_t getVersion() const { return version; }
+
+private:
+    // Rule indices grouped by input: rules of input i are
+    // order[first[i]] .. order[first[i + 1] - 1]
+    uint8_t order[ALERT_MAX_RULES];
+    uint8_t first[AIN_COUNT + 1];
+
+    int32_t values[AIN_COUNT];
+    bool valid;
+    uint16_t restVoltageRaw;
+
+    uint32_t activeMask;
+    uint32_t pendingMask;
+    uint32_t pendingSince[ALERT_MAX_RULES];
+    uint32_t raisedSeq[ALERT_MAX_RULES];
+    uint32_t seq;
+
+    AlertSeverity inputLevel[AIN_COUNT];
+    int8_t topRule;
+    uint32_t version;
+
+    AlertHook hook;
+    void* hookCtx;
+
+    void derive(const ScooterData& data, int32_t* out);
+    void evaluate(uint8_t r, int32_t value, uint32_t now);
+    void setActive(uint8_t r, bool on);
+};
+
+#endif
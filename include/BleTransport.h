@@ -0,0 +1,111 @@
+#ifndef BLE_TRANSPORT_H
+#define BLE_TRANSPORT_H
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include <freertos/message_buffer.h>
+#include <freertos/queue.h>
+#include "M365Transport.h"
+#include "FleetScheduler.h"
+
+#define M365_SERVICE_UUID   "6e400001-b5a3-f393-e0a9-e50e24dcca9e"
+#define M365_TX_CHAR_UUID   "6e400002-b5a3-f393-e0a9-e50e24dcca9e"
+#define M365_RX_CHAR_UUID   "6e400003-b5a3-f393-e0a9-e50e24dcca9e"
+
+// Connection interval in 1.25 ms units
+#define BLE_CONN_INTERVAL_DEFAULT   12
+#define BLE_SUPERVISION_TIMEOUT     400
+#define BLE_RESCAN_MS               5000
+#define BLE_RSSI_MS                 5000
+#define BLE_CONNECT_TIMEOUT_S       10
+
+// Last scooter's address, kept in NVS so a boot can connect straight to
+// it. A short timeout, then a normal scan if it isn't there.
+#define BLE_PREFS_NAMESPACE         "ble"
+#define BLE_CACHED_CONNECT_S        3
+
+// One BleTransport per connection; NimBLE's connection limit
+#define BLE_MAX_LINKS               FLEET_MAX_SCOOTERS
+
+// Connects block for up to BLE_CONNECT_TIMEOUT_S, so they run on their
+// own task, one at a time, next to the protocol task on core 0
+#define BLE_CONNECT_STACK           4096
+#define BLE_CONNECT_PRIORITY        1
+
+// Notifications waiting for the protocol task, each stored with its
+// arrival time so captures keep the original timing and fragmentation
+#define BLE_RX_BUFFER_SIZE  2048
+#define BLE_MAX_NOTIFY      512
+
+// Nordic UART service on the scooter's BLE board. Several instances
+// share the NimBLE host and its scanner, one scooter each: a scan result
+// goes to the first link still looking, unless another link already
+// has that scooter. Connects and service discovery run on the connect
+// task; while one is in progress update() leaves the link alone, and
+// the other links keep polling.
+class BleTransport : public M365Transport {
+public:
+    BleTransport();
+
+    void begin() override;
+    LinkState update(uint32_t now) override;
+    bool canSend() override;
+    bool send(const uint8_t* data, size_t len) override;
+    size_t receive(uint8_t* buf, size_t maxLen, uint32_t& timeMs) override;
+
+    const char* name() const override { return label; }
+    int8_t getRSSI() const override { return rssi; }
+    uint32_t getRxDropped() const override { return rxDropped; }
+    void setConnInterval(uint16_t units) override { connInterval = units; }
+
+    static void notifyCallback(BLERemoteCharacteristic* pChar, uint8_t* pData, size_t length, bool isNotify);
+    // True if some link took the scooter
+    static bool scanCallback(NimBLEAdvertisedDevice* device);
+
+private:
+    uint8_t slot;
+    char label[6];
+    volatile LinkState state;
+    // Queued for or inside the connect task, which owns the link meanwhile
+    volatile bool connecting;
+    int8_t rssi;
+
+    NimBLEClient* pClient;
+    NimBLERemoteService* pService;
+    NimBLERemoteCharacteristic* pTxChar;
+    NimBLERemoteCharacteristic* pRxChar;
+    // Scan results may be cleared by another link's scan before this
+    // one connects, so only the address is kept
+    NimBLEAddress foundAddress;
+    volatile bool found;
+    NimBLEAddress cachedAddress;
+    bool haveCached;
+    bool cachedFailed;
+
+    uint32_t lastScan;
+    uint32_t lastRssi;
+    volatile uint16_t connInterval;
+    uint16_t appliedConnInterval;
+
+    MessageBufferHandle_t rxBuffer;
+    volatile uint32_t rxDropped;
+
+    static BleTransport* links[BLE_MAX_LINKS];
+    static uint8_t linkCount;
+    static QueueHandle_t connectQueue;
+
+    static void connectTaskEntry(void* arg);
+
+    static BleTransport* forClient(NimBLEClient* client);
+    static bool claimed(const NimBLEAddress& addr, const BleTransport* except);
+    bool owns(const NimBLEAddress& addr) const;
+
+    bool startScan();
+    void runScan(uint32_t now);
+    void requestConnect();
+    bool connect();
+    void loadCachedAddress();
+    void saveCachedAddress(const NimBLEAddress& addr);
+};
+
+#endif
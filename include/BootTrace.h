@@ -0,0 +1,21 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+#include <Arduino.h>
+
+enum BootMilestone : uint8_t {
+    BOOT_RESET = 0,         // setup() entered
+    BOOT_FIRST_PIXEL,       // splash on the panel, backlight on
+    BOOT_BLE_UP,            // transport initialised (NimBLE up on BLE builds)
+    BOOT_CONNECTED,         // link to the scooter established
+    BOOT_FIRST_FRAME,       // first telemetry frame decoded
+    BOOT_MILESTONES
+};
+
+// Records the first time each milestone is reached, in microseconds on
+// the esp_timer clock (which starts counting during startup, before
+// setup()). Each milestone is marked from a single task, so no locking.
+void bootMark(BootMilestone m);
+int64_t bootTime(BootMilestone m);      // -1 until reached
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CAPTURE_FORMAT_H
+#define CAPTURE_FORMAT_H
+
+#include <stdint.h>
+
+// Raw BLE notification capture (*.CAP), little endian:
+//
+//   "M365CAP\0", u16 version, u16 reserved
+//   { u32 time ms, u16 length, bytes[length] } per notification
+//
+// One record per notification, so fragment boundaries are preserved
+// exactly as the parser saw them.
+#define CAPTURE_VERSION         1
+#define CAPTURE_HEADER_BYTES    12
+#define CAPTURE_RECORD_BYTES    6
+#define CAPTURE_MAX_PAYLOAD     512
+
+inline void captureWriteHeader(uint8_t* p) {
+    const char magic[8] = { 'M', '3', '6', '5', 'C', 'A', 'P', 0 };
+    for (uint8_t i = 0; i < 8; i++) p[i] = magic[i];
+    p[8] = CAPTURE_VERSION;
+    p[9] = 0;
+    p[10] = 0;
+    p[11] = 0;
+}
+
+inline bool captureCheckHeader(const uint8_t* p) {
+    const char magic[8] = { 'M', '3', '6', '5', 'C', 'A', 'P', 0 };
+    for (uint8_t i = 0; i < 8; i++) {
+        if (p[i] != (uint8_t)magic[i]) return false;
+    }
+    return (p[8] | (p[9] << 8)) == CAPTURE_VERSION;
+}
+
+inline void captureWriteRecord(uint8_t* p, uint32_t time, uint16_t len) {
+    p[0] = time;
+    p[1] = time >> 8;
+    p[2] = time >> 16;
+    p[3] = time >> 24;
+    p[4] = len;
+    p[5] = len >> 8;
+}
+
+// Anything that wants a copy of the raw notification stream
+class CaptureSink {
+public:
+    virtual ~CaptureSink() {}
+    virtual void capture(uint32_t timeMs, const uint8_t* data, uint16_t len) = 0;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CELL_PACK_H
+#define CELL_PACK_H
+
+#include <stdint.h>
+#include "ScooterData.h"
+
+#define CELLS_STOCK             10
+// A cell register below this is an unpopulated slot, not a flat cell
+#define CELL_PRESENT_MV         1000
+// Cells reading at or below this are left out of min/max
+#define CELL_VALID_MV           100
+
+// Battery screen grid: two rows across the panel
+#define CELL_GRID_WIDTH         315
+#define CELL_GRID_ROWS          2
+
+// Everything that depends on the series cell count, fixed per pack size:
+// the cell register read, the decode and min/max loops, and the battery
+// screen grid. One instantiation per supported pack (CellPack.cpp).
+template <uint8_t N>
+struct CellPack {
+    static_assert(N >= CELLS_STOCK && N <= CELLS_MAX, "Pack size outside ScooterData::cellMv");
+
+    static constexpr uint8_t cells = N;
+    static constexpr uint8_t readLen = N * 2;
+    static constexpr uint8_t gridCols = (N + CELL_GRID_ROWS - 1) / CELL_GRID_ROWS;
+    static constexpr uint8_t gridPitch = CELL_GRID_WIDTH / gridCols;
+    // "4.12V" needs ~40 px; narrower cells drop the unit
+    static constexpr bool gridUnit = gridPitch >= 45;
+
+    // Cell register reply into cellMv, min and max. A reply shorter than
+    // the pack is ignored.
+    static uint8_t decode(ScooterData& d, const uint8_t* data, uint8_t len);
+};
+
+// Runtime handle on one instantiation, picked once per link
+struct CellPackInfo {
+    uint8_t cells;
+    uint8_t readLen;
+    uint8_t gridCols;
+    uint8_t gridPitch;
+    bool gridUnit;
+    uint8_t (*decode)(ScooterData& d, const uint8_t* data, uint8_t len);
+};
+
+// 10S stock, 12S and 13S conversions, 16S
+#define CELL_PACK_COUNT         4
+extern const CellPackInfo CELL_PACKS[CELL_PACK_COUNT];
+
+// Smallest supported pack with room for 'present' cells
+const CellPackInfo& cellPackFor(uint8_t present);
+// Populated cells at the start of a cell register reply
+uint8_t cellsPresent(const uint8_t* data, uint8_t len);
+
+#endif
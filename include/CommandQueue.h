@@ -0,0 +1,111 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <stdint.h>
+#include "ScooterData.h"
+#include "M365Protocol.h"
+
+enum ControlType : uint8_t {
+    CTL_LOCK = 0,       // highest priority first
+    CTL_LIGHT,
+    CTL_MODE,
+    CTL_CRUISE,
+    CTL_COUNT
+};
+
+// Step to the next value instead of setting one
+#define CTL_STEP            -1
+
+// Read-back goes out this long after the write, once the ESC has applied it
+#define CTL_READBACK_MS     40
+// Rewritten when the read-back hasn't confirmed it by then
+#define CTL_ACK_TIMEOUT_MS  300
+#define CTL_MAX_TRIES       3
+// Locking is refused above this speed (0.001 km/h)
+#define CTL_LOCK_MAX_SPEED_RAW  3000
+
+// One write and how to confirm it
+struct ControlSpec {
+    uint8_t values;         // number of states; CTL_STEP cycles through them
+    uint8_t readReg;
+    uint8_t readLen;
+    const char* name;
+};
+
+extern const ControlSpec CONTROL_SPECS[CTL_COUNT];
+
+// One frame for M365Client to send; len is the payload length for
+// reads, the 16-bit value for writes
+struct ControlFrame {
+    uint8_t cmd;
+    uint8_t reg;
+    uint16_t value;
+};
+
+// Tap to confirmed state, per control
+struct ControlStats {
+    uint32_t acked;
+    uint32_t failed;
+    uint32_t coalesced;
+    uint32_t lastMs;
+    uint32_t maxMs;
+    uint32_t totalMs;
+};
+
+// Called when a write is confirmed (ok) or given up on
+typedef void (*ControlHook)(void* ctx, ControlType type, uint8_t value, bool ok, uint32_t latencyMs);
+
+// Pending scooter writes, at most one per control: a new request for a
+// control that is still queued replaces its target, so repeated presses
+// collapse into one write. next() hands out the frame of the highest
+// priority control that has something to send, ahead of the poll
+// schedule. A write counts as done once the state decoded from a
+// read-back matches the target. Pure logic, like M365Poller.
+class CommandQueue {
+public:
+    CommandQueue();
+
+    void reset();
+    // 'at' is when the request was made (the tap), for the latency
+    // figures. False if refused (locking while moving).
+    bool request(ControlType type, int8_t value, const ScooterData& data, uint32_t at);
+    bool next(uint32_t now, ControlFrame& out);
+    // True when next() would hand out a frame
+    bool ready(uint32_t now) const;
+    void check(const ScooterData& data, uint32_t now);
+    void setHook(ControlHook fn, void* ctx) { hook = fn; hookCtx = ctx; }
+
+    bool busy(ControlType type) const { return slots[type].state != SLOT_IDLE; }
+    uint8_t target(ControlType type) const { return slots[type].target; }
+    const ControlStats& getStats(ControlType type) const { return stats[type]; }
+
+    static uint8_t observed(ControlType type, const ScooterData& data);
+
+private:
+    enum SlotState : uint8_t {
+        SLOT_IDLE = 0,
+        SLOT_WRITE,         // write due
+        SLOT_READBACK,      // written, read-back due at 'due'
+        SLOT_WAIT           // read-back sent, waiting for the state to follow
+    };
+
+    struct Slot {
+        SlotState state;
+        uint8_t target;
+        uint8_t tries;
+        uint32_t requestedAt;
+        uint32_t writtenAt;
+        uint32_t due;
+    };
+
+    Slot slots[CTL_COUNT];
+    ControlStats stats[CTL_COUNT];
+
+    ControlHook hook;
+    void* hookCtx;
+
+    void finish(ControlType type, bool ok, uint32_t now);
+    static void encode(ControlType type, uint8_t value, ControlFrame& out);
+};
+
+#endif
@@ -3,6 +3,20 @@
 
 #include <TFT_eSPI.h>
 #include "ScooterData.h"
+#include "SpeedGauge.h"
+#include "HistoryStore.h"
+#include "TouchInput.h"
+#include "ScreenCache.h"
+#include "FlashJournal.h"
+#include "AlertEngine.h"
+#include "TripRecorder.h"
+#include "MemTelemetry.h"
+#include "M365Client.h"
+#include "FleetMonitor.h"
+#include "SpeedFilter.h"
+#include "ScreenLayout.h"
+#include "LoopHealth.h"
+#include "CellPack.h"
 
 // Colors
 #define COLOR_BG        0x0000
@@ -16,12 +30,54 @@
 #define COLOR_CYAN      0x07FF
 #define COLOR_BLUE      0x001F
 
-#define HISTORY_SIZE 60
+// Backlight on LEDC PWM
+#define BACKLIGHT_PIN       21
+#define BACKLIGHT_LEDC_CH   0
+#define BACKLIGHT_PWM_FREQ  5000
+#define BACKLIGHT_PWM_BITS  8
+
+#define RIDES_ROWS          7
+#define TRIP_REDRAW_MS      1000
+
+// Alert banner over the top status strip
+#define ALERT_BANNER_H      28
+#define ALERT_FLASH_MS      150
+
+// Poll gap histogram on the loop screen, two pixels per bin
+#define LOOP_HIST_X         32
+#define LOOP_HIST_Y         152
+#define LOOP_HIST_H         52
 
 enum Screen {
     MAIN_SCREEN = 0,
     STATS_SCREEN = 1,
-    BATTERY_SCREEN = 2
+    BATTERY_SCREEN = 2,
+    GAUGE_SCREEN = 3,
+    RIDES_SCREEN = 4,
+    TRIP_SCREEN = 5,
+    DIAG_SCREEN = 6,
+    LOOP_SCREEN = 7,
+    FLEET_SCREEN = 8,       // only with a fleet attached
+    SCREEN_COUNT
+};
+
+enum TouchAction : uint8_t {
+    ACTION_NONE = 0,
+    ACTION_RESET_TRIP,
+    ACTION_CYCLE_GRAPH_TIER,
+    ACTION_SELECT_CELL,
+    ACTION_CYCLE_MODE,
+    ACTION_TOGGLE_LIGHT,
+    ACTION_TOGGLE_CRUISE,
+    ACTION_TOGGLE_LOCK
+};
+
+// Hit-testable area on a screen, bound to one gesture
+struct TouchRegion {
+    Screen screen;
+    TouchGesture gesture;
+    int16_t x, y, w, h;
+    TouchAction action;
 };
 
 class DisplayUI {
@@ -29,50 +85,139 @@ public:
     DisplayUI(TFT_eSPI& display);
     void begin();
     void update(const ScooterData& data);
-    void handleTouch(uint16_t x, uint16_t y);
+    void handleTouch(const TouchEvent& evt);
     void showStatus(const char* message);
+    void prepare();
     void setScreen(Screen screen);
+    void setGraphTier(HistoryTier tier);
+    void cycleGraphTier();
+    void setBacklight(uint8_t duty);
+    void setJournal(const FlashJournal* j) { journal = j; }
+    void setAlerts(const AlertEngine* a) { alerts = a; }
+    void setTrip(TripRecorder* t) { trip = t; }
+    void setMemTelemetry(const MemTelemetry* m) { mem = m; }
+    // Loop figures for their screen; screen clears are timed as their own section
+    void setLoopHealth(LoopHealth* h) { health = h; }
+    // Scooter writes and timestamped speed samples
+    void setClient(M365Client* c) { client = c; }
+    void setFleet(const FleetMonitor* f) { fleet = f; }
+    // Screens the layout defines replace the built-in ones
+    void setLayout(ScreenLayout* l);
+    Screen getScreen() const { return currentScreen; }
+    void flashBacklight(uint8_t times);
+    uint8_t getBacklight() const { return backlight; }
     
 private:
     TFT_eSPI& tft;
     
     // Cached values
-    float lastSpeed;
+    int32_t lastSpeed;
     uint8_t lastBattery;
     uint32_t lastOdometer;
     uint32_t lastTrip;
-    float lastPower;
+    int32_t lastPower;
     uint8_t lastMode;
     bool lastHeadlight;
+    uint8_t lastSwitches;
+    uint8_t lastPending;
     uint8_t lastError;
-    float lastVoltage;
-    float lastCurrent;
-    float lastTempESC;
-    float lastTempBMS;
+    int32_t lastVoltage;
+    int32_t lastCurrent;
+    int32_t lastTempESC;
+    int32_t lastTempBMS;
     uint32_t lastRideTime;
     bool lastConnected;
     bool firstDraw;
     bool needsClear;
     Screen currentScreen;
+    int8_t selectedCell;
+    uint8_t backlight;
+    SpeedGauge gauge;
+    ScreenCache chrome;
+    unsigned long switchStartUs;
     
     // Graph history
-    float powerHistory[HISTORY_SIZE];
-    float currentHistory[HISTORY_SIZE];
-    int historyIndex;
-    unsigned long lastHistoryUpdate;
+    HistoryStore history;
+    HistoryTier graphTier;
+    uint32_t lastGraphVersion;
+    HistoryBucket graphBuf[HISTORY_MAX_SIZE];
+    
+    // Ride browser
+    const FlashJournal* journal;
+    uint32_t lastJournalVersion;
+    
+    // Trip statistics, refreshed when the recorder publishes
+    TripRecorder* trip;
+    TripSummary tripView;
+    uint32_t lastTripVersion;
+    uint32_t tripDrawnVersion;
+    uint32_t lastTripDraw;
+    
+    // Diagnostics
+    const MemTelemetry* mem;
+    uint32_t lastMemVersion;
+    LoopHealth* health;
+    uint32_t lastHealthVersion;
+    uint32_t lastStallAt;
+    
+    // Battery screen cell grid, for the pack it was laid out for
+    const CellPackInfo* cellGrid;
+    
+    // Depot overview
+    const FleetMonitor* fleet;
+    uint32_t lastFleetVersion;
+    
+    // Scooter writes from the status bar icons, speed samples for the filter
+    M365Client* client;
+    SpeedFilter speedFilter;
+    uint32_t lastSpeedSeq;
+    int32_t smoothSpeedRaw;     // filtered, at this frame
+    int16_t shownSpeed;         // readout after the hysteresis
+    
+    // Loaded screen layout, if any
+    ScreenLayout* layout;
+    
+    // Alerts
+    const AlertEngine* alerts;
+    uint32_t lastAlertVersion;
+    bool alertsChanged;
+    bool bannerUp;
+    uint8_t flashToggles;
+    uint32_t flashNextMs;
     
     void drawMainScreen(const ScooterData& data);
+    void drawStatusBar(const ScooterData& data);
+    void drawLayoutScreen(const LayoutScreen& s, const ScooterData& data);
+    void drawLayoutChrome(const LayoutScreen& s, TFT_eSPI& gfx, int16_t yOff);
     void drawStatsScreen(const ScooterData& data);
     void drawBatteryScreen(const ScooterData& data);
+    void drawCells(const ScooterData& data);
+    void drawGaugeScreen(const ScooterData& data);
+    void drawRidesScreen();
+    void drawTripScreen();
+    void drawDiagScreen();
+    void drawLoopScreen();
+    void drawFleetScreen();
+    Screen stepScreen(int8_t dir) const;
+    
+    void runAction(TouchAction action, const TouchEvent& evt);
+    
+    static void paintChrome(void* ctx, uint8_t slot, TFT_eSPI& gfx, int16_t yOff);
+    void drawChrome(Screen screen, TFT_eSPI& gfx, int16_t yOff);
     
     void drawBatteryBar(int x, int y, int w, int h, int percent);
     void drawModeIcon(int x, int y, uint8_t mode);
     void drawBleStatus(int x, int y, bool connected);
     void drawHeadlight(int x, int y, bool on);
+    void drawSwitches(int x, int y, bool cruise, bool locked);
+    void drawPending(int x, int y, int w, bool pending);
     void drawErrorIcon(int x, int y, uint8_t error);
+    void drawAlertBanner();
+    void updateFlash();
+    uint16_t alertColor(AlertInput in) const;
     void updateHistory(const ScooterData& data);
-    void drawGraph(int x, int y, int w, int h, float* data, int count, uint16_t color, const char* label);
-    void formatTime(uint32_t seconds, char* buf);
+    void updateSpeed(const ScooterData& data);
+    void drawGraph(int x, int y, int w, int h, HistoryChannel ch, uint16_t color, const char* label);
 };
 
 #endif
@@ -0,0 +1,36 @@
+#ifndef FAST_FORMAT_H
+#define FAST_FORMAT_H
+
+#include <stdint.h>
+
+// Integer-only number formatting for the render path.
+// Values are passed pre-scaled: fmtFixed(buf, 1234, 1) -> "123.4".
+// All functions write a NUL-terminated string and return its length.
+// No floating point, no heap, no printf.
+
+#define FMT_MAX_DECIMALS 4
+
+uint8_t fmtUint(char* buf, uint32_t value);
+uint8_t fmtInt(char* buf, int32_t value);
+uint8_t fmtFixed(char* buf, int32_t scaled, uint8_t decimals);
+
+// Right-aligned variants pad on the left to 'width' characters
+uint8_t fmtUintRight(char* buf, uint32_t value, uint8_t width, char pad = ' ');
+uint8_t fmtFixedRight(char* buf, int32_t scaled, uint8_t decimals, uint8_t width, char pad = ' ');
+
+// "m:ss"-style ride timer: "MM:SS" below one hour, "H:MM:SS" above
+uint8_t fmtTime(char* buf, uint32_t seconds);
+
+// Microseconds with a unit: "850us", "12.4ms", "10.2s"
+uint8_t fmtDuration(char* buf, uint32_t us);
+
+// Append a suffix (unit) after a formatted number, returns new length
+uint8_t fmtAppend(char* buf, uint8_t len, const char* suffix);
+
+// Rounded integer division used when rescaling raw units for display
+inline int32_t fmtDivRound(int32_t value, int32_t divisor) {
+    return value >= 0 ? (value + divisor / 2) / divisor
+                      : -((-value + divisor / 2) / divisor);
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef FLASH_JOURNAL_H
+#define FLASH_JOURNAL_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "ScooterData.h"
+
+#define JOURNAL_INDEX_PATH      "/rides.idx"
+#define JOURNAL_FAULT_DIR       "/faults"
+#define JOURNAL_MAGIC           0x4A363533UL    // "356J"
+#define JOURNAL_VERSION         1
+#define JOURNAL_RIDE_SLOTS      64
+#define JOURNAL_FAULT_FILES     8
+
+// A ride starts on movement and ends after this long still or on disconnect
+#define JOURNAL_RIDE_END_MS     300000
+#define JOURNAL_MIN_RIDE_M      100
+// In-progress summary is rewritten this often, not per sample
+#define JOURNAL_CHECKPOINT_MS   300000
+
+// Pre-fault capture: 30 s at 10 Hz
+#define JOURNAL_FAULT_PERIOD_MS 100
+#define JOURNAL_FAULT_SAMPLES   300
+#define JOURNAL_TEMP_ESC_TRIP   700     // 0.1 C
+#define JOURNAL_TEMP_ESC_HYST   50      // 0.1 C
+#define JOURNAL_TEMP_BMS_TRIP   55      // C
+#define JOURNAL_TEMP_BMS_HYST   5       // C
+
+// One ride, 32 bytes. The index file is a header plus a fixed ring of
+// these, mirrored in RAM so browsing never touches flash.
+struct RideSummary {
+    uint32_t seq;               // 0 = empty slot
+    uint32_t startOdometer;     // m
+    uint32_t distance;          // m
+    uint16_t duration;          // s
+    uint16_t energyWh10;        // 0.1 Wh
+    int16_t  maxSpeedRaw;       // 0.001 km/h
+    int16_t  maxCurrentRaw;     // 10 mA
+    int16_t  maxTempESCRaw;     // 0.1 C
+    uint16_t minCellMv;
+    int8_t   maxTempBMS;        // C
+    uint8_t  startBattery;      // %
+    uint8_t  endBattery;        // %
+    uint8_t  errors[3];         // first distinct error codes seen
+};
+
+static_assert(sizeof(RideSummary) == 32, "RideSummary must stay 32 bytes");
+
+struct JournalHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t slots;
+    uint32_t nextRide;
+    uint32_t nextFault;
+};
+
+enum FaultReason : uint8_t {
+    FAULT_ERROR_CODE = 1,
+    FAULT_TEMP_ESC,
+    FAULT_TEMP_BMS
+};
+
+struct FaultSample {
+    uint32_t time;              // ms
+    int16_t  speedRaw;
+    int16_t  currentRaw;
+    uint16_t voltageRaw;
+    int16_t  tempESCRaw;
+    uint16_t minCellMv;
+    int8_t   tempBMS;           // hotter of the two sensors
+    uint8_t  errorCode;
+};
+
+static_assert(sizeof(FaultSample) == 16, "FaultSample must stay 16 bytes");
+
+struct FaultHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t rideSeq;
+    uint32_t odometer;
+    uint8_t  reason;
+    uint8_t  errorCode;
+    uint16_t samples;
+};
+
+// Ride summaries and pre-fault snapshots on the internal LittleFS
+// partition, for boards without an SD card. update() only touches RAM;
+// flash writes are handed to a low priority task, batched to one index
+// rewrite per checkpoint or ride end and one file per fault.
+class FlashJournal {
+public:
+    FlashJournal();
+
+    bool begin();
+    void update(const ScooterData& data, uint32_t now);
+
+    // Newest first; returns the number copied
+    uint8_t recentRides(RideSummary* out, uint8_t max) const;
+    uint32_t getVersion() const { return version; }
+    uint32_t getFaultCount() const { return header.nextFault; }
+
+private:
+    bool mounted;
+    JournalHeader header;
+    RideSummary rides[JOURNAL_RIDE_SLOTS];
+    mutable portMUX_TYPE lock;
+    volatile uint32_t version;
+
+    // Current ride
+    bool riding;
+    RideSummary ride;
+    uint32_t rideStart;
+    uint32_t lastMoving;
+    uint32_t lastCheckpoint;
+    uint32_t lastEnergy;
+    int64_t energyMwMs;
+
+    // Pre-fault ring
+    FaultSample ring[JOURNAL_FAULT_SAMPLES];
+    uint16_t ringHead;
+    uint16_t ringCount;
+    uint32_t lastRingSample;
+    uint8_t lastError;
+    bool escHot;
+    bool bmsHot;
+
+    // Hand-off to the writer task
+    TaskHandle_t task;
+    volatile bool summaryPending;
+    volatile bool faultPending;
+    FaultHeader faultHeader;
+    FaultSample faultBuf[JOURNAL_FAULT_SAMPLES];
+    uint32_t faultsMissed;
+
+    bool loadIndex();
+    void startRide(const ScooterData& data, uint32_t now);
+    void trackRide(const ScooterData& data, uint32_t now);
+    void finishRide();
+    void queueSummary();
+    void captureFault(FaultReason reason, const ScooterData& data);
+    void checkFaults(const ScooterData& data, uint32_t now);
+
+    static void taskEntry(void* arg);
+    void run();
+    void writeSummary();
+    void writeFault();
+};
+
+#endif
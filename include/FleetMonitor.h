@@ -0,0 +1,60 @@
+#ifndef FLEET_MONITOR_H
+#define FLEET_MONITOR_H
+
+#include <Arduino.h>
+#include "M365Client.h"
+#include "FleetScheduler.h"
+
+#define FLEET_RATE_MS       1000
+#define FLEET_REPORT_MS     10000
+
+// One line of the fleet overview
+struct FleetRow {
+    LinkState state;
+    const char* stateName;
+    int8_t rssi;
+    uint8_t batteryLevel;
+    int16_t tempESCRaw;         // 0.1 C
+    int16_t tempBMSX10;         // 0.1 C
+    uint8_t errorCode;
+    uint16_t framesX10;         // decoded frames per 10 s
+};
+
+// Several scooters on one dashboard (depot mode). Each scooter keeps its
+// own transport, M365Client, poll schedule and command queue; this runs
+// them all from the protocol task and hands out requests through one
+// FleetScheduler, so the links share the radio fairly. Slot 0 is the
+// scooter the riding screens show.
+class FleetMonitor {
+public:
+    FleetMonitor();
+
+    // Before begin()
+    bool add(M365Client* client);
+    void begin();
+    void update();
+
+    uint8_t size() const { return count; }
+    // Any task
+    void getRow(uint8_t i, FleetRow& out) const;
+    // Incremented once per rate window
+    uint32_t getVersion() const { return version; }
+    void report() const;
+
+private:
+    M365Client* clients[FLEET_MAX_SCOOTERS];
+    uint8_t count;
+    FleetScheduler scheduler;
+
+    uint32_t lastRate;
+    uint32_t lastReport;
+    uint32_t lastFrames[FLEET_MAX_SCOOTERS];
+    uint32_t lastGrants[FLEET_MAX_SCOOTERS];
+    volatile uint16_t framesX10[FLEET_MAX_SCOOTERS];
+    volatile uint16_t requestsX10[FLEET_MAX_SCOOTERS];
+    volatile uint32_t version;
+
+    void updateRates(uint32_t now);
+};
+
+#endif
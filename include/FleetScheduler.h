@@ -0,0 +1,38 @@
+#ifndef FLEET_SCHEDULER_H
+#define FLEET_SCHEDULER_H
+
+#include <stdint.h>
+
+// NimBLE's default CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#define FLEET_MAX_SCOOTERS  3
+// Shared request budget: at most one request per tick across all links.
+// next() runs on the 10 ms protocol tick, so this rounds up to a grant
+// every FLEET_GRANT_MS, 50 requests/s shared; 15 rather than 20 keeps a
+// late protocol tick from stretching a gap to 30 ms.
+#define FLEET_TICK_MS       15
+#define FLEET_GRANT_MS      20
+
+// Round-robin over the links that have a request due, one grant per
+// tick. A link with nothing due is skipped rather than holding its turn,
+// so one scooter polls at its own interval until the shared budget runs
+// out, and from then on every link gets an equal share of it. Pure
+// timing logic like M365Poller.
+class FleetScheduler {
+public:
+    FleetScheduler();
+
+    void setTick(uint16_t ms) { tickMs = ms; }
+    // Link that may send now, or -1; bit i of 'ready' is set when link i
+    // has a request due
+    int8_t next(uint32_t now, uint32_t ready);
+
+    uint32_t getGrants(uint8_t link) const { return grants[link]; }
+
+private:
+    uint32_t lastGrant;
+    uint16_t tickMs;
+    uint8_t cursor;
+    uint32_t grants[FLEET_MAX_SCOOTERS];
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef GRAPH_SCALE_H
+#define GRAPH_SCALE_H
+
+#include <stdint.h>
+#include "HistoryStore.h"
+
+// One plotted column: the buckets that fall into it merged together
+struct GraphColumn {
+    int32_t lo;
+    int32_t hi;
+    int32_t avg;
+};
+
+// Rounds up to the next 1-2-5 step, never below minScale
+int32_t niceScale(int32_t v, int32_t minScale);
+
+// Full-scale value for a series: peak plus 20 % headroom, 1-2-5 rounded
+int32_t graphScale(const HistoryBucket* buckets, uint16_t n, int32_t minScale);
+
+// One column per bucket, or several buckets merged per pixel column
+inline uint16_t graphPoints(uint16_t n, int16_t plotW) {
+    return n < plotW ? n : plotW;
+}
+
+// Merges the buckets of column j; false if none of them holds data.
+// lo and avg are clamped at zero (graphs show magnitudes).
+bool graphColumn(const HistoryBucket* buckets, uint16_t n, uint16_t points, uint16_t j, GraphColumn& col);
+
+// Pixel offset from the top of a plot 'plotH' tall, clamped to the top
+inline int16_t graphPixel(int32_t v, int32_t maxVal, int16_t plotH) {
+    int32_t p = plotH - v * plotH / maxVal;
+    return p < 0 ? 0 : (int16_t)p;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <stdint.h>
+#include "ScooterData.h"
+
+enum HistoryChannel {
+    HIST_POWER = 0,     // W
+    HIST_CURRENT,       // 10 mA, magnitude
+    HIST_SPEED,         // 0.01 km/h
+    HIST_VOLTAGE,       // 10 mV
+    HIST_TEMP_ESC,      // 0.1 C
+    HIST_TEMP_BMS,      // 0.1 C, average of both sensors
+    HIST_IMBALANCE,     // mV
+    HIST_CHANNELS
+};
+
+enum HistoryTier {
+    TIER_RAW = 0,       // 250 ms samples, last minute
+    TIER_10S,           // 10 s buckets, last 15 minutes
+    TIER_1MIN,          // 1 min buckets, last 5 hours
+    TIER_COUNT
+};
+
+#define HISTORY_RAW_PERIOD_MS   250
+#define HISTORY_RAW_SIZE        240
+#define HISTORY_10S_SIZE        90
+#define HISTORY_1MIN_SIZE       300
+#define HISTORY_MAX_SIZE        HISTORY_1MIN_SIZE
+
+struct HistoryBucket {
+    int16_t min;
+    int16_t max;
+    int16_t avg;
+    uint16_t count;
+};
+
+// Fixed-size tiered time series (~25 KB for all channels).
+// Every addSample() call feeds the 10 s / 1 min accumulators, so short
+// spikes survive in the bucket min/max even after the raw tier rolls over.
+class HistoryStore {
+public:
+    HistoryStore();
+
+    void reset();
+    void addSample(const ScooterData& data, uint32_t now);
+
+    // Copies a tier oldest -> newest into 'out', returns the number of buckets
+    uint16_t getSeries(HistoryChannel ch, HistoryTier tier, HistoryBucket* out, uint16_t maxCount) const;
+
+    uint16_t tierCapacity(HistoryTier tier) const;
+    uint32_t tierPeriodMs(HistoryTier tier) const;
+    // Incremented whenever a tier gains a point, lets graphs skip redraws
+    uint32_t tierVersion(HistoryTier tier) const { return version[tier]; }
+
+private:
+    struct Accumulator {
+        int16_t min;
+        int16_t max;
+        int32_t sum;
+        uint16_t count;
+    };
+
+    int16_t raw[HIST_CHANNELS][HISTORY_RAW_SIZE];
+    HistoryBucket tier10s[HIST_CHANNELS][HISTORY_10S_SIZE];
+    HistoryBucket tier1min[HIST_CHANNELS][HISTORY_1MIN_SIZE];
+
+    Accumulator acc10s[HIST_CHANNELS];
+    Accumulator acc1min[HIST_CHANNELS];
+
+    uint16_t head[TIER_COUNT];
+    uint16_t count[TIER_COUNT];
+    uint32_t version[TIER_COUNT];
+
+    uint32_t lastRawSample;
+    uint32_t bucket10sStart;
+    uint32_t bucket1minStart;
+    bool started;
+
+    static void extract(const ScooterData& data, int16_t* values);
+    static void accumulate(Accumulator& acc, int16_t value);
+    static HistoryBucket closeBucket(Accumulator& acc);
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+// Log-scale bins: 8 per octave (12.5% wide) from 64 us up to 4.2 s.
+// The first bin also takes anything shorter, the last anything longer;
+// the exact maximum is kept separately.
+#define LATENCY_MIN_SHIFT       6
+#define LATENCY_SUB_BITS        3
+#define LATENCY_OCTAVES         16
+#define LATENCY_BINS            (LATENCY_OCTAVES << LATENCY_SUB_BITS)
+
+// Durations in microseconds. Counts are 16 bit and saturate: a histogram
+// covers one report window, not the whole uptime. Pure logic, no locking.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void reset();
+    void add(uint32_t us);
+
+    uint32_t count() const { return n; }
+    uint32_t maxUs() const { return peak; }
+    uint32_t meanUs() const { return n ? (uint32_t)(sumUs / n) : 0; }
+    uint16_t bin(uint8_t b) const { return bins[b]; }
+    // Interpolated within the bin it falls in, never past the maximum
+    uint32_t percentile(uint8_t pct) const;
+
+    static uint8_t binOf(uint32_t us);
+    static uint32_t binLow(uint8_t b);
+
+private:
+    uint16_t bins[LATENCY_BINS];
+    uint32_t n;
+    uint32_t peak;
+    uint64_t sumUs;
+};
+
+#endif
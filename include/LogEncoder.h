@@ -0,0 +1,58 @@
+#ifndef LOG_ENCODER_H
+#define LOG_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ScooterData.h"
+#include "TelemetryFields.h"
+
+// Ride log file layout (all little endian):
+//
+//   block 0      schema: "M365LOG\0", u16 version, u16 block size,
+//                u8 field count, then per field u16 scale, u8 len + name,
+//                u8 len + unit; CRC32 in the last 4 bytes
+//   block 1..n   u32 magic "M3LB", u32 sequence, u32 base time (ms)
+//                records...
+//                zero padding
+//                u16 payload bytes, u16 record count, u32 CRC32 of
+//                everything before it
+//
+// A record is varint(dt ms), varint(changed-field mask), then one
+// zigzag varint delta per set bit. Deltas restart from zero in every
+// block, so each block decodes on its own and a torn write costs at
+// most the block it hit. Blocks are one SD sector, so a block sealed
+// early on its deadline pads little; the schema (414 bytes for the
+// current fields) must fit one as well.
+#define LOG_BLOCK_SIZE      512
+#define LOG_BLOCK_MAGIC     0x424C334DUL
+#define LOG_FORMAT_VERSION  1
+#define LOG_HEADER_BYTES    12
+#define LOG_TRAILER_BYTES   8
+#define LOG_MAX_RECORD      (5 + TF_MASK_VARINT_BYTES + TF_COUNT * 5)
+
+uint32_t logCrc32(const uint8_t* data, size_t len);
+void logWriteSchema(uint8_t* block);
+
+class LogEncoder {
+public:
+    LogEncoder();
+
+    void begin(uint8_t* block, uint32_t seq, uint32_t time);
+    bool append(const ScooterData& data, uint32_t time);
+    void seal();
+
+    bool isOpen() const { return block != nullptr; }
+    uint16_t records() const { return count; }
+    uint16_t bytesUsed() const { return pos; }
+    uint32_t openedAt() const { return baseTime; }
+
+private:
+    uint8_t* block;
+    uint16_t pos;
+    uint16_t count;
+    uint32_t baseTime;
+    uint32_t lastTime;
+    int32_t prev[TF_COUNT];
+};
+
+#endif
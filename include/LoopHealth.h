@@ -0,0 +1,110 @@
+#ifndef LOOP_HEALTH_H
+#define LOOP_HEALTH_H
+
+#include <Arduino.h>
+#include "LatencyHistogram.h"
+
+// An iteration longer than this is a stall: the protocol task misses its
+// 10 ms period, the render task a frame at the active 50 ms rate
+#define LOOP_PROTO_BUDGET_US    10000
+#define LOOP_RENDER_BUDGET_US   50000
+// Stalls in a row print at most this often; all of them are counted
+#define LOOP_STALL_PRINT_MS     1000
+
+enum LoopId : uint8_t {
+    LOOP_PROTO = 0,
+    LOOP_RENDER,
+    LOOP_COUNT
+};
+
+// What an iteration was doing, so a stall names its culprit
+enum LoopSection : uint8_t {
+    SEC_LINK = 0,       // client update: scan, connect, drain, send
+    SEC_LOG,            // logger, stream, journal and trip feed
+    SEC_TOUCH,          // touch events and their actions
+    SEC_POWER,          // power modes and backlight
+    SEC_ALERTS,         // alert engine and its hook
+    SEC_DRAW,           // DisplayUI::update
+    SEC_CLEAR,          // full-screen clear or chrome blit on a switch
+    SEC_STATUS,         // link status message
+    SEC_MISC,           // buzzer, memory sampling
+    SEC_REPORT,         // serial reports
+    SEC_COUNT
+};
+
+// Gaps between events that should come at a steady rate
+enum LoopCadence : uint8_t {
+    CAD_UPDATE = 0,     // client update() calls, every 10 ms
+    CAD_POLL,           // poll requests, every poll interval
+    CAD_FRAME,          // UI frames, every frame interval
+    CAD_COUNT
+};
+
+struct LoopStall {
+    uint8_t loop;
+    uint8_t section;            // the one that ran longest
+    uint32_t us;                // whole iteration
+    uint32_t sectionUs;
+    uint32_t at;                // millis
+};
+
+// One report window
+struct LoopWindow {
+    LatencyHistogram iter[LOOP_COUNT];
+    LatencyHistogram gap[CAD_COUNT];
+    uint32_t sectionMaxUs[LOOP_COUNT][SEC_COUNT];
+    uint16_t stalls[LOOP_COUNT];
+    uint16_t stallSections[SEC_COUNT];
+    uint32_t ms;
+};
+
+// Iteration times and event cadence of the protocol and render loops.
+// Each loop brackets an iteration with begin()/end() and switches
+// section() as it goes; only its own task touches its loop. report()
+// and the published window belong to the render task.
+class LoopHealth {
+public:
+    LoopHealth();
+
+    void begin(LoopId loop, LoopSection first);
+    void section(LoopId loop, LoopSection s);
+    void end(LoopId loop);
+
+    void cadence(LoopCadence ch);
+    // Next event starts a new run (link drop, screen off)
+    void breakCadence(LoopCadence ch);
+
+    // Prints the window, publishes it and starts the next
+    void report();
+    const LoopWindow& published() const { return shown; }
+    uint32_t getVersion() const { return version; }
+    // Most recent stall, or at == 0
+    LoopStall lastStall();
+
+private:
+    struct Run {
+        uint32_t start;
+        uint32_t sectionStart;
+        uint8_t section;
+        uint32_t spent[SEC_COUNT];  // this iteration
+        uint32_t lastPrint;
+        uint32_t suppressed;
+    };
+
+    portMUX_TYPE lock;
+    Run runs[LOOP_COUNT];
+    uint32_t lastEvent[CAD_COUNT];
+    LoopWindow live;
+    LoopWindow shown;
+    LoopStall stall;
+    uint32_t windowStart;
+    uint32_t version;
+
+    void closeSection(Run& r, uint32_t now);
+};
+
+const char* loopName(LoopId loop);
+const char* loopSectionName(LoopSection s);
+const char* loopCadenceName(LoopCadence ch);
+
+#endif
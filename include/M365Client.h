@@ -0,0 +1,116 @@
+#ifndef M365_CLIENT_H
+#define M365_CLIENT_H
+
+#include <Arduino.h>
+#include "ScooterData.h"
+#include "M365Protocol.h"
+#include "M365Poller.h"
+#include "M365Replay.h"
+#include "M365Transport.h"
+#include "CommandQueue.h"
+
+#define M365_MAX_CAPTURES   2
+#define M365_RX_CHUNK       512
+
+// Latest decoded speed and when it arrived; seq moves on every reply,
+// also when the value repeats
+struct SpeedSample {
+    int32_t speedRaw;
+    uint32_t at;
+    uint32_t seq;
+};
+
+// Talks to the scooter over any M365Transport: runs the poll schedule,
+// feeds received bytes to capture sinks and the parser, and publishes
+// ScooterData snapshots for the other tasks.
+class M365Client {
+public:
+    M365Client(M365Transport& transport);
+    
+    void begin();
+    void update();
+    
+    // Paced: update() only receives, and requests go out when a shared
+    // scheduler calls sendNext() (fleet mode)
+    void setPaced(bool on) { paced = on; }
+    bool wantsSend(uint32_t now);
+    bool sendNext(uint32_t now);
+    
+    bool requestESCData();
+    bool requestBMSData();
+    bool requestCellVoltages();
+    
+    void setPollInterval(uint16_t ms);
+    void setReducedPolling(bool reduced) { poller.setReduced(reduced); }
+    void setConnInterval(uint16_t units) { transport.setConnInterval(units); }
+    uint32_t getRxDropped() const { return transport.getRxDropped(); }
+    uint32_t getSampleCount() const { return protocol.getFrames(); }
+    uint32_t getPolls() const { return poller.getPolls(); }
+    M365Protocol& getProtocol() { return protocol; }
+    
+    // Both may be called from another task while update() runs
+    void addCapture(CaptureSink* sink);
+    void startReplay(M365Replay* replay, bool realtime);
+    
+    // Any task: set a control (or CTL_STEP to the next value), applied
+    // on the next update(). 'at' is the millis() of the tap behind it.
+    bool control(ControlType type, int8_t value, uint32_t at);
+    // Requested and not confirmed yet
+    bool controlPending(ControlType type) const { return (pendingMask >> type) & 1; }
+    
+    ScooterData getData() const;
+    SpeedSample getSpeedSample() const;
+    LinkState getState() const { return state; }
+    bool isConnected() const {
+        return state == LinkState::CONNECTED || state == LinkState::AUTHENTICATED || state == LinkState::REPLAY;
+    }
+    int8_t getRSSI() const { return transport.getRSSI(); }
+    const char* getStateName() const;
+    void report() const;
+    
+private:
+    M365Transport& transport;
+    M365Protocol protocol;
+    M365Poller poller;
+    uint8_t cellReadLen;            // last given to the poller
+    ScooterData& scooterData;       // working copy, protocol task only
+    ScooterData snapshot;           // published copy for other tasks
+    mutable portMUX_TYPE snapshotLock;
+    SpeedSample speedSample;        // published with the snapshot
+    uint32_t speedSeen;
+    uint32_t speedAt;
+    LinkState state;
+    
+    unsigned long connectionStartTime;
+    bool paced;
+    
+    CaptureSink* captures[M365_MAX_CAPTURES];
+    volatile uint8_t captureCount;
+    
+    // Control requests from other tasks, taken over by update()
+    CommandQueue commands;
+    mutable portMUX_TYPE controlLock;
+    bool requestedSet[CTL_COUNT];
+    uint8_t requestedValue[CTL_COUNT];
+    uint8_t requestedSteps[CTL_COUNT];  // CTL_STEP presses after the value
+    uint32_t requestedAt[CTL_COUNT];
+    volatile uint8_t pendingMask;
+    
+    M365Replay* replay;
+    M365Replay* volatile pendingReplay;
+    bool replayRealtime;
+    unsigned long replayStart;
+    uint32_t replayBusyUs;          // inside feed(), for the fast-mode rate
+    
+    void drainRx();
+    void stampSpeed(uint32_t at);
+    void publish();
+    void updateReplay(unsigned long now);
+    void takeControls();
+    bool sendControl(const ControlFrame& frame);
+    static void onControl(void* ctx, ControlType type, uint8_t value, bool ok, uint32_t latencyMs);
+    
+    bool sendCommand(uint8_t addr, uint8_t cmd, uint8_t reg, uint8_t len);
+};
+
+#endif
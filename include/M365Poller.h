@@ -0,0 +1,44 @@
+#ifndef M365_POLLER_H
+#define M365_POLLER_H
+
+#include <stdint.h>
+#include "M365Protocol.h"
+
+#define POLL_INTERVAL_DEFAULT   100
+#define POLL_SLOTS              16
+
+struct M365Request {
+    uint8_t addr;
+    uint8_t reg;
+    uint8_t len;
+};
+
+// Round-robin read schedule, one request per interval. Speed gets every
+// fourth slot; parked mode alternates speed and BMS current/voltage only.
+// Pure timing logic so the host simulator drives the same schedule as
+// the firmware.
+class M365Poller {
+public:
+    M365Poller();
+
+    void reset(uint32_t now);
+    bool due(uint32_t now, M365Request& req);
+    bool isDue(uint32_t now) const { return now - lastPoll >= intervalMs; }
+
+    void setInterval(uint16_t ms) { intervalMs = ms; }
+    void setReduced(bool on) { reduced = on; }
+    // Bytes per cell register read, from the detected pack
+    void setCellReadLen(uint8_t len) { cellLen = len; }
+    uint16_t getInterval() const { return intervalMs; }
+    uint32_t getPolls() const { return polls; }
+
+private:
+    uint32_t lastPoll;
+    uint16_t intervalMs;
+    uint8_t index;
+    bool reduced;
+    uint8_t cellLen;
+    uint32_t polls;
+};
+
+#endif
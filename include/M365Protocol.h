@@ -0,0 +1,95 @@
+#ifndef M365_PROTOCOL_H
+#define M365_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ScooterData.h"
+#include "CellPack.h"
+
+#define ADDR_ESC    0x20
+#define ADDR_BMS    0x22
+#define ADDR_BLE    0x21
+
+// Reply sources (request address + 3)
+#define ADDR_ESC_REPLY  0x23
+#define ADDR_BMS_REPLY  0x25
+
+#define CMD_READ    0x01
+#define CMD_WRITE   0x03
+
+// ESC registers
+#define REG_ESC_ERROR       0x1B
+#define REG_ESC_ALARM       0x1C
+#define REG_ESC_STATUS      0x1D
+#define REG_ESC_MODE        0x1F
+#define REG_ESC_BATTERY     0x22
+#define REG_ESC_RANGE       0x25
+#define REG_ESC_SPEED       0x26
+#define REG_ESC_ODOMETER    0x29
+#define REG_ESC_TRIP        0x2F
+#define REG_ESC_UPTIME      0x32
+#define REG_ESC_FRAME_TEMP  0x3E
+#define REG_ESC_AVERAGE     0x65
+#define REG_ESC_LOCK        0x70
+#define REG_ESC_UNLOCK      0x71
+#define REG_ESC_SPEED_MODE  0x75    // write side of REG_ESC_MODE
+#define REG_ESC_CRUISE      0x7C
+#define REG_ESC_LIGHT       0x7D    // front and tail together
+
+// REG_ESC_STATUS bits
+#define ESC_STATUS_LOCKED   0x02
+
+// BMS registers
+#define REG_BMS_TEMP        0x35
+#define REG_BMS_CAPACITY    0x31
+#define REG_BMS_FULL_CAP    0x32
+#define REG_BMS_CURRENT     0x33
+#define REG_BMS_VOLTAGE     0x34
+#define REG_BMS_HEALTH      0x3B
+#define REG_BMS_CELLS       0x40
+
+#define M365_COMMAND_LEN    9
+#define M365_WRITE_LEN      10
+
+// 55 AA framing and register decoding, independent of the transport and
+// of Arduino so the same code runs in the firmware and in host tools.
+class M365Protocol {
+public:
+    M365Protocol();
+
+    void processResponse(const uint8_t* data, size_t len);
+    // A new link may be another scooter: its first cell reply sizes the pack again
+    void reset() { rxIndex = 0; cellPack = nullptr; }
+
+    ScooterData& data() { return scooterData; }
+    const ScooterData& data() const { return scooterData; }
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getFields() const { return fields; }
+    uint32_t getBadFrames() const { return badFrames; }
+    // Counts decoded speed replies, so a repeated value is still a sample
+    uint32_t getSpeedSamples() const { return speedSamples; }
+    // Null until the first cell reply after a reset
+    const CellPackInfo* getCellPack() const { return cellPack; }
+    // Full width while detecting, the pack's own afterwards
+    uint8_t getCellReadLen() const { return cellPack ? cellPack->readLen : CELLS_MAX * 2; }
+
+    static uint16_t checksum(const uint8_t* data, uint8_t len);
+    static uint8_t buildCommand(uint8_t* packet, uint8_t addr, uint8_t cmd, uint8_t reg, uint8_t len);
+    static uint8_t buildWrite(uint8_t* packet, uint8_t addr, uint8_t reg, uint16_t value);
+
+private:
+    ScooterData scooterData;
+    uint8_t rxBuffer[256];
+    uint8_t rxIndex;
+    volatile uint32_t frames;
+    uint32_t fields;
+    uint32_t badFrames;
+    uint32_t speedSamples;
+    const CellPackInfo* cellPack;
+
+    uint8_t parseESCResponse(uint8_t reg, const uint8_t* data, uint8_t len);
+    uint8_t parseBMSResponse(uint8_t reg, const uint8_t* data, uint8_t len);
+};
+
+#endif
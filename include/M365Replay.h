@@ -0,0 +1,49 @@
+#ifndef M365_REPLAY_H
+#define M365_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "M365Protocol.h"
+#include "CaptureFormat.h"
+
+// Feeds a capture file back through M365Protocol::processResponse().
+// Reads through a callback so the same engine runs on an SD File on the
+// device and on a FILE* on the host.
+class M365Replay {
+public:
+    typedef size_t (*ReadFn)(void* ctx, uint8_t* buf, size_t len);
+
+    M365Replay(M365Protocol& protocol);
+
+    bool begin(ReadFn read, void* ctx);
+
+    // Real time: feed every record due by 'elapsedMs' since the first one.
+    // Fast: feed up to 'maxRecords' regardless of timestamps.
+    // Returns records fed, or -1 once the capture is exhausted.
+    int32_t feed(uint32_t elapsedMs, bool realtime, uint16_t maxRecords);
+
+    uint32_t getRecords() const { return records; }
+    uint32_t getBytes() const { return bytes; }
+    uint32_t getDuration() const { return lastTime - firstTime; }
+
+private:
+    M365Protocol& protocol;
+    ReadFn read;
+    void* ctx;
+
+    bool pending;
+    bool ended;
+    uint32_t pendingTime;
+    uint16_t pendingLen;
+    uint8_t payload[CAPTURE_MAX_PAYLOAD];
+
+    bool started;
+    uint32_t firstTime;
+    uint32_t lastTime;
+    uint32_t records;
+    uint32_t bytes;
+
+    bool readNext();
+};
+
+#endif
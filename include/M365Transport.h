@@ -0,0 +1,44 @@
+#ifndef M365_TRANSPORT_H
+#define M365_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum class LinkState {
+    DISCONNECTED,
+    SCANNING,
+    CONNECTING,
+    CONNECTED,
+    AUTHENTICATED,
+    REPLAY
+};
+
+// Byte pipe to the scooter. M365Client owns framing, the poll schedule
+// and decoding; a transport only moves 55 AA frames and reports whether
+// the other end is there. All calls come from the protocol task.
+class M365Transport {
+public:
+    virtual ~M365Transport() {}
+
+    virtual void begin() = 0;
+    virtual LinkState update(uint32_t now) = 0;
+
+    // True when a request may go out now
+    virtual bool canSend() = 0;
+    virtual bool send(const uint8_t* data, size_t len) = 0;
+
+    // One chunk of received bytes with its arrival time; 0 when empty
+    virtual size_t receive(uint8_t* buf, size_t maxLen, uint32_t& timeMs) = 0;
+
+    virtual const char* name() const = 0;
+    virtual int8_t getRSSI() const { return 0; }
+    virtual uint32_t getRxDropped() const { return 0; }
+    virtual void setConnInterval(uint16_t units) {}
+
+    // Faster links divide the power profile's poll interval by this
+    virtual uint8_t pollDivisor() const { return 1; }
+
+    virtual void report() const {}
+};
+
+#endif
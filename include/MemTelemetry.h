@@ -0,0 +1,88 @@
+#ifndef MEM_TELEMETRY_H
+#define MEM_TELEMETRY_H
+
+#include <Arduino.h>
+
+#define MEM_SAMPLE_MS           1000
+#define MEM_REPORT_MS           60000
+
+// Soft alarm: the largest free block is a small part of what is free.
+// Only judged while free heap is low enough for it to matter.
+#define MEM_FRAG_ALARM_PCT      60
+#define MEM_FRAG_CLEAR_PCT      50
+#define MEM_FRAG_MIN_FREE       (96 * 1024)
+
+// Tasks whose stack headroom is tracked, looked up by name
+#define MEM_TASK_NAMES      { "proto", "render", "touch", "journal", "trip", "sdlog", "capture", "nimble_host", "bleconn" }
+#define MEM_MAX_TASKS       9
+
+// Code paths whose heap allocations are counted. A MemScope on the
+// stack attributes every operator new made by that task to the path.
+enum MemPath : uint8_t {
+    MEM_PATH_PROTO = 0,     // link update, polling and decoding
+    MEM_PATH_LOG,           // logger, stream, journal and trip feed
+    MEM_PATH_RENDER,        // DisplayUI::update
+    MEM_PATH_SCAN,          // BLE advertisement callback
+    MEM_PATHS
+};
+
+struct MemSnapshot {
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;       // lowest since boot
+    uint32_t largestBlock;
+    uint8_t fragPct;            // 100 - largest block / free
+    bool fragAlarm;
+    uint8_t taskCount;
+    const char* taskName[MEM_MAX_TASKS];
+    uint32_t stackFree[MEM_MAX_TASKS];      // bytes, high-water mark
+    uint32_t allocs[MEM_PATHS];             // since boot
+    uint32_t allocRate[MEM_PATHS];          // per second, last sample
+    uint32_t allocsTotal;
+};
+
+// Periodic heap and stack sampling, and allocation counters fed by the
+// global operator new. update() and the snapshot belong to the render
+// task; the counters may be bumped from any task.
+class MemTelemetry {
+public:
+    MemTelemetry();
+
+    void update(uint32_t now);
+    const MemSnapshot& snapshot() const { return snap; }
+    uint32_t getVersion() const { return version; }
+    void report() const;
+
+    // Called from operator new
+    static void countAlloc();
+
+private:
+    MemSnapshot snap;
+    TaskHandle_t handles[MEM_MAX_TASKS];
+    uint32_t lastSample;
+    uint32_t lastReport;
+    uint32_t lastAllocs[MEM_PATHS];
+    uint32_t version;
+
+    void resolveTasks();
+
+    friend class MemScope;
+    static volatile uint32_t pathAllocs[MEM_PATHS];
+    static volatile uint32_t totalAllocs;
+    static TaskHandle_t volatile pathOwner[MEM_PATHS];
+};
+
+const char* memPathName(MemPath path);
+
+// Attributes the current task's allocations to 'path' until it goes out
+// of scope
+class MemScope {
+public:
+    MemScope(MemPath path);
+    ~MemScope();
+
+private:
+    MemPath path;
+    TaskHandle_t prev;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "ScooterData.h"
+
+class DisplayUI;
+class M365Client;
+
+// Stillness needed before stepping down
+#define POWER_IDLE_AFTER_MS     30000
+#define POWER_PARKED_AFTER_MS   180000
+
+// Anything above these counts as riding (speed 0.001 km/h, current 10 mA)
+#define POWER_WAKE_SPEED_RAW    500
+#define POWER_WAKE_CURRENT_RAW  50
+
+#define POWER_REPORT_MS         60000
+
+// Nominal board draw model used for the per-mode estimate (5 V rail).
+// Typical ESP32 datasheet figures; replace with meter readings if known.
+#define POWER_EST_BASE_MA       20      // LDO, panel logic, USB-UART
+#define POWER_EST_BACKLIGHT_MA  60      // LED string at full duty
+#define POWER_EST_SLEEP_MA      1       // CPU in light sleep
+#define POWER_EST_RADIO_MA_MS   100     // charge per BLE connection event
+
+enum PowerMode : uint8_t {
+    POWER_ACTIVE = 0,
+    POWER_IDLE,
+    POWER_PARKED,
+    POWER_MODE_COUNT
+};
+
+struct PowerProfile {
+    const char* name;
+    uint8_t backlight;          // LEDC duty 0-255
+    uint16_t cpuMhz;
+    uint16_t pollMs;
+    uint16_t connInterval;      // 1.25 ms units
+    bool reducedPolling;
+    uint16_t uiIntervalMs;
+};
+
+// Watches telemetry for the scooter standing still and steps the board
+// down through dimmer, slower profiles. Speed, discharge current or a
+// touch returns to ACTIVE on the spot.
+class PowerManager {
+public:
+    PowerManager(DisplayUI& ui, M365Client& client);
+
+    void begin();
+    void update(const ScooterData& data, uint32_t now);
+
+    // Returns true if the event woke the board (caller should swallow it)
+    bool notifyActivity(uint32_t now);
+    void accountWait(uint32_t us);
+
+    PowerMode getMode() const { return mode; }
+    const PowerProfile& profile() const;
+    uint16_t uiIntervalMs() const { return profile().uiIntervalMs; }
+
+    uint32_t timeInMode(PowerMode m) const { return modeMs[m]; }
+    uint16_t estimatedMa(PowerMode m) const;
+    uint16_t averageMa() const;
+    void report() const;
+
+private:
+    DisplayUI& ui;
+    M365Client& client;
+
+    PowerMode mode;
+    uint32_t stillSince;
+    uint32_t lastAccount;
+    uint32_t lastReport;
+    bool lightSleep;
+
+    uint32_t modeMs[POWER_MODE_COUNT];
+    uint32_t waitMsTotal[POWER_MODE_COUNT];
+    uint32_t pendingWaitUs;
+
+    void setMode(PowerMode next, uint32_t now);
+    void apply(const PowerProfile& p);
+    void account(uint32_t now);
+};
+
+#endif
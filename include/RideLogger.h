@@ -0,0 +1,68 @@
+#ifndef RIDE_LOGGER_H
+#define RIDE_LOGGER_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <SD.h>
+#include "ScooterData.h"
+#include "LogEncoder.h"
+
+// CYD microSD slot (VSPI)
+#define SD_SCK      18
+#define SD_MISO     19
+#define SD_MOSI     23
+#define SD_CS       5
+#define SD_SPI_HZ   20000000
+
+#define LOGGER_DIR          "/rides"
+#define LOGGER_BLOCKS       32      // sector blocks in the pool, 16 KB
+#define LOGGER_SEAL_MS      5000    // longest a sample waits in an open block
+#define LOGGER_FLUSH_MS     10000   // longest a sealed block waits for its batch
+#define LOGGER_WRITE_BYTES  4096    // batched writes end on this file boundary
+
+// Binary ride log on the SD card (format in LogEncoder.h). Samples are
+// encoded into a RAM block on the caller's task; full or stale blocks go
+// through a queue to a low priority writer task that does the SD I/O,
+// so a slow card can only ever cost dropped samples, not a late poll.
+// The writer batches consecutive blocks into one write per 4 KB of file.
+class RideLogger {
+public:
+    RideLogger();
+
+    bool begin();
+    void log(const ScooterData& data, uint32_t now);
+    void service(uint32_t now);
+    void report() const;
+
+    bool isActive() const { return active; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    SPIClass spi;
+    File file;
+    bool active;
+
+    uint8_t* pool;
+    QueueHandle_t freeQueue;
+    QueueHandle_t fullQueue;
+    TaskHandle_t task;
+
+    LogEncoder encoder;
+    uint8_t current;
+    uint32_t seq;
+
+    volatile uint32_t dropped;
+    uint32_t fileBytes;                 // writer task
+    volatile uint32_t blocksWritten;
+    volatile uint32_t writes;
+    volatile uint32_t writeErrors;
+    volatile uint32_t maxWriteUs;
+
+    bool openNextFile();
+    void sealCurrent();
+
+    static void taskEntry(void* arg);
+    void run();
+};
+
+#endif
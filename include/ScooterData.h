@@ -1,81 +1,105 @@
 #ifndef SCOOTER_DATA_H
 #define SCOOTER_DATA_H
 
-#include <Arduino.h>
+#include <stdint.h>
 
+// Room for the largest pack CellPack.h has a specialisation for
+#define CELLS_MAX           16
+
+// Telemetry is kept in the scooter's own integer wire units so decoding is
+// a plain copy and change detection is an exact integer compare. Use the
+// accessors for display units.
+//
+// Members are ordered by size (32 -> 16 -> 8 bit) and the flags are
+// bit-fields, so the struct has no internal padding.
 struct ScooterData {
-    // Core telemetry
-    float speed;
-    float averageSpeed;
-    float batteryLevel;
-    float voltage;
-    float current;
-    float power;
-    uint32_t odometer;
-    uint32_t tripDistance;
-    uint32_t rideTime;
-    float remainingRange;
-    
-    // Temperature
-    float temperature;
-    float tempESC;
-    float tempBMS1;
-    float tempBMS2;
-    
-    // Battery capacity
-    uint16_t capacityRemain;
-    uint16_t capacityFull;
-    
-    // Cell voltages (10S config)
-    float cellVoltages[10];
-    uint8_t cellCount;
-    float minCellVoltage;
-    float maxCellVoltage;
-    float cellImbalance;
-    
+    // 32-bit
+    uint32_t odometer;          // m
+    uint32_t tripDistance;      // m
+    uint32_t rideTime;          // s
+
+    // 16-bit
+    int16_t  speedRaw;          // 0.001 km/h
+    int16_t  averageSpeedRaw;   // 0.001 km/h
+    int16_t  currentRaw;        // 10 mA, negative while regenerating
+    uint16_t voltageRaw;        // 10 mV
+    int16_t  power;             // W
+    uint16_t remainingRangeRaw; // 10 m
+    int16_t  tempESCRaw;        // 0.1 C
+    uint16_t capacityRemain;    // mAh
+    uint16_t capacityFull;      // mAh
+    uint16_t cellMv[CELLS_MAX]; // mV, first cellCount in use
+    uint16_t minCellMv;
+    uint16_t maxCellMv;
+
+    // 8-bit
+    int8_t   tempBMS1;          // C
+    int8_t   tempBMS2;          // C
+    uint8_t  batteryLevel;      // %
+    uint8_t  cellCount;         // series cells of the detected pack
+    uint8_t  errorCode;
+    uint8_t  mode;
+    int8_t   rssi;
+
     // Status
-    bool isCharging;
-    bool isLocked;
-    uint8_t errorCode;
-    uint8_t mode;
-    bool headlight;
-    bool taillight;
-    
-    // Connection
-    bool connected;
-    int8_t rssi;
-    
+    bool isCharging : 1;
+    bool isLocked : 1;
+    bool headlight : 1;
+    bool taillight : 1;
+    bool connected : 1;
+    bool cruise : 1;
+
     ScooterData() {
-        speed = 0;
-        averageSpeed = 0;
-        batteryLevel = 0;
-        voltage = 0;
-        current = 0;
-        power = 0;
         odometer = 0;
         tripDistance = 0;
         rideTime = 0;
-        remainingRange = 0;
-        temperature = 0;
-        tempESC = 0;
-        tempBMS1 = 0;
-        tempBMS2 = 0;
+        speedRaw = 0;
+        averageSpeedRaw = 0;
+        currentRaw = 0;
+        voltageRaw = 0;
+        power = 0;
+        remainingRangeRaw = 0;
+        tempESCRaw = 0;
         capacityRemain = 0;
         capacityFull = 12800;
+        for (int i = 0; i < CELLS_MAX; i++) cellMv[i] = 0;
+        minCellMv = 0;
+        maxCellMv = 0;
+        tempBMS1 = 0;
+        tempBMS2 = 0;
+        batteryLevel = 0;
         cellCount = 10;
-        for (int i = 0; i < 10; i++) cellVoltages[i] = 0;
-        minCellVoltage = 0;
-        maxCellVoltage = 0;
-        cellImbalance = 0;
-        isCharging = false;
-        isLocked = false;
         errorCode = 0;
         mode = 255;
+        rssi = 0;
+        isCharging = false;
+        isLocked = false;
         headlight = false;
         taillight = false;
         connected = false;
-        rssi = 0;
+        cruise = false;
     }
+
+    // Display units
+    float speedKmh() const          { return speedRaw / 1000.0f; }
+    float averageSpeedKmh() const   { return averageSpeedRaw / 1000.0f; }
+    float currentA() const          { return currentRaw / 100.0f; }
+    float voltageV() const          { return voltageRaw / 100.0f; }
+    float remainingRangeKm() const  { return remainingRangeRaw / 100.0f; }
+    float tempESC() const           { return tempESCRaw / 10.0f; }
+    float cellVoltage(int i) const  { return cellMv[i] / 1000.0f; }
+
+    // Integer helpers for the render path
+    int16_t speedKmhInt() const     { return speedRaw / 1000; }
+    int16_t tempBMSAvgX10() const   { return (tempBMS1 + tempBMS2) * 5; }
+    // Trip average in 0.1 km/h: m / s * 3.6 * 10
+    int32_t tripAvgSpeedX10() const {
+        if (tripDistance == 0 || rideTime == 0) return 0;
+        return (int32_t)((tripDistance * 36ULL + rideTime / 2) / rideTime);
+    }
+    uint16_t cellImbalanceMv() const { return maxCellMv > minCellMv ? maxCellMv - minCellMv : 0; }
 };
 
+static_assert(sizeof(ScooterData) == 76, "ScooterData layout has padding");
+
 #endif
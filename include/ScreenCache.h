@@ -0,0 +1,42 @@
+#ifndef SCREEN_CACHE_H
+#define SCREEN_CACHE_H
+
+#include <TFT_eSPI.h>
+
+#define SCREEN_CACHE_SLOTS      9
+#define SCREEN_CACHE_STRIP_H    40
+
+// Paints static screen chrome into 'gfx', shifted vertically by yOff
+typedef void (*ChromePainter)(void* ctx, uint8_t slot, TFT_eSPI& gfx, int16_t yOff);
+
+struct RleRun {
+    uint16_t color;
+    uint16_t count;
+};
+
+// Pre-rendered full-screen backgrounds kept as RGB565 run-length data.
+// A build renders the chrome strip by strip into a small sprite and
+// encodes it; a blit streams the runs to the panel in one address window,
+// so a screen switch costs a single pass with no text rasterisation.
+class ScreenCache {
+public:
+    ScreenCache(TFT_eSPI& display);
+
+    void setPainter(ChromePainter painter, void* ctx);
+    bool build(uint8_t slot);
+    bool blit(uint8_t slot);
+    void invalidate(uint8_t slot);
+
+    bool isBuilt(uint8_t slot) const { return slot < SCREEN_CACHE_SLOTS && runs[slot] != nullptr; }
+    size_t bytesUsed() const;
+
+private:
+    TFT_eSPI& tft;
+    ChromePainter painter;
+    void* painterCtx;
+
+    RleRun* runs[SCREEN_CACHE_SLOTS];
+    uint16_t runCount[SCREEN_CACHE_SLOTS];
+};
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef SCREEN_LAYOUT_H
+#define SCREEN_LAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ScooterData.h"
+#include "TelemetryFields.h"
+#include "AlertEngine.h"
+
+// Compiled screen layout (layout.bin on LittleFS, built from a text
+// description by tools/layout_compile.py), all little endian:
+//
+//   "M365LYT\0", u16 version, u8 screens, u8 widgets, u8 rules,
+//   u8 reserved, u16 string bytes
+//   per screen  u8 screen id, u8 first widget, u8 widget count, u8 0
+//   per widget  u8 type, u8 field, u8 font, u8 datum,
+//               i16 x, i16 y, u16 w, u16 h, u16 colour,
+//               u8 decimals, u8 flags, u8 first rule, u8 rule count,
+//               u16 text offset, u16 deadband, u16 span
+//   per rule    u8 op, u8 arg, u16 colour, i32 value
+//   strings     NUL terminated, addressed by offset
+//   u32 CRC32 of everything before it
+//
+// (x, y) is the text anchor for the datum; w/h the box cleared before a
+// redraw (h 0 = font height). Lines, frames, bars and graphs use x, y,
+// w, h as their rectangle.
+#define LAYOUT_VERSION          1
+#define LAYOUT_HEADER_BYTES     16
+#define LAYOUT_SCREEN_BYTES     4
+#define LAYOUT_WIDGET_BYTES     24
+#define LAYOUT_RULE_BYTES       8
+#define LAYOUT_NO_TEXT          0xFFFF
+
+#define LAYOUT_MAX_SCREENS      8
+#define LAYOUT_MAX_WIDGETS      96
+#define LAYOUT_MAX_RULES        32
+#define LAYOUT_MAX_STRINGS      1024
+#define LAYOUT_MAX_BYTES        (LAYOUT_HEADER_BYTES + LAYOUT_MAX_SCREENS * LAYOUT_SCREEN_BYTES + \
+                                 LAYOUT_MAX_WIDGETS * LAYOUT_WIDGET_BYTES + \
+                                 LAYOUT_MAX_RULES * LAYOUT_RULE_BYTES + LAYOUT_MAX_STRINGS + 4)
+// Longest formatted value, suffix included
+#define LAYOUT_TEXT_MAX         24
+
+enum LayoutWidgetType : uint8_t {
+    LW_LABEL = 0,       // static text
+    LW_HLINE,
+    LW_VLINE,
+    LW_FRAME,
+    LW_VALUE,           // bound field as text
+    LW_BAR,             // bound field as a fill from 0 to 'span'
+    LW_GRAPH,           // history graph, field is the HistoryChannel
+    LW_STATUS,          // the built-in status bar, at its usual place
+    LW_CELLS,           // the built-in cell grid and detail line
+    LW_TYPES
+};
+
+// Static widgets go into the chrome cache and cost nothing per frame
+inline bool layoutIsChrome(uint8_t type) { return type <= LW_FRAME; }
+
+// Fields past the TelemetryFieldId range, derived for the screens
+enum LayoutField : uint8_t {
+    LF_SPEED_SHOWN = 0x80,  // filtered readout, whole km/h
+    LF_TEMP_BMS_AVG,        // 0.1 C
+    LF_AVG_SPEED,           // 0.1 km/h from trip meter and ride time
+    LF_TRIP_MAX_SPEED,      // km/h, trip statistics
+    LF_IMBALANCE,           // mV
+    LF_FIRST = LF_SPEED_SHOWN,
+    LF_LAST = LF_IMBALANCE
+};
+
+// Text anchors, numbered like TFT_eSPI's datums
+enum LayoutDatum : uint8_t {
+    LD_TL = 0, LD_TC, LD_TR,
+    LD_ML, LD_MC, LD_MR,
+    LD_BL, LD_BC, LD_BR
+};
+
+#define LWF_ABS     0x01    // show the magnitude
+#define LWF_TIME    0x02    // seconds as a ride timer
+
+// Colour rules, first match wins; otherwise the widget's own colour
+enum LayoutRuleOp : uint8_t {
+    LR_LT = 0,          // value < rule value
+    LR_GT,              // value > rule value
+    LR_ALERT,           // alert input 'arg' at severity >= rule value
+    LR_OPS
+};
+
+struct LayoutRule {
+    uint8_t op;
+    uint8_t arg;
+    uint16_t color;
+    int32_t value;
+};
+
+// One widget with everything the interpreter needs resolved at load
+struct LayoutItem {
+    uint8_t type;
+    uint8_t field;
+    uint8_t font;
+    uint8_t datum;
+    uint8_t decimals;
+    uint8_t flags;
+    uint8_t firstRule;
+    uint8_t ruleCount;
+    int16_t x, y;               // anchor, or rectangle origin
+    int16_t w, h;
+    int16_t boxX, boxY;         // cleared before a value redraw
+    int16_t boxW, boxH;
+    uint16_t color;
+    uint16_t deadband;          // raw units a value may move unredrawn
+    uint16_t span;
+    int32_t divisor;            // raw to shown units
+    const char* text;           // label, or suffix after a value
+};
+
+// Each screen's items are stored chrome first, so a frame only walks
+// the dynamic range
+struct LayoutScreen {
+    uint8_t screen;
+    uint8_t first;
+    uint8_t chromeCount;
+    uint8_t dynamicCount;
+};
+
+// What a frame's values come from besides ScooterData
+struct LayoutContext {
+    const ScooterData* data;
+    const AlertEngine* alerts;  // may be null
+    int32_t speedShown;
+    int32_t tripMaxSpeed;
+};
+
+// Loaded layout plus the per-widget state of the dirty check. Fixed
+// size, no heap; strings are copied out of the blob. Pure logic: the
+// drawing is DisplayUI's.
+class ScreenLayout {
+public:
+    ScreenLayout();
+
+    // False (and nothing loaded) on any format or range error
+    bool load(const uint8_t* blob, size_t len);
+    bool loaded() const { return screenCount > 0; }
+    const char* getError() const { return error; }
+
+    const LayoutScreen* find(uint8_t screen) const;
+    const LayoutItem& item(uint8_t index) const { return items[index]; }
+    uint8_t widgets() const { return itemCount; }
+
+    // True if the value or its colour moved past the deadband since the
+    // last draw (or 'force'); fills the text and colour to draw
+    bool refresh(uint8_t index, const LayoutContext& ctx, bool force, char* text, uint16_t& color);
+    // Bar fill in pixels for the last refreshed value
+    int16_t barFill(uint8_t index) const;
+
+    static int32_t value(const LayoutContext& ctx, uint8_t field);
+    static uint8_t fontHeight(uint8_t font);
+
+private:
+    LayoutScreen screens[LAYOUT_MAX_SCREENS];
+    LayoutItem items[LAYOUT_MAX_WIDGETS];
+    LayoutRule rules[LAYOUT_MAX_RULES];
+    char strings[LAYOUT_MAX_STRINGS];
+    uint8_t screenCount;
+    uint8_t itemCount;
+    const char* error;
+
+    int32_t lastValue[LAYOUT_MAX_WIDGETS];
+    uint16_t lastColor[LAYOUT_MAX_WIDGETS];
+
+    bool fail(const char* why);
+    bool decode(const uint8_t* p, LayoutItem& it, uint8_t nRules, uint16_t nStrings);
+    uint16_t colorOf(const LayoutItem& it, const LayoutContext& ctx, int32_t v) const;
+    void resolve(LayoutItem& it);
+};
+
+#endif
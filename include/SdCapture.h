@@ -0,0 +1,37 @@
+#ifndef SD_CAPTURE_H
+#define SD_CAPTURE_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <freertos/stream_buffer.h>
+#include "CaptureFormat.h"
+
+#define CAPTURE_DIR             "/captures"
+#define CAPTURE_TRIGGER_PATH    "/CAPTURE"      // create this file to record
+#define CAPTURE_STREAM_SIZE     8192
+#define CAPTURE_CHUNK           4096
+#define CAPTURE_FLUSH_MS        2000
+
+// Records raw notifications to /captures/C####.CAP on an already mounted
+// SD card. capture() only copies into a stream buffer; a low priority
+// task writes it out in 4 KB chunks.
+class SdCapture : public CaptureSink {
+public:
+    SdCapture();
+
+    bool begin();
+    void capture(uint32_t timeMs, const uint8_t* data, uint16_t len) override;
+
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    File file;
+    StreamBufferHandle_t stream;
+    TaskHandle_t task;
+    volatile uint32_t dropped;
+
+    static void taskEntry(void* arg);
+    void run();
+};
+
+#endif
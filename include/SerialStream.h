@@ -0,0 +1,76 @@
+#ifndef SERIAL_STREAM_H
+#define SERIAL_STREAM_H
+
+#include <Arduino.h>
+#include "ScooterData.h"
+#include "TelemetryFields.h"
+#include "CaptureFormat.h"
+
+// Host sends one of these bytes to switch the stream
+#define STREAM_CMD_START    0x02
+#define STREAM_CMD_STOP     0x03
+#define STREAM_CMD_CAPTURE_ON   0x04
+#define STREAM_CMD_CAPTURE_OFF  0x05
+
+#define STREAM_TX_BUFFER    1024
+#define STREAM_KEYFRAME_MS  2000
+
+// Frame types (first byte of a decoded frame)
+#define STREAM_FRAME_SCHEMA     0x01
+#define STREAM_FRAME_KEY        0x02
+#define STREAM_FRAME_DELTA      0x03
+#define STREAM_FRAME_CAPTURE    0x04
+
+#define STREAM_MAX_FRAME    (2 + 5 + TF_MASK_VARINT_BYTES + TF_COUNT * 5 + 2)
+#define STREAM_MAX_SCHEMA   512
+
+// Binary telemetry on the USB serial port for PC tools.
+//
+// Every frame is COBS encoded and wrapped in 0x00 bytes, so it can share the
+// port with the usual "[TAG] ..." text logs: a reader splits on zero
+// bytes and anything that fails the CRC is just a text line.
+//
+//   type u8, seq u8, varint time ms, varint field mask,
+//   zigzag varint per set field, CRC-16/CCITT (LE)
+//
+// Delta frames carry only the fields that changed since the last frame
+// actually sent; a key frame repeats everything relative to zero every
+// 2 s so a reader can join at any time. When the TX buffer cannot take a
+// whole frame it is skipped and its changes roll into the next one, so
+// the caller never blocks on the UART.
+//
+// Capture frames (type 4, seq, varint time ms, raw notification, CRC)
+// mirror the BLE notifications themselves for replay on the PC. They are
+// switched separately and dropped, not coalesced, when the port is busy.
+class SerialStream : public CaptureSink {
+public:
+    SerialStream();
+
+    void poll();
+    void publish(const ScooterData& data, uint32_t now);
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool on);
+    uint32_t getCoalesced() const { return coalesced; }
+
+    void capture(uint32_t timeMs, const uint8_t* data, uint16_t len) override;
+    bool isCapturing() const { return capturing; }
+    uint32_t getCaptureDropped() const { return captureDropped; }
+
+private:
+    bool enabled;
+    bool schemaPending;
+    bool keyPending;
+    uint8_t seq;
+    uint32_t lastKeyframe;
+    int32_t sent[TF_COUNT];
+    uint32_t coalesced;
+    bool capturing;
+    uint8_t captureSeq;
+    uint32_t captureDropped;
+
+    bool sendFrame(const uint8_t* frame, uint16_t len);
+    bool sendSchema();
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SPEED_FILTER_H
+#define SPEED_FILTER_H
+
+#include <stdint.h>
+
+// Alpha-beta gains in Q8, tuned with tools/sim (--speed-noise)
+#define SPEED_ALPHA_Q8          192     // 0.75
+#define SPEED_BETA_Q8           64      // 0.25
+// Longer gaps restart the filter from the next sample
+#define SPEED_MAX_GAP_MS        2000
+// Extrapolate at most this far past the last sample; further out the
+// acceleration estimate overshoots more than it helps
+#define SPEED_HORIZON_MS        200
+// The readout moves once the estimate is this far past the half-way
+// point to the next integer (0.001 km/h)
+#define SPEED_HYSTERESIS_RAW    250
+
+// Fixed-point alpha-beta tracker for the speed readout. Speed arrives
+// every ~400 ms; the filter keeps speed and acceleration from the
+// timestamped samples and extrapolates between them, so the display can
+// move every frame instead of in steps. Integer only, like the rest of
+// the render path.
+class SpeedFilter {
+public:
+    SpeedFilter();
+
+    void reset();
+    void add(int32_t speedRaw, uint32_t at);
+    // 0.001 km/h at time 'now', never negative
+    int32_t estimate(uint32_t now) const;
+    // 0.001 km/h per second
+    int32_t accel() const { return v; }
+
+    // Integer km/h to show, given what is shown now
+    static int16_t hold(int16_t shown, int32_t estimateRaw);
+
+private:
+    int32_t x;              // 0.001 km/h at 'last'
+    int32_t v;              // 0.001 km/h per s
+    uint32_t last;
+    bool primed;
+};
+
+#endif
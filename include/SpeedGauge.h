@@ -0,0 +1,47 @@
+#ifndef SPEED_GAUGE_H
+#define SPEED_GAUGE_H
+
+#include <TFT_eSPI.h>
+
+// Dial geometry (screen is 320x240 in landscape)
+#define GAUGE_CX            160
+#define GAUGE_CY            130
+#define GAUGE_R_OUT         104
+#define GAUGE_R_IN          88
+#define GAUGE_NEEDLE_LEN    80
+#define GAUGE_HUB_R         7
+
+// Sweep in tenths of a degree, clockwise from 12 o'clock
+#define GAUGE_ANGLE_MIN     -1200
+#define GAUGE_ANGLE_MAX     1200
+#define GAUGE_ANGLE_STEP    5       // needle/arc quantum (0.5 deg)
+#define GAUGE_MAX_SPEED_RAW 40000   // 40 km/h in 0.001 km/h
+
+// Arc gauge that redraws incrementally: on each update only the ring
+// sector between the previous and the new angle is touched, plus the
+// needle itself. Trig comes from the compile-time table in TrigLUT.h.
+// All dial pixels outside the ring, needle and readout are static.
+class SpeedGauge {
+public:
+    SpeedGauge(TFT_eSPI& display);
+
+    // Ticks, labels and the empty track; static, so it can be cached
+    void drawDial(TFT_eSPI& gfx, int16_t yOff);
+    // Restarts incremental drawing on top of a freshly drawn dial
+    void reset();
+    void update(int16_t speedRaw);
+
+private:
+    TFT_eSPI& tft;
+
+    int16_t lastAngle;
+    int16_t lastReadout;
+
+    int16_t speedToAngle(int32_t speedRaw) const;
+    void fillRingSector(TFT_eSPI& gfx, int16_t cy, int16_t a0, int16_t a1, uint16_t color);
+    void fillSectorChunk(TFT_eSPI& gfx, int16_t cy, int16_t a0, int16_t a1, uint16_t color);
+    void drawNeedle(int16_t angle, uint16_t color);
+    void drawReadout(int16_t speedRaw);
+};
+
+#endif
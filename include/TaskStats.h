@@ -0,0 +1,34 @@
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+#include <Arduino.h>
+
+// Self-timed load figures for one task. The task brackets its work with
+// beginWork()/endWork() and calls tick() once per periodic cycle; any
+// task may call report(), which prints and restarts the window.
+class TaskStats {
+public:
+    TaskStats(const char* name);
+
+    void attach(TaskHandle_t handle, uint8_t core);
+    void beginWork();
+    void endWork();
+    void tick();
+    void report();
+
+private:
+    const char* name;
+    TaskHandle_t handle;
+    uint8_t core;
+    portMUX_TYPE lock;
+
+    uint32_t workStart;
+    uint32_t lastTick;
+    uint32_t windowStart;
+    uint32_t busyUs;
+    uint32_t maxWorkUs;
+    uint32_t maxGapUs;
+    uint32_t cycles;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef TELEMETRY_FIELDS_H
+#define TELEMETRY_FIELDS_H
+
+#include <stdint.h>
+#include "ScooterData.h"
+
+// Flat, numbered view of ScooterData for anything that serialises it.
+// Field ids are part of the on-disk/wire schema: append only, never
+// renumber.
+enum TelemetryFieldId : uint8_t {
+    TF_SPEED = 0,
+    TF_AVG_SPEED,
+    TF_CURRENT,
+    TF_VOLTAGE,
+    TF_POWER,
+    TF_RANGE,
+    TF_TEMP_ESC,
+    TF_TEMP_BMS1,
+    TF_TEMP_BMS2,
+    TF_BATTERY,
+    TF_CAP_REMAIN,
+    TF_CAP_FULL,
+    TF_ODOMETER,
+    TF_TRIP,
+    TF_RIDE_TIME,
+    TF_ERROR,
+    TF_MODE,
+    TF_FLAGS,
+    TF_RSSI,
+    TF_CELL0,
+    TF_CELL9 = TF_CELL0 + 9,
+    TF_CELL10,                  // extended packs, zero on a stock 10S
+    TF_CELL15 = TF_CELL10 + 5,
+    TF_COUNT
+};
+
+static_assert(TF_CELL15 - TF_CELL0 + 1 == CELLS_MAX, "One field per ScooterData::cellMv slot");
+// Changed-field masks are 64 bit
+static_assert(TF_COUNT <= 64, "Too many telemetry fields for the field mask");
+// Bytes of a field mask varint
+#define TF_MASK_VARINT_BYTES    ((TF_COUNT + 6) / 7)
+
+// Bits of TF_FLAGS
+#define TF_FLAG_CHARGING    0x01
+#define TF_FLAG_LOCKED      0x02
+#define TF_FLAG_HEADLIGHT   0x04
+#define TF_FLAG_TAILLIGHT   0x08
+#define TF_FLAG_CONNECTED   0x10
+#define TF_FLAG_CRUISE      0x20
+
+struct TelemetryField {
+    const char* name;
+    const char* unit;
+    uint16_t scale;     // raw / scale = value in unit
+};
+
+extern const TelemetryField TELEMETRY_FIELDS[TF_COUNT];
+
+int32_t telemetryValue(const ScooterData& data, uint8_t id);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef TOUCH_INPUT_H
+#define TOUCH_INPUT_H
+
+#include <Arduino.h>
+
+#define TOUCH_CLK   25
+#define TOUCH_MISO  39
+#define TOUCH_MOSI  32
+#define TOUCH_CS    33
+#define TOUCH_IRQ   36
+
+// XPT2046 is bit-banged: VSPI belongs to the SD card and the controller
+// only needs a few hundred clocks per sample
+
+// Raw XPT2046 range seen on the CYD 2.8" panel (rotation 1)
+#define TOUCH_RAW_X_MIN     200
+#define TOUCH_RAW_X_MAX     3700
+#define TOUCH_RAW_Y_MIN     240
+#define TOUCH_RAW_Y_MAX     3800
+#define TOUCH_MIN_PRESSURE  50
+
+// Gesture timing/distance thresholds
+#define TOUCH_SAMPLE_MS     10
+#define TOUCH_TAP_MAX_MS    400
+#define TOUCH_LONG_MS       700
+#define TOUCH_MOVE_SLOP     15
+#define TOUCH_SWIPE_MIN     50
+
+#define TOUCH_QUEUE_LEN     8
+
+enum TouchGesture : uint8_t {
+    GESTURE_TAP,
+    GESTURE_LONG_PRESS,
+    GESTURE_SWIPE_LEFT,
+    GESTURE_SWIPE_RIGHT,
+    GESTURE_SWIPE_UP,
+    GESTURE_SWIPE_DOWN
+};
+
+struct TouchEvent {
+    TouchGesture gesture;
+    int16_t x;          // screen coordinates of the press
+    int16_t y;
+    int16_t dx;         // movement until release
+    int16_t dy;
+    uint32_t time;      // millis() at recognition
+};
+
+// Touch handled off the main loop: PENIRQ wakes a task that samples the
+// controller while the finger is down, classifies the gesture and posts
+// a TouchEvent to a queue. The loop only drains the queue.
+class TouchInput {
+public:
+    TouchInput();
+
+    void begin();
+    bool poll(TouchEvent& evt, uint32_t waitMs = 0);
+
+private:
+    QueueHandle_t queue;
+    TaskHandle_t task;
+
+    static TouchInput* instance;
+    static void IRAM_ATTR onIrq();
+    static void taskEntry(void* arg);
+
+    void run();
+    uint16_t readChannel(uint8_t cmd);
+    bool readPoint(int16_t& x, int16_t& y);
+    void post(TouchGesture gesture, int16_t x, int16_t y, int16_t dx, int16_t dy);
+};
+
+#endif
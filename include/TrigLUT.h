@@ -0,0 +1,45 @@
+#ifndef TRIG_LUT_H
+#define TRIG_LUT_H
+
+#include <stdint.h>
+
+// Generated by tools/gen_trig_lut.py - do not edit by hand.
+// sin(0..90 deg) in Q15, 1 degree per entry.
+static const int16_t SIN_LUT_Q15[91] = {
+        0,   572,  1144,  1715,  2286,  2856,  3425,  3993,  4560,  5126,
+     5690,  6252,  6813,  7371,  7927,  8481,  9032,  9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14364, 14876, 15383, 15886,
+    16383, 16876, 17364, 17846, 18323, 18794, 19260, 19720, 20173, 20621,
+    21062, 21497, 21925, 22347, 22762, 23170, 23571, 23964, 24351, 24730,
+    25101, 25465, 25821, 26169, 26509, 26841, 27165, 27481, 27788, 28087,
+    28377, 28659, 28932, 29196, 29451, 29697, 29934, 30162, 30381, 30591,
+    30791, 30982, 31163, 31335, 31498, 31650, 31794, 31927, 32051, 32165,
+    32269, 32364, 32448, 32523, 32587, 32642, 32687, 32722, 32747, 32762,
+    32767,
+};
+
+// Angles are in tenths of a degree. Values between table entries are
+// linearly interpolated, which keeps the error below 1/3000 of full scale.
+inline int32_t lutSin(int32_t deciDeg) {
+    deciDeg %= 3600;
+    if (deciDeg < 0) deciDeg += 3600;
+
+    int32_t sign = 1;
+    if (deciDeg >= 1800) {
+        deciDeg -= 1800;
+        sign = -1;
+    }
+    if (deciDeg > 900) deciDeg = 1800 - deciDeg;
+
+    int32_t idx = deciDeg / 10;
+    int32_t frac = deciDeg - idx * 10;
+    int32_t v = SIN_LUT_Q15[idx];
+    if (frac) v += (SIN_LUT_Q15[idx + 1] - v) * frac / 10;
+    return sign * v;
+}
+
+inline int32_t lutCos(int32_t deciDeg) {
+    return lutSin(deciDeg + 900);
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef TRIP_RECORDER_H
+#define TRIP_RECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "TripStats.h"
+
+#define TRIP_STATE_PATH     "/trip.bin"
+// Saved this often while the stats change, and on every reset
+#define TRIP_SAVE_MS        60000
+
+// Owns the current trip's TripStats on the protocol side: feeds it,
+// starts a new trip when the scooter's trip meter goes back to zero or
+// on request, publishes a TripSummary for the screens and keeps the
+// state on LittleFS so a reboot mid-trip doesn't lose it. Saves are
+// handed to a low priority task like the journal's.
+class TripRecorder {
+public:
+    TripRecorder();
+
+    // LittleFS must already be mounted (FlashJournal::begin); without
+    // it the trip is kept in RAM only
+    void begin();
+    void update(const ScooterData& data, uint32_t now);
+
+    // Any task; applied on the next update()
+    void requestReset() { resetRequested = true; }
+
+    void getSummary(TripSummary& out) const;
+    // Incremented whenever a new summary is published
+    uint32_t getVersion() const { return version; }
+
+private:
+    TripStats stats;
+    TripSummary summary;
+    mutable portMUX_TYPE lock;
+    volatile uint32_t version;
+    volatile bool resetRequested;
+
+    bool mounted;
+    bool dirty;
+    uint32_t lastSave;
+
+    // Hand-off to the writer task
+    TaskHandle_t task;
+    TripStats saveBuf;
+    volatile bool savePending;
+
+    void newTrip(const char* why);
+    void publish();
+    void queueSave(uint32_t now);
+
+    static void taskEntry(void* arg);
+    void run();
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef TRIP_STATS_H
+#define TRIP_STATS_H
+
+#include <stdint.h>
+#include "ScooterData.h"
+
+enum TripChannel : uint8_t {
+    TRIP_SPEED = 0,     // km/h, while moving
+    TRIP_CURRENT,       // A, while moving
+    TRIP_POWER,         // W, while moving
+    TRIP_TEMP_ESC,      // C
+    TRIP_TEMP_BMS,      // C, average of both sensors
+    TRIP_CHANNELS
+};
+
+// Samples are taken at a fixed rate, not per decoded frame, so channels
+// polled more often don't weigh more
+#define TRIP_SAMPLE_MS          200
+// Longer gaps (link drop) only count this much towards zone time
+#define TRIP_MAX_GAP_MS         1000
+#define TRIP_MOVING_SPEED_RAW   500
+
+// Time-in-zone bands; the last one is open ended
+#define TRIP_ZONES              6
+#define TRIP_SPEED_ZONE_KMH     5       // 0-5, 5-10 ... 25+
+#define TRIP_POWER_ZONE_W       100     // regen, 0-100 ... 400+
+
+#define TRIP_STATS_MAGIC        0x50495254UL    // "TRIP"
+#define TRIP_STATS_VERSION      1
+
+// Welford running mean/variance plus extremes
+struct RunningStats {
+    uint32_t count;
+    float mean;
+    float m2;
+    float min;
+    float max;
+
+    void reset();
+    void add(float x);
+    float variance() const { return count > 1 ? m2 / (count - 1) : 0.0f; }
+};
+
+// P-square single-quantile estimator (Jain & Chlamtac): five markers,
+// O(1) update, no sample buffer
+struct P2Quantile {
+    float p;
+    float q[5];         // marker heights
+    float np[5];        // desired marker positions
+    int32_t n[5];       // actual marker positions
+    uint32_t count;
+
+    void reset(float quantile);
+    void add(float x);
+    float value() const;
+};
+
+struct TripChannelStats {
+    RunningStats run;
+    P2Quantile p50;
+    P2Quantile p95;
+    P2Quantile p99;
+};
+
+// What the screens need, copied out under the recorder's lock
+struct TripChannelSummary {
+    float mean;
+    float stddev;
+    float max;
+    float p50;
+    float p95;
+    float p99;
+};
+
+struct TripSummary {
+    TripChannelSummary ch[TRIP_CHANNELS];
+    uint32_t speedZoneMs[TRIP_ZONES];
+    uint32_t powerZoneMs[TRIP_ZONES];
+    uint32_t movingMs;
+    uint32_t samples;
+};
+
+// Fixed-size streaming statistics for one trip (~1.2 KB). Plain data with
+// no pointers, so the whole object is persisted as one blob.
+class TripStats {
+public:
+    TripStats();
+
+    void reset();
+    // Returns true if the sample was taken
+    bool add(const ScooterData& data, uint32_t now);
+    void summarize(TripSummary& out) const;
+    // After a restore: the next sample starts a new time base
+    void resume() { started = false; }
+
+    bool valid() const { return magic == TRIP_STATS_MAGIC && version == TRIP_STATS_VERSION; }
+    uint32_t lastTripM() const { return tripM; }
+
+private:
+    uint32_t magic;
+    uint16_t version;
+    bool started;
+    TripChannelStats channels[TRIP_CHANNELS];
+    uint32_t speedZoneMs[TRIP_ZONES];
+    uint32_t powerZoneMs[TRIP_ZONES];
+    uint32_t movingMs;
+    uint32_t lastSample;
+    uint32_t tripM;         // scooter trip meter at the last sample
+
+    void addChannel(TripChannel ch, float x);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef UART_TRANSPORT_H
+#define UART_TRANSPORT_H
+
+#include <Arduino.h>
+#include "M365Transport.h"
+
+// Scooter bus on the CN1 header. The bus is one wire: RX sits on it
+// directly and TX drives it through a diode, so every byte we send is
+// read back.
+#define UART_BUS_RX             22
+#define UART_BUS_TX             27
+#define UART_BUS_BAUD           115200
+#define UART_BUS_RX_BUFFER      1024
+
+// Quiet time before we drive the bus; about 11 byte times at 115200
+#define UART_BUS_IDLE_US        1000
+#define UART_REPLY_TIMEOUT_MS   15
+// No reply for this long means nothing is answering
+#define UART_SILENT_MS          1000
+
+// Request/reply takes ~3 ms here against 30+ ms over BLE
+#define UART_POLL_DIVISOR       10
+
+#define UART_MAX_ECHO           32
+
+// Direct wired link to the ESC/BMS bus (half duplex, 115200 8N1).
+// One request is outstanding at a time: canSend() stays false until the
+// reply has ended with a quiet gap or the timeout passed. Our own echo
+// is stripped byte by byte; a mismatch means someone else was talking
+// and counts as a collision.
+class UartTransport : public M365Transport {
+public:
+    UartTransport(HardwareSerial& port);
+
+    void begin() override;
+    LinkState update(uint32_t now) override;
+    bool canSend() override;
+    bool send(const uint8_t* data, size_t len) override;
+    size_t receive(uint8_t* buf, size_t maxLen, uint32_t& timeMs) override;
+
+    const char* name() const override { return "UART"; }
+    uint8_t pollDivisor() const override { return UART_POLL_DIVISOR; }
+    void report() const override;
+
+    uint32_t getTimeouts() const { return timeouts; }
+    uint32_t getCollisions() const { return collisions; }
+
+private:
+    HardwareSerial& port;
+
+    uint8_t echo[UART_MAX_ECHO];
+    uint8_t echoLen;
+    uint8_t echoPos;
+
+    bool awaiting;
+    bool gotReply;
+    uint32_t sentAt;
+    uint32_t lastByteUs;
+    uint32_t lastRxMs;
+    bool everReceived;
+
+    uint32_t requests;
+    uint32_t timeouts;
+    uint32_t collisions;
+
+    bool busIdle();
+};
+
+#endif
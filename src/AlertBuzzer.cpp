@@ -0,0 +1,32 @@
+#include "AlertBuzzer.h"
+
+AlertBuzzer::AlertBuzzer() : remaining(0), sounding(false), nextMs(0) {
+}
+
+void AlertBuzzer::begin() {
+    ledcSetup(BUZZER_LEDC_CH, BUZZER_FREQ_HZ, 8);
+    ledcAttachPin(BUZZER_PIN, BUZZER_LEDC_CH);
+    ledcWrite(BUZZER_LEDC_CH, 0);
+}
+
+void AlertBuzzer::beep(uint8_t count, uint32_t now) {
+    // A new alert restarts the sequence rather than queueing behind it
+    remaining = count;
+    sounding = false;
+    nextMs = now;
+    update(now);
+}
+
+void AlertBuzzer::update(uint32_t now) {
+    if (remaining == 0 || (int32_t)(now - nextMs) < 0) return;
+    if (!sounding) {
+        ledcWriteTone(BUZZER_LEDC_CH, BUZZER_FREQ_HZ);
+        sounding = true;
+        nextMs = now + BUZZER_BEEP_MS;
+    } else {
+        ledcWrite(BUZZER_LEDC_CH, 0);
+        sounding = false;
+        remaining--;
+        nextMs = now + BUZZER_GAP_MS;
+    }
+}
@@ -0,0 +1,140 @@
+#include "AlertEngine.h"
+
+// Keep rules of one input together; the engine indexes them by input
+const AlertRule ALERT_RULES[] = {
+    // input          cmp          thr  hyst  hold  severity    text
+    { AIN_TEMP_ESC,  ALERT_ABOVE, 450, 30,  2000, ALERT_WARN, "ESC HOT" },
+    { AIN_TEMP_ESC,  ALERT_ABOVE, 600, 30,  1000, ALERT_CRIT, "ESC OVERHEAT" },
+    { AIN_TEMP_BMS,  ALERT_ABOVE, 400, 20,  2000, ALERT_WARN, "BATTERY WARM" },
+    { AIN_TEMP_BMS,  ALERT_ABOVE, 500, 20,  1000, ALERT_CRIT, "BATTERY HOT" },
+    { AIN_IMBALANCE, ALERT_ABOVE, 50,  10,  5000, ALERT_WARN, "CELL IMBALANCE" },
+    { AIN_SAG,       ALERT_ABOVE, 500, 100, 1500, ALERT_WARN, "VOLTAGE SAG" },
+};
+
+const uint8_t ALERT_RULE_COUNT = sizeof(ALERT_RULES) / sizeof(ALERT_RULES[0]);
+
+static_assert(sizeof(ALERT_RULES) / sizeof(ALERT_RULES[0]) <= ALERT_MAX_RULES,
+              "Too many alert rules for the active mask");
+
+AlertEngine::AlertEngine() : version(0), hook(nullptr), hookCtx(nullptr) {
+    // Counting sort of the table by input
+    uint8_t n = 0;
+    for (uint8_t in = 0; in < AIN_COUNT; in++) {
+        first[in] = n;
+        for (uint8_t r = 0; r < ALERT_RULE_COUNT; r++) {
+            if (ALERT_RULES[r].input == in) order[n++] = r;
+        }
+    }
+    first[AIN_COUNT] = n;
+    reset();
+}
+
+void AlertEngine::reset() {
+    for (uint8_t i = 0; i < AIN_COUNT; i++) {
+        values[i] = 0;
+        inputLevel[i] = ALERT_NONE;
+    }
+    valid = false;
+    restVoltageRaw = 0;
+    activeMask = 0;
+    pendingMask = 0;
+    seq = 0;
+    topRule = -1;
+    version++;
+}
+
+uint8_t AlertEngine::activeCount() const {
+    return (uint8_t)__builtin_popcount(activeMask);
+}
+
+void AlertEngine::derive(const ScooterData& d, int32_t* out) {
+    out[AIN_TEMP_ESC] = d.tempESCRaw;
+    out[AIN_TEMP_BMS] = d.tempBMSAvgX10();
+    out[AIN_IMBALANCE] = d.cellImbalanceMv();
+
+    // Sag is measured against the voltage seen at the last near-zero load
+    int32_t current = d.currentRaw;
+    if (current > -ALERT_REST_CURRENT_RAW && current < ALERT_REST_CURRENT_RAW) {
+        restVoltageRaw = d.voltageRaw;
+    }
+    out[AIN_SAG] = (current >= ALERT_REST_CURRENT_RAW && restVoltageRaw > d.voltageRaw)
+                   ? restVoltageRaw - d.voltageRaw : 0;
+}
+
+void AlertEngine::update(const ScooterData& data, uint32_t now) {
+    int32_t next[AIN_COUNT];
+    derive(data, next);
+
+    for (uint8_t in = 0; in < AIN_COUNT; in++) {
+        if (valid && next[in] == values[in]) continue;
+        values[in] = next[in];
+        for (uint8_t i = first[in]; i < first[in + 1]; i++) {
+            evaluate(order[i], next[in], now);
+        }
+    }
+    valid = true;
+
+    // Hold timers: only rules that are currently past their threshold
+    uint32_t pending = pendingMask;
+    while (pending) {
+        uint8_t r = __builtin_ctz(pending);
+        pending &= pending - 1;
+        if (now - pendingSince[r] >= ALERT_RULES[r].holdMs) {
+            pendingMask &= ~(1UL << r);
+            setActive(r, true);
+        }
+    }
+}
+
+void AlertEngine::evaluate(uint8_t r, int32_t value, uint32_t now) {
+    const AlertRule& rule = ALERT_RULES[r];
+    uint32_t bit = 1UL << r;
+
+    if (activeMask & bit) {
+        bool clear = rule.cmp == ALERT_ABOVE ? value <= rule.threshold - rule.hysteresis
+                                             : value >= rule.threshold + rule.hysteresis;
+        if (clear) setActive(r, false);
+        return;
+    }
+
+    bool past = rule.cmp == ALERT_ABOVE ? value > rule.threshold : value < rule.threshold;
+    if (!past) {
+        pendingMask &= ~bit;
+    } else if (!(pendingMask & bit)) {
+        // Timer keeps running while the value moves around past the threshold
+        pendingMask |= bit;
+        pendingSince[r] = now;
+    }
+}
+
+void AlertEngine::setActive(uint8_t r, bool on) {
+    const AlertRule& rule = ALERT_RULES[r];
+    if (on) {
+        activeMask |= 1UL << r;
+        raisedSeq[r] = ++seq;
+    } else {
+        activeMask &= ~(1UL << r);
+    }
+
+    // Only this input's rules can change its level
+    AlertSeverity lvl = ALERT_NONE;
+    for (uint8_t i = first[rule.input]; i < first[rule.input + 1]; i++) {
+        uint8_t k = order[i];
+        if ((activeMask & (1UL << k)) && ALERT_RULES[k].severity > lvl) lvl = ALERT_RULES[k].severity;
+    }
+    inputLevel[rule.input] = lvl;
+
+    topRule = -1;
+    uint32_t active = activeMask;
+    while (active) {
+        uint8_t k = __builtin_ctz(active);
+        active &= active - 1;
+        if (topRule < 0 || ALERT_RULES[k].severity > ALERT_RULES[topRule].severity ||
+            (ALERT_RULES[k].severity == ALERT_RULES[topRule].severity && raisedSeq[k] > raisedSeq[topRule])) {
+            topRule = k;
+        }
+    }
+
+    version++;
+    if (hook) hook(hookCtx, rule, on);
+}
@@ -0,0 +1,398 @@
+#include "BleTransport.h"
+#include "MemTelemetry.h"
+#include <Preferences.h>
+
+BleTransport* BleTransport::links[BLE_MAX_LINKS];
+uint8_t BleTransport::linkCount = 0;
+QueueHandle_t BleTransport::connectQueue = nullptr;
+
+class M365ClientCallbacks : public NimBLEClientCallbacks {
+    void onConnect(NimBLEClient* pClient) {
+        Serial.println("[BLE] Connected");
+    }
+    
+    void onDisconnect(NimBLEClient* pClient, int reason) {
+        Serial.printf("[BLE] Disconnected: %d\n", reason);
+    }
+};
+
+class M365ScanCallbacks : public NimBLEAdvertisedDeviceCallbacks {
+    void onResult(NimBLEAdvertisedDevice* device) override {
+        MemScope scope(MEM_PATH_SCAN);
+        // Names fit std::string's inline buffer; no extra heap String copy
+        // for every advertisement heard
+        const std::string& name = device->getName();
+        
+        if (name.compare(0, 9, "MIScooter") == 0 ||
+            name.compare(0, 11, "Mi Electric") == 0 ||
+            name.find("M365") != std::string::npos ||
+            name.find("Scooter") != std::string::npos) {
+            
+            if (BleTransport::scanCallback(device)) {
+                Serial.printf("[BLE] Found: %s\n", name.c_str());
+            }
+        }
+    }
+};
+
+static M365ScanCallbacks scanCallbacks;
+static M365ClientCallbacks clientCallbacks;
+
+BleTransport::BleTransport() {
+    slot = linkCount;
+    if (linkCount < BLE_MAX_LINKS) links[linkCount++] = this;
+    // The first link keeps the plain tag and NVS keys of the one-scooter build
+    if (slot == 0) {
+        strcpy(label, "BLE");
+    } else {
+        snprintf(label, sizeof(label), "BLE%u", slot);
+    }
+    state = LinkState::DISCONNECTED;
+    connecting = false;
+    rssi = 0;
+    pClient = nullptr;
+    pService = nullptr;
+    pTxChar = nullptr;
+    pRxChar = nullptr;
+    found = false;
+    haveCached = false;
+    cachedFailed = false;
+    lastScan = 0;
+    lastRssi = 0;
+    connInterval = BLE_CONN_INTERVAL_DEFAULT;
+    appliedConnInterval = BLE_CONN_INTERVAL_DEFAULT;
+    rxBuffer = nullptr;
+    rxDropped = 0;
+}
+
+BleTransport* BleTransport::forClient(NimBLEClient* client) {
+    for (uint8_t i = 0; i < linkCount; i++) {
+        if (links[i]->pClient == client) return links[i];
+    }
+    return nullptr;
+}
+
+// Connected to it, about to connect to it, or it's the scooter this
+// link reconnects to
+bool BleTransport::owns(const NimBLEAddress& addr) const {
+    if (found && foundAddress == addr) return true;
+    if (haveCached && !cachedFailed && cachedAddress == addr) return true;
+    return (state == LinkState::CONNECTED || state == LinkState::AUTHENTICATED) &&
+           pClient->getPeerAddress() == addr;
+}
+
+bool BleTransport::claimed(const NimBLEAddress& addr, const BleTransport* except) {
+    for (uint8_t i = 0; i < linkCount; i++) {
+        if (links[i] != except && links[i]->owns(addr)) return true;
+    }
+    return false;
+}
+
+static void prefKey(char* key, size_t n, const char* base, uint8_t slot) {
+    if (slot == 0) {
+        snprintf(key, n, "%s", base);
+    } else {
+        snprintf(key, n, "%s%u", base, slot);
+    }
+}
+
+void BleTransport::begin() {
+    Serial.printf("[%s] Init\n", label);
+    
+    rxBuffer = xMessageBufferCreate(BLE_RX_BUFFER_SIZE);
+    if (!connectQueue) {
+        connectQueue = xQueueCreate(BLE_MAX_LINKS, sizeof(BleTransport*));
+        xTaskCreatePinnedToCore(connectTaskEntry, "bleconn", BLE_CONNECT_STACK, nullptr,
+                                BLE_CONNECT_PRIORITY, nullptr, 0);
+    }
+    
+    if (!NimBLEDevice::getInitialized()) {
+        NimBLEDevice::init("M365Dashboard");
+        NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+        NimBLEDevice::setSecurityAuth(false, false, false);
+    }
+    
+    pClient = NimBLEDevice::createClient();
+    pClient->setClientCallbacks(&clientCallbacks, false);
+    pClient->setConnectionParams(BLE_CONN_INTERVAL_DEFAULT, BLE_CONN_INTERVAL_DEFAULT, 0, BLE_SUPERVISION_TIMEOUT);
+    pClient->setConnectTimeout(BLE_CONNECT_TIMEOUT_S);
+    
+    // Known scooter: skip the scan, update() connects on its first call
+    loadCachedAddress();
+    if (haveCached) {
+        state = LinkState::CONNECTING;
+    } else {
+        startScan();
+    }
+}
+
+void BleTransport::loadCachedAddress() {
+    char addrKey[8], typeKey[8];
+    prefKey(addrKey, sizeof(addrKey), "addr", slot);
+    prefKey(typeKey, sizeof(typeKey), "type", slot);
+    
+    Preferences prefs;
+    if (!prefs.begin(BLE_PREFS_NAMESPACE, true)) return;
+    uint8_t raw[6];
+    if (prefs.getBytes(addrKey, raw, sizeof(raw)) == sizeof(raw)) {
+        char text[18];
+        snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x",
+                 raw[0], raw[1], raw[2], raw[3], raw[4], raw[5]);
+        cachedAddress = NimBLEAddress(std::string(text), prefs.getUChar(typeKey, 0));
+        haveCached = true;
+        Serial.printf("[%s] Cached scooter %s\n", label, text);
+    }
+    prefs.end();
+}
+
+void BleTransport::saveCachedAddress(const NimBLEAddress& addr) {
+    if (haveCached && addr == cachedAddress) return;
+    
+    // Stored in the same order toString() prints
+    uint8_t raw[6];
+    const uint8_t* native = addr.getNative();
+    for (uint8_t i = 0; i < 6; i++) raw[i] = native[5 - i];
+    
+    char addrKey[8], typeKey[8];
+    prefKey(addrKey, sizeof(addrKey), "addr", slot);
+    prefKey(typeKey, sizeof(typeKey), "type", slot);
+    
+    Preferences prefs;
+    if (!prefs.begin(BLE_PREFS_NAMESPACE, false)) return;
+    prefs.putBytes(addrKey, raw, sizeof(raw));
+    prefs.putUChar(typeKey, addr.getType());
+    prefs.end();
+    
+    cachedAddress = addr;
+    haveCached = true;
+    Serial.printf("[%s] Cached %s for next boot\n", label, addr.toString().c_str());
+}
+
+bool BleTransport::startScan() {
+    if (state == LinkState::SCANNING) return true;
+    
+    state = LinkState::SCANNING;
+    found = false;
+    Serial.printf("[%s] Scanning...\n", label);
+    runScan(millis());
+    return true;
+}
+
+// The scanner is shared: start it unless another link already has
+void BleTransport::runScan(uint32_t now) {
+    lastScan = now;
+    NimBLEScan* pScan = NimBLEDevice::getScan();
+    if (pScan->isScanning()) return;
+    
+    pScan->setAdvertisedDeviceCallbacks(&scanCallbacks, false);
+    pScan->setActiveScan(true);
+    pScan->setInterval(100);
+    pScan->setWindow(99);
+    pScan->start(30, nullptr, false);
+}
+
+// Runs in the NimBLE host task. A link whose cached scooter this is
+// gets it first; the scan stops once no link is left looking.
+bool BleTransport::scanCallback(NimBLEAdvertisedDevice* device) {
+    NimBLEAddress addr = device->getAddress();
+    if (claimed(addr, nullptr)) return false;
+    
+    BleTransport* taker = nullptr;
+    uint8_t looking = 0;
+    for (uint8_t i = 0; i < linkCount; i++) {
+        BleTransport* link = links[i];
+        if (link->state != LinkState::SCANNING || link->found) continue;
+        looking++;
+        if (!taker || (link->haveCached && link->cachedAddress == addr)) taker = link;
+    }
+    if (!taker) return false;
+    
+    taker->foundAddress = addr;
+    taker->found = true;
+    taker->state = LinkState::CONNECTING;
+    if (looking == 1) NimBLEDevice::getScan()->stop();
+    return true;
+}
+
+// ========== Connect task ==========
+
+void BleTransport::connectTaskEntry(void* arg) {
+    BleTransport* link;
+    for (;;) {
+        if (xQueueReceive(connectQueue, &link, portMAX_DELAY) != pdTRUE) continue;
+        link->connect();
+        link->connecting = false;
+    }
+}
+
+// Each link is queued at most once, so the queue never fills
+void BleTransport::requestConnect() {
+    state = LinkState::CONNECTING;
+    connecting = true;
+    BleTransport* self = this;
+    if (xQueueSend(connectQueue, &self, 0) != pdTRUE) connecting = false;
+}
+
+// Connect task only
+bool BleTransport::connect() {
+    // Without a scan result, go straight to the cached address
+    bool direct = !found;
+    if (direct && !haveCached) return false;
+    
+    // The host doesn't connect while scanning; links still looking
+    // restart the scan afterwards
+    NimBLEScan* pScan = NimBLEDevice::getScan();
+    if (pScan->isScanning()) pScan->stop();
+    
+    state = LinkState::CONNECTING;
+    bool ok;
+    if (direct) {
+        Serial.printf("[%s] Connecting to cached %s\n", label, cachedAddress.toString().c_str());
+        pClient->setConnectTimeout(BLE_CACHED_CONNECT_S);
+        ok = pClient->connect(cachedAddress);
+        pClient->setConnectTimeout(BLE_CONNECT_TIMEOUT_S);
+    } else {
+        Serial.printf("[%s] Connecting to %s\n", label, foundAddress.toString().c_str());
+        ok = pClient->connect(foundAddress);
+    }
+    found = false;
+    
+    if (!ok) {
+        Serial.printf("[%s] Connect failed\n", label);
+        state = LinkState::DISCONNECTED;
+        if (direct) {
+            // Off, out of range or a different scooter: find one the usual way
+            cachedFailed = true;
+            startScan();
+        }
+        return false;
+    }
+    
+    rssi = pClient->getRssi();
+    
+    pService = pClient->getService(M365_SERVICE_UUID);
+    if (!pService) {
+        Serial.printf("[%s] Service not found\n", label);
+        pClient->disconnect();
+        state = LinkState::DISCONNECTED;
+        return false;
+    }
+    
+    pTxChar = pService->getCharacteristic(M365_TX_CHAR_UUID);
+    pRxChar = pService->getCharacteristic(M365_RX_CHAR_UUID);
+    
+    if (!pTxChar || !pRxChar) {
+        Serial.printf("[%s] Characteristics not found\n", label);
+        pClient->disconnect();
+        state = LinkState::DISCONNECTED;
+        return false;
+    }
+    
+    if (pRxChar->canNotify()) {
+        pRxChar->subscribe(true, notifyCallback, true);
+    }
+    
+    state = LinkState::CONNECTED;
+    appliedConnInterval = BLE_CONN_INTERVAL_DEFAULT;
+    cachedFailed = false;
+    saveCachedAddress(pClient->getPeerAddress());
+    
+    Serial.printf("[%s] Ready\n", label);
+    return true;
+}
+
+LinkState BleTransport::update(uint32_t now) {
+    if (connecting) return state;
+    
+    switch (state) {
+        case LinkState::DISCONNECTED:
+            if (now - lastScan > BLE_RESCAN_MS) {
+                lastScan = now;
+                if (haveCached && !cachedFailed) {
+                    found = false;
+                    requestConnect();
+                } else {
+                    startScan();
+                }
+            }
+            break;
+            
+        case LinkState::SCANNING:
+            if (found) {
+                requestConnect();
+            } else if (now - lastScan > BLE_RESCAN_MS) {
+                // Stopped for another link's hit or connect
+                runScan(now);
+            }
+            break;
+            
+        case LinkState::CONNECTING:
+            if ((found || haveCached) && !pClient->isConnected()) {
+                requestConnect();
+            }
+            break;
+            
+        case LinkState::CONNECTED:
+        case LinkState::AUTHENTICATED:
+            if (!pClient->isConnected()) {
+                state = LinkState::DISCONNECTED;
+                break;
+            }
+            
+            if (now - lastRssi > BLE_RSSI_MS) {
+                rssi = pClient->getRssi();
+                lastRssi = now;
+            }
+            
+            if (appliedConnInterval != connInterval) {
+                appliedConnInterval = connInterval;
+                pClient->updateConnParams(appliedConnInterval, appliedConnInterval, 0, BLE_SUPERVISION_TIMEOUT);
+                Serial.printf("[%s] Conn interval %u.%02u ms\n", label,
+                              appliedConnInterval * 125 / 100, appliedConnInterval * 125 % 100);
+            }
+            break;
+            
+        default:
+            break;
+    }
+    return state;
+}
+
+bool BleTransport::canSend() {
+    return (state == LinkState::CONNECTED || state == LinkState::AUTHENTICATED) &&
+           pTxChar && pClient->isConnected();
+}
+
+bool BleTransport::send(const uint8_t* data, size_t len) {
+    if (!canSend()) return false;
+    return pTxChar->writeValue(data, len, false);
+}
+
+void BleTransport::notifyCallback(BLERemoteCharacteristic* pChar, uint8_t* pData, size_t length, bool isNotify) {
+    // Runs in the NimBLE host task: only queue the bytes, decoding
+    // happens on the protocol task
+    BleTransport* link = forClient(pChar->getRemoteService()->getClient());
+    if (!link || !link->rxBuffer || length > BLE_MAX_NOTIFY) return;
+    
+    uint8_t msg[4 + BLE_MAX_NOTIFY];
+    uint32_t now = millis();
+    memcpy(msg, &now, 4);
+    memcpy(msg + 4, pData, length);
+    if (xMessageBufferSend(link->rxBuffer, msg, length + 4, 0) == 0) {
+        link->rxDropped++;
+    }
+}
+
+size_t BleTransport::receive(uint8_t* buf, size_t maxLen, uint32_t& timeMs) {
+    if (!rxBuffer) return 0;
+    
+    uint8_t msg[4 + BLE_MAX_NOTIFY];
+    size_t n = xMessageBufferReceive(rxBuffer, msg, sizeof(msg), 0);
+    if (n <= 4) return 0;
+    
+    memcpy(&timeMs, msg, 4);
+    n -= 4;
+    if (n > maxLen) n = maxLen;
+    memcpy(buf, msg + 4, n);
+    return n;
+}
@@ -0,0 +1,26 @@
+#include "BootTrace.h"
+#include "esp_timer.h"
+
+static const char* const MILESTONE_NAMES[BOOT_MILESTONES] = {
+    "reset", "first pixel", "ble up", "connected", "first frame"
+};
+
+static int64_t times[BOOT_MILESTONES] = { -1, -1, -1, -1, -1 };
+
+void bootMark(BootMilestone m) {
+    if (times[m] >= 0) return;
+    int64_t now = esp_timer_get_time();
+    times[m] = now;
+    Serial.printf("[BOOT] %-11s %10lld us\n", MILESTONE_NAMES[m], (long long)now);
+
+    // Whole boot on one line once telemetry is flowing
+    if (m == BOOT_FIRST_FRAME) {
+        Serial.printf("[BOOT] pixel %lld ms, ble %lld ms, link %lld ms, data %lld ms\n",
+                      (long long)(times[BOOT_FIRST_PIXEL] / 1000), (long long)(times[BOOT_BLE_UP] / 1000),
+                      (long long)(times[BOOT_CONNECTED] / 1000), (long long)(now / 1000));
+    }
+}
+
+int64_t bootTime(BootMilestone m) {
+    return times[m];
+}
@@ -0,0 +1,53 @@
+#include "CellPack.h"
+
+template <uint8_t N>
+uint8_t CellPack<N>::decode(ScooterData& d, const uint8_t* data, uint8_t len) {
+    if (len < readLen) return 0;
+
+    uint16_t minMv = 5000;
+    uint16_t maxMv = 0;
+    for (uint8_t i = 0; i < N; i++) {
+        uint16_t mv = data[i * 2] | (data[i * 2 + 1] << 8);
+        d.cellMv[i] = mv;
+        if (mv > CELL_VALID_MV) {
+            if (mv < minMv) minMv = mv;
+            if (mv > maxMv) maxMv = mv;
+        }
+    }
+    // No valid cell: both 0 rather than 5000/0
+    d.minCellMv = maxMv ? minMv : 0;
+    d.maxCellMv = maxMv;
+    d.cellCount = N;
+    return N + 2;
+}
+
+template <uint8_t N>
+static constexpr CellPackInfo packInfo() {
+    return { CellPack<N>::cells, CellPack<N>::readLen, CellPack<N>::gridCols,
+             CellPack<N>::gridPitch, CellPack<N>::gridUnit, CellPack<N>::decode };
+}
+
+const CellPackInfo CELL_PACKS[CELL_PACK_COUNT] = {
+    packInfo<10>(),
+    packInfo<12>(),
+    packInfo<13>(),
+    packInfo<16>(),
+};
+
+const CellPackInfo& cellPackFor(uint8_t present) {
+    for (uint8_t p = 0; p < CELL_PACK_COUNT; p++) {
+        if (CELL_PACKS[p].cells >= present) return CELL_PACKS[p];
+    }
+    return CELL_PACKS[CELL_PACK_COUNT - 1];
+}
+
+// Up to the last populated slot, so one dead cell or sense lead doesn't
+// shrink the pack
+uint8_t cellsPresent(const uint8_t* data, uint8_t len) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < CELLS_MAX && i * 2 + 1 < len; i++) {
+        uint16_t mv = data[i * 2] | (data[i * 2 + 1] << 8);
+        if (mv >= CELL_PRESENT_MV) n = i + 1;
+    }
+    return n;
+}
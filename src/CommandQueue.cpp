@@ -0,0 +1,157 @@
+#include "CommandQueue.h"
+#include <string.h>
+
+// Indexed by ControlType
+const ControlSpec CONTROL_SPECS[CTL_COUNT] = {
+    // values  read-back          len  name
+    { 2,       REG_ESC_STATUS,    2,   "lock" },
+    { 2,       REG_ESC_LIGHT,     2,   "light" },
+    { 3,       REG_ESC_MODE,      2,   "mode" },
+    { 2,       REG_ESC_CRUISE,    2,   "cruise" },
+};
+
+CommandQueue::CommandQueue() : hook(nullptr), hookCtx(nullptr) {
+    memset(stats, 0, sizeof(stats));
+    reset();
+}
+
+void CommandQueue::reset() {
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        slots[t].state = SLOT_IDLE;
+        slots[t].target = 0;
+        slots[t].tries = 0;
+    }
+}
+
+uint8_t CommandQueue::observed(ControlType type, const ScooterData& d) {
+    switch (type) {
+        case CTL_LOCK:   return d.isLocked;
+        case CTL_LIGHT:  return d.headlight;
+        case CTL_MODE:   return d.mode;
+        case CTL_CRUISE: return d.cruise;
+        default:         return 0;
+    }
+}
+
+// Scooter-side encoding of each control's values
+void CommandQueue::encode(ControlType type, uint8_t value, ControlFrame& out) {
+    out.cmd = CMD_WRITE;
+    switch (type) {
+        case CTL_LOCK:
+            out.reg = value ? REG_ESC_LOCK : REG_ESC_UNLOCK;
+            out.value = 1;
+            break;
+        case CTL_LIGHT:
+            out.reg = REG_ESC_LIGHT;
+            out.value = value ? 2 : 0;
+            break;
+        case CTL_MODE:
+            // ScooterData's ECO/D/S order against the ESC's D/ECO/S
+            out.reg = REG_ESC_SPEED_MODE;
+            out.value = value == 0 ? 1 : value == 1 ? 0 : 2;
+            break;
+        case CTL_CRUISE:
+            out.reg = REG_ESC_CRUISE;
+            out.value = value ? 1 : 0;
+            break;
+        default:
+            break;
+    }
+}
+
+bool CommandQueue::request(ControlType type, int8_t value, const ScooterData& data, uint32_t at) {
+    Slot& s = slots[type];
+    const ControlSpec& spec = CONTROL_SPECS[type];
+    uint8_t current = observed(type, data);
+
+    // Steps go from the pending target, so two quick taps move two steps
+    uint8_t target;
+    if (value == CTL_STEP) {
+        uint8_t base = s.state != SLOT_IDLE ? s.target : current;
+        target = base < spec.values ? (base + 1) % spec.values : 0;
+    } else {
+        target = (uint8_t)value % spec.values;
+    }
+
+    if (type == CTL_LOCK && target && data.speedRaw > CTL_LOCK_MAX_SPEED_RAW) return false;
+
+    if (s.state != SLOT_IDLE) stats[type].coalesced++;
+
+    if (target == current && (s.state == SLOT_IDLE || s.state == SLOT_WRITE)) {
+        // Nothing on the scooter to undo: drop it
+        s.state = SLOT_IDLE;
+        return true;
+    }
+
+    // Keep the first tap's time: that's what the rider waited from
+    if (s.state == SLOT_IDLE) s.requestedAt = at;
+    s.state = SLOT_WRITE;
+    s.target = target;
+    s.tries = 0;
+    return true;
+}
+
+bool CommandQueue::next(uint32_t now, ControlFrame& out) {
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        Slot& s = slots[t];
+        if (s.state == SLOT_WRITE) {
+            encode((ControlType)t, s.target, out);
+            s.state = SLOT_READBACK;
+            s.tries++;
+            s.writtenAt = now;
+            s.due = now + CTL_READBACK_MS;
+            return true;
+        }
+        if (s.state == SLOT_READBACK && (int32_t)(now - s.due) >= 0) {
+            out.cmd = CMD_READ;
+            out.reg = CONTROL_SPECS[t].readReg;
+            out.value = CONTROL_SPECS[t].readLen;
+            s.state = SLOT_WAIT;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CommandQueue::ready(uint32_t now) const {
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        const Slot& s = slots[t];
+        if (s.state == SLOT_WRITE) return true;
+        if (s.state == SLOT_READBACK && (int32_t)(now - s.due) >= 0) return true;
+    }
+    return false;
+}
+
+void CommandQueue::check(const ScooterData& data, uint32_t now) {
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        Slot& s = slots[t];
+        if (s.state != SLOT_READBACK && s.state != SLOT_WAIT) continue;
+
+        if (observed((ControlType)t, data) == s.target) {
+            finish((ControlType)t, true, now);
+        } else if (now - s.writtenAt >= CTL_ACK_TIMEOUT_MS) {
+            if (s.tries >= CTL_MAX_TRIES) {
+                finish((ControlType)t, false, now);
+            } else {
+                s.state = SLOT_WRITE;
+            }
+        }
+    }
+}
+
+void CommandQueue::finish(ControlType type, bool ok, uint32_t now) {
+    Slot& s = slots[type];
+    ControlStats& st = stats[type];
+    uint32_t latency = now - s.requestedAt;
+    s.state = SLOT_IDLE;
+
+    if (ok) {
+        st.acked++;
+        st.lastMs = latency;
+        st.totalMs += latency;
+        if (latency > st.maxMs) st.maxMs = latency;
+    } else {
+        st.failed++;
+    }
+    if (hook) hook(hookCtx, type, s.target, ok, latency);
+}
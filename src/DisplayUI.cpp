@@ -1,26 +1,68 @@
 #include "DisplayUI.h"
+#include "FastFormat.h"
+#include "GraphScale.h"
 #include <math.h>
 
 DisplayUI::DisplayUI(TFT_eSPI& display) 
     : tft(display), lastSpeed(-1), lastBattery(255), lastOdometer(0), lastTrip(0),
-      lastPower(-1), lastMode(255), lastHeadlight(false), lastError(255),
-      lastVoltage(-1), lastCurrent(-1), lastTempESC(-100), lastTempBMS(-100),
+      lastPower(-1), lastMode(255), lastHeadlight(false), lastSwitches(0xFF),
+      lastPending(0), lastError(255),
+      lastVoltage(-1), lastCurrent(-99999), lastTempESC(-9999), lastTempBMS(-9999),
       lastRideTime(0), lastConnected(false), firstDraw(true), needsClear(false),
-      currentScreen(MAIN_SCREEN), historyIndex(0), lastHistoryUpdate(0) {
-    for(int i = 0; i < HISTORY_SIZE; i++) {
-        powerHistory[i] = 0;
-        currentHistory[i] = 0;
-    }
+      currentScreen(MAIN_SCREEN), selectedCell(-1), backlight(255), gauge(display), chrome(display), switchStartUs(0), graphTier(TIER_RAW), lastGraphVersion(0),
+      journal(nullptr), lastJournalVersion(0), trip(nullptr), tripView(), lastTripVersion(0),
+      tripDrawnVersion(0), lastTripDraw(0), mem(nullptr), lastMemVersion(0), health(nullptr),
+      lastHealthVersion(0), lastStallAt(0), cellGrid(nullptr), fleet(nullptr),
+      lastFleetVersion(0), client(nullptr), lastSpeedSeq(0), smoothSpeedRaw(0),
+      shownSpeed(0), layout(nullptr), alerts(nullptr), lastAlertVersion(0),
+      alertsChanged(false), bannerUp(false), flashToggles(0), flashNextMs(0) {
 }
 
 void DisplayUI::begin() {
-    pinMode(21, OUTPUT);
-    digitalWrite(21, HIGH);
-    
     tft.init();
     tft.setRotation(1);
     tft.fillScreen(COLOR_BG);
     tft.setSwapBytes(true);
+    
+    // Light up only once the panel holds a clean frame
+    ledcSetup(BACKLIGHT_LEDC_CH, BACKLIGHT_PWM_FREQ, BACKLIGHT_PWM_BITS);
+    ledcAttachPin(BACKLIGHT_PIN, BACKLIGHT_LEDC_CH);
+    ledcWrite(BACKLIGHT_LEDC_CH, backlight);
+    
+    chrome.setPainter(paintChrome, this);
+}
+
+void DisplayUI::setBacklight(uint8_t duty) {
+    if (duty == backlight) return;
+    backlight = duty;
+    ledcWrite(BACKLIGHT_LEDC_CH, duty);
+}
+
+void DisplayUI::setLayout(ScreenLayout* l) {
+    layout = l;
+    for (uint8_t s = 0; s < SCREEN_COUNT; s++) {
+        if (l && l->find(s)) chrome.invalidate(s);
+    }
+    needsClear = true;
+}
+
+// Blinks on top of the profile's level, which setBacklight() keeps owning
+void DisplayUI::flashBacklight(uint8_t times) {
+    flashToggles = times * 2;
+    flashNextMs = millis();
+}
+
+void DisplayUI::updateFlash() {
+    if (flashToggles == 0 || (int32_t)(millis() - flashNextMs) < 0) return;
+    flashToggles--;
+    ledcWrite(BACKLIGHT_LEDC_CH, (flashToggles & 1) ? 0 : backlight);
+    flashNextMs = millis() + ALERT_FLASH_MS;
+}
+
+// Idle time before the link is up: render the current screen's chrome
+// cache now so the first telemetry frame is a plain blit
+void DisplayUI::prepare() {
+    if (!chrome.isBuilt(currentScreen)) chrome.build(currentScreen);
 }
 
 void DisplayUI::showStatus(const char* message) {
@@ -34,6 +76,7 @@ void DisplayUI::showStatus(const char* message) {
 
 void DisplayUI::setScreen(Screen screen) {
     if (currentScreen != screen) {
+        switchStartUs = micros();
         currentScreen = screen;
         needsClear = true;
         firstDraw = true;
@@ -41,15 +84,33 @@ void DisplayUI::setScreen(Screen screen) {
 }
 
 void DisplayUI::update(const ScooterData& data) {
+    bool switched = needsClear;
     if (needsClear) {
-        tft.fillScreen(COLOR_BG);
+        // One streamed pass of cached chrome instead of clear + redraw
+        if (health) health->section(LOOP_RENDER, SEC_CLEAR);
+        if (!chrome.blit(currentScreen)) {
+            tft.fillScreen(COLOR_BG);
+            drawChrome(currentScreen, tft, 0);
+        }
+        if (health) health->section(LOOP_RENDER, SEC_DRAW);
         needsClear = false;
         firstDraw = true;
     }
     
     updateHistory(data);
+    updateSpeed(data);
+    updateFlash();
+    
+    if (trip && trip->getVersion() != lastTripVersion) {
+        lastTripVersion = trip->getVersion();
+        trip->getSummary(tripView);
+    }
+    alertsChanged = alerts && alerts->getVersion() != lastAlertVersion;
     
-    switch (currentScreen) {
+    const LayoutScreen* custom = layout ? layout->find(currentScreen) : nullptr;
+    if (custom) {
+        drawLayoutScreen(*custom, data);
+    } else switch (currentScreen) {
         case MAIN_SCREEN:
             drawMainScreen(data);
             break;
@@ -59,56 +120,362 @@ void DisplayUI::update(const ScooterData& data) {
         case BATTERY_SCREEN:
             drawBatteryScreen(data);
             break;
+        case GAUGE_SCREEN:
+            drawGaugeScreen(data);
+            break;
+        case RIDES_SCREEN:
+            drawRidesScreen();
+            break;
+        case TRIP_SCREEN:
+            drawTripScreen();
+            break;
+        case DIAG_SCREEN:
+            drawDiagScreen();
+            break;
+        case LOOP_SCREEN:
+            drawLoopScreen();
+            break;
+        case FLEET_SCREEN:
+            drawFleetScreen();
+            break;
+        default:
+            break;
     }
     
+    drawAlertBanner();
     firstDraw = false;
+    
+    if (switched && switchStartUs != 0) {
+        Serial.printf("[UI] Screen %d ready in %lu us\n", currentScreen, micros() - switchStartUs);
+        switchStartUs = 0;
+    }
 }
 
-void DisplayUI::handleTouch(uint16_t x, uint16_t y) {
-    currentScreen = (Screen)((currentScreen + 1) % 3);
-    needsClear = true;
-    firstDraw = true;
+void DisplayUI::paintChrome(void* ctx, uint8_t slot, TFT_eSPI& gfx, int16_t yOff) {
+    static_cast<DisplayUI*>(ctx)->drawChrome((Screen)slot, gfx, yOff);
 }
 
-void DisplayUI::updateHistory(const ScooterData& data) {
-    unsigned long now = millis();
-    if (now - lastHistoryUpdate >= 1000) {
-        powerHistory[historyIndex] = data.power;
-        currentHistory[historyIndex] = fabs(data.current);
-        historyIndex = (historyIndex + 1) % HISTORY_SIZE;
-        lastHistoryUpdate = now;
+// Static labels, titles and dividers. Drawn into the chrome cache strips,
+// so everything here must be independent of telemetry.
+void DisplayUI::drawChrome(Screen screen, TFT_eSPI& gfx, int16_t yOff) {
+    const LayoutScreen* custom = layout ? layout->find(screen) : nullptr;
+    if (custom) {
+        drawLayoutChrome(*custom, gfx, yOff);
+        return;
+    }
+    
+    switch (screen) {
+        case MAIN_SCREEN:
+            gfx.drawFastHLine(0, 30 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 155 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 205 + yOff, 320, COLOR_DARKGRAY);
+            gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+            gfx.setTextDatum(TL_DATUM);
+            gfx.drawString("RANGE", 5, 215 + yOff, 1);
+            gfx.drawString("AVG", 115, 215 + yOff, 1);
+            gfx.drawString("MAX", 215, 215 + yOff, 1);
+            break;
+            
+        case STATS_SCREEN:
+            gfx.setTextColor(COLOR_ORANGE, COLOR_BG);
+            gfx.setTextDatum(MC_DATUM);
+            gfx.drawString("POWER & CURRENT", 160, 15 + yOff, 4);
+            gfx.drawFastHLine(0, 35 + yOff, 320, COLOR_DARKGRAY);
+            break;
+            
+        case BATTERY_SCREEN:
+            gfx.setTextColor(COLOR_GREEN, COLOR_BG);
+            gfx.setTextDatum(MC_DATUM);
+            gfx.drawString("BATTERY", 160, 15 + yOff, 4);
+            gfx.drawFastHLine(0, 32 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 130 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 200 + yOff, 320, COLOR_DARKGRAY);
+            gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+            gfx.setTextDatum(TL_DATUM);
+            gfx.drawString("CELLS", 5, 138 + yOff, 1);
+            break;
+            
+        case GAUGE_SCREEN:
+            gauge.drawDial(gfx, yOff);
+            break;
+            
+        case RIDES_SCREEN:
+            gfx.setTextColor(COLOR_CYAN, COLOR_BG);
+            gfx.setTextDatum(MC_DATUM);
+            gfx.drawString("RIDES", 160, 15 + yOff, 4);
+            gfx.drawFastHLine(0, 32 + yOff, 320, COLOR_DARKGRAY);
+            gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+            gfx.setTextDatum(TL_DATUM);
+            gfx.drawString("#", 5, 38 + yOff, 1);
+            gfx.drawString("DIST", 45, 38 + yOff, 1);
+            gfx.drawString("TIME", 115, 38 + yOff, 1);
+            gfx.drawString("ENERGY", 180, 38 + yOff, 1);
+            gfx.drawString("MAX", 250, 38 + yOff, 1);
+            gfx.drawString("ERR", 290, 38 + yOff, 1);
+            break;
+            
+        case TRIP_SCREEN:
+            {
+                gfx.setTextColor(COLOR_YELLOW, COLOR_BG);
+                gfx.setTextDatum(ML_DATUM);
+                gfx.drawString("TRIP", 5, 15 + yOff, 4);
+                gfx.drawFastHLine(0, 32 + yOff, 320, COLOR_DARKGRAY);
+                gfx.drawFastHLine(0, 140 + yOff, 320, COLOR_DARKGRAY);
+                
+                static const char* const cols[] = { "AVG", "SD", "P50", "P95", "P99", "MAX" };
+                static const char* const rows[] = { "km/h", "A", "W", "ESC C", "BAT C" };
+                static const char* const speedBands[] = { "0", "5", "10", "15", "20", "25" };
+                static const char* const powerBands[] = { "RG", "0", "100", "200", "300", "400" };
+                gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+                gfx.setTextDatum(TR_DATUM);
+                for (uint8_t c = 0; c < 6; c++) gfx.drawString(cols[c], 95 + c * 44, 38 + yOff, 1);
+                gfx.setTextDatum(TL_DATUM);
+                for (uint8_t r = 0; r < TRIP_CHANNELS; r++) gfx.drawString(rows[r], 5, 53 + r * 17 + yOff, 1);
+                gfx.drawString("SPEED ZONES", 5, 145 + yOff, 1);
+                gfx.drawString("POWER ZONES", 165, 145 + yOff, 1);
+                gfx.setTextDatum(TC_DATUM);
+                for (uint8_t z = 0; z < TRIP_ZONES; z++) {
+                    gfx.drawString(speedBands[z], 19 + z * 25, 228 + yOff, 1);
+                    gfx.drawString(powerBands[z], 179 + z * 25, 228 + yOff, 1);
+                }
+            }
+            break;
+            
+        case DIAG_SCREEN:
+            gfx.setTextColor(COLOR_WHITE, COLOR_BG);
+            gfx.setTextDatum(ML_DATUM);
+            gfx.drawString("DIAG", 5, 15 + yOff, 4);
+            gfx.drawFastHLine(0, 32 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 116 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastVLine(158, 32 + yOff, 84, COLOR_DARKGRAY);
+            gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+            gfx.setTextDatum(TL_DATUM);
+            gfx.drawString("Free heap", 5, 40 + yOff, 2);
+            gfx.drawString("Min free", 5, 58 + yOff, 2);
+            gfx.drawString("Largest", 5, 76 + yOff, 2);
+            gfx.drawString("Frag", 5, 94 + yOff, 2);
+            gfx.drawString("ALLOCS", 165, 38 + yOff, 1);
+            gfx.drawString("/s", 255, 38 + yOff, 1);
+            gfx.drawString("total", 285, 38 + yOff, 1);
+            gfx.drawString("STACK FREE (bytes)", 5, 122 + yOff, 1);
+            break;
+            
+        case LOOP_SCREEN: {
+            static const char* const rows[] = { "proto iter", "render iter", "update gap", "poll gap", "frame gap" };
+            static const char* const cols[] = { "MEAN", "P50", "P99", "MAX" };
+            static const char* const axis[] = { "64us", "1ms", "16ms", "262ms", "4.2s" };
+            gfx.setTextColor(COLOR_WHITE, COLOR_BG);
+            gfx.setTextDatum(ML_DATUM);
+            gfx.drawString("LOOP", 5, 15 + yOff, 4);
+            gfx.drawFastHLine(0, 32 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 138 + yOff, 320, COLOR_DARKGRAY);
+            gfx.drawFastHLine(0, 218 + yOff, 320, COLOR_DARKGRAY);
+            gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+            gfx.setTextDatum(TR_DATUM);
+            for (uint8_t c = 0; c < 4; c++) gfx.drawString(cols[c], 135 + c * 60, 38 + yOff, 1);
+            gfx.setTextDatum(TL_DATUM);
+            for (uint8_t r = 0; r < 5; r++) gfx.drawString(rows[r], 5, 49 + r * 17 + yOff, 2);
+            gfx.drawString("POLL GAPS", 5, 142 + yOff, 1);
+            gfx.setTextDatum(TC_DATUM);
+            for (uint8_t a = 0; a < 5; a++) gfx.drawString(axis[a], LOOP_HIST_X + a * 64, 208 + yOff, 1);
+            break;
+        }
+            
+        case FLEET_SCREEN:
+            gfx.setTextColor(COLOR_WHITE, COLOR_BG);
+            gfx.setTextDatum(ML_DATUM);
+            gfx.drawString("FLEET", 5, 15 + yOff, 4);
+            gfx.drawFastHLine(0, 32 + yOff, 320, COLOR_DARKGRAY);
+            gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+            gfx.setTextDatum(TL_DATUM);
+            gfx.drawString("#", 5, 38 + yOff, 1);
+            gfx.drawString("LINK", 22, 38 + yOff, 1);
+            gfx.setTextDatum(TR_DATUM);
+            gfx.drawString("SOC", 150, 38 + yOff, 1);
+            gfx.drawString("ESC", 192, 38 + yOff, 1);
+            gfx.drawString("BAT", 234, 38 + yOff, 1);
+            gfx.drawString("ERR", 266, 38 + yOff, 1);
+            gfx.drawString("Hz", 315, 38 + yOff, 1);
+            gfx.drawFastHLine(0, 49 + yOff, 320, COLOR_DARKGRAY);
+            break;
+            
+        default:
+            break;
     }
 }
 
-void DisplayUI::formatTime(uint32_t seconds, char* buf) {
-    uint32_t h = seconds / 3600;
-    uint32_t m = (seconds % 3600) / 60;
-    uint32_t s = seconds % 60;
-    if (h > 0) {
-        sprintf(buf, "%lu:%02lu:%02lu", h, m, s);
-    } else {
-        sprintf(buf, "%02lu:%02lu", m, s);
+static const TouchRegion TOUCH_REGIONS[] = {
+    { MAIN_SCREEN,    GESTURE_LONG_PRESS, 210, 207, 110, 33,  ACTION_RESET_TRIP },
+    { MAIN_SCREEN,    GESTURE_TAP,        42,  0,   36,  28,  ACTION_TOGGLE_LIGHT },
+    { MAIN_SCREEN,    GESTURE_TAP,        120, 0,   60,  28,  ACTION_CYCLE_MODE },
+    { MAIN_SCREEN,    GESTURE_LONG_PRESS, 80,  0,   38,  28,  ACTION_TOGGLE_LOCK },
+    { MAIN_SCREEN,    GESTURE_LONG_PRESS, 120, 0,   60,  28,  ACTION_TOGGLE_CRUISE },
+    { STATS_SCREEN,   GESTURE_TAP,        10,  45,  300, 170, ACTION_CYCLE_GRAPH_TIER },
+    { BATTERY_SCREEN, GESTURE_TAP,        0,   150, 320, 46,  ACTION_SELECT_CELL },
+    { TRIP_SCREEN,    GESTURE_LONG_PRESS, 0,   0,   320, 240, ACTION_RESET_TRIP },
+};
+
+void DisplayUI::handleTouch(const TouchEvent& evt) {
+    for (size_t i = 0; i < sizeof(TOUCH_REGIONS) / sizeof(TOUCH_REGIONS[0]); i++) {
+        const TouchRegion& r = TOUCH_REGIONS[i];
+        // Status bar icons are hidden under the alert banner
+        if (bannerUp && r.y + r.h <= ALERT_BANNER_H) continue;
+        if (r.screen == currentScreen && r.gesture == evt.gesture &&
+            evt.x >= r.x && evt.x < r.x + r.w && evt.y >= r.y && evt.y < r.y + r.h) {
+            runAction(r.action, evt);
+            return;
+        }
+    }
+    
+    switch (evt.gesture) {
+        case GESTURE_TAP:
+        case GESTURE_SWIPE_LEFT:
+            setScreen(stepScreen(1));
+            break;
+        case GESTURE_SWIPE_RIGHT:
+            setScreen(stepScreen(-1));
+            break;
+        default:
+            break;
+    }
+}
+
+// Neighbouring screen, leaving out the fleet overview without a fleet
+Screen DisplayUI::stepScreen(int8_t dir) const {
+    Screen s = currentScreen;
+    do {
+        s = (Screen)((s + SCREEN_COUNT + dir) % SCREEN_COUNT);
+    } while (s == FLEET_SCREEN && !fleet);
+    return s;
+}
+
+void DisplayUI::runAction(TouchAction action, const TouchEvent& evt) {
+    switch (action) {
+        case ACTION_RESET_TRIP:
+            // Applied by the protocol task; the screens follow the next summary
+            if (trip) trip->requestReset();
+            break;
+            
+        case ACTION_CYCLE_GRAPH_TIER:
+            cycleGraphTier();
+            break;
+            
+        // Sent by the protocol task; the icons follow the read-back
+        case ACTION_CYCLE_MODE:
+            if (client) client->control(CTL_MODE, CTL_STEP, evt.time);
+            break;
+            
+        case ACTION_TOGGLE_LIGHT:
+            if (client) client->control(CTL_LIGHT, CTL_STEP, evt.time);
+            break;
+            
+        case ACTION_TOGGLE_CRUISE:
+            if (client) client->control(CTL_CRUISE, CTL_STEP, evt.time);
+            break;
+            
+        case ACTION_TOGGLE_LOCK:
+            if (client) client->control(CTL_LOCK, CTL_STEP, evt.time);
+            break;
+            
+        case ACTION_SELECT_CELL:
+            {
+                // Same grid as drawCells(), for the pack on screen
+                const CellPackInfo& pack = cellGrid ? *cellGrid : CELL_PACKS[0];
+                int col = (evt.x - 5) / pack.gridPitch;
+                int row = (evt.y - 150) / 22;
+                if (col < 0) col = 0;
+                if (col >= pack.gridCols) col = pack.gridCols - 1;
+                if (row > CELL_GRID_ROWS - 1) row = CELL_GRID_ROWS - 1;
+                int8_t cell = row * pack.gridCols + col;
+                if (cell >= pack.cells) break;
+                selectedCell = (cell == selectedCell) ? -1 : cell;
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void DisplayUI::setGraphTier(HistoryTier tier) {
+    if (graphTier != tier) {
+        graphTier = tier;
+        if (currentScreen == STATS_SCREEN) firstDraw = true;
     }
 }
 
+void DisplayUI::cycleGraphTier() {
+    setGraphTier((HistoryTier)((graphTier + 1) % TIER_COUNT));
+}
+
+void DisplayUI::updateHistory(const ScooterData& data) {
+    history.addSample(data, millis());
+}
+
+// Fed per speed reply with its arrival time, read every frame, so the
+// readout moves between the ~400 ms samples
+void DisplayUI::updateSpeed(const ScooterData& data) {
+    if (!client) {
+        smoothSpeedRaw = data.speedRaw;
+        return;
+    }
+    SpeedSample s = client->getSpeedSample();
+    if (s.seq != lastSpeedSeq) {
+        lastSpeedSeq = s.seq;
+        speedFilter.add(s.speedRaw, s.at);
+    }
+    int32_t est = speedFilter.estimate(millis());
+    smoothSpeedRaw = est > INT16_MAX ? INT16_MAX : est;
+    // The digit only moves once the filtered speed is well into the
+    // next integer
+    shownSpeed = SpeedFilter::hold(shownSpeed, smoothSpeedRaw);
+}
+
 // ========== MAIN SCREEN ==========
-void DisplayUI::drawMainScreen(const ScooterData& data) {
-    char buf[32];
+// Top status bar, unless the alert banner covers it. The icons' touch
+// regions are fixed, so this always draws at the top of the screen.
+void DisplayUI::drawStatusBar(const ScooterData& data) {
+    char buf[8];
     
-    // Top status bar
-    if (firstDraw || data.connected != lastConnected) {
+    if (!bannerUp && (firstDraw || data.connected != lastConnected)) {
         tft.fillRect(0, 0, 40, 28, COLOR_BG);
         drawBleStatus(8, 6, data.connected);
         lastConnected = data.connected;
     }
     
-    if (firstDraw || data.mode != lastMode) {
+    // Icons with a write in flight get a marker until the read-back
+    // confirms it
+    uint8_t pending = 0;
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        if (client && client->controlPending((ControlType)t)) pending |= 1 << t;
+    }
+    uint8_t pendingChanged = pending ^ lastPending;
+    lastPending = pending;
+    
+    if (!bannerUp && (firstDraw || data.headlight != lastHeadlight || (pendingChanged & (1 << CTL_LIGHT)))) {
+        tft.fillRect(42, 0, 36, 28, COLOR_BG);
+        drawHeadlight(48, 7, data.headlight);
+        drawPending(44, 26, 32, pending & (1 << CTL_LIGHT));
+        lastHeadlight = data.headlight;
+    }
+    
+    uint8_t switches = (data.cruise ? 1 : 0) | (data.isLocked ? 2 : 0);
+    if (!bannerUp && (firstDraw || switches != lastSwitches ||
+                      (pendingChanged & ((1 << CTL_CRUISE) | (1 << CTL_LOCK))))) {
+        tft.fillRect(80, 0, 38, 28, COLOR_BG);
+        drawSwitches(82, 10, data.cruise, data.isLocked);
+        drawPending(82, 26, 34, pending & ((1 << CTL_CRUISE) | (1 << CTL_LOCK)));
+        lastSwitches = switches;
+    }
+    
+    if (!bannerUp && (firstDraw || data.mode != lastMode || (pendingChanged & (1 << CTL_MODE)))) {
         tft.fillRect(120, 0, 60, 28, COLOR_BG);
         drawModeIcon(125, 4, data.mode);
+        drawPending(125, 26, 50, pending & (1 << CTL_MODE));
         lastMode = data.mode;
     }
     
-    if (firstDraw || data.errorCode != lastError) {
+    if (!bannerUp && (firstDraw || data.errorCode != lastError)) {
         tft.fillRect(185, 0, 35, 28, COLOR_BG);
         if (data.errorCode > 0) {
             drawErrorIcon(190, 6, data.errorCode);
@@ -116,66 +483,65 @@ void DisplayUI::drawMainScreen(const ScooterData& data) {
         lastError = data.errorCode;
     }
     
-    if (firstDraw || abs((int)data.batteryLevel - (int)lastBattery) >= 1) {
+    if (!bannerUp && (firstDraw || abs((int)data.batteryLevel - (int)lastBattery) >= 1)) {
         tft.fillRect(235, 0, 85, 28, COLOR_BG);
         drawBatteryBar(240, 6, 45, 16, (int)data.batteryLevel);
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
-        sprintf(buf, "%d%%", (int)data.batteryLevel);
+        fmtAppend(buf, fmtUint(buf, (uint32_t)data.batteryLevel), "%");
         tft.drawString(buf, 290, 6, 2);
         lastBattery = (uint8_t)data.batteryLevel;
     }
+}
+
+void DisplayUI::drawMainScreen(const ScooterData& data) {
+    char buf[32];
     
-    if (firstDraw) {
-        tft.drawFastHLine(0, 30, 320, COLOR_DARKGRAY);
-    }
+    drawStatusBar(data);
     
     // Speedometer
-    int speedInt = (int)data.speed;
-    static int lastSpeedInt = -1;
-    
-    if (firstDraw || speedInt != lastSpeedInt) {
+    if (firstDraw || shownSpeed != lastSpeed) {
         tft.fillRect(80, 40, 160, 100, COLOR_BG);
         tft.setTextDatum(MC_DATUM);
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
-        sprintf(buf, "%d", speedInt);
+        fmtInt(buf, shownSpeed);
         tft.drawString(buf, 160, 85, 8);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("km/h", 160, 130, 2);
-        lastSpeedInt = speedInt;
+        lastSpeed = shownSpeed;
     }
     
     // Left column: V, A, W
     tft.setTextDatum(TL_DATUM);
     
-    if (firstDraw || abs(data.voltage - lastVoltage) > 0.2f) {
+    if (firstDraw || abs((int32_t)data.voltageRaw - lastVoltage) > 20) {
         tft.fillRect(0, 32, 78, 38, COLOR_BG);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("V", 3, 33, 1);
         tft.setTextColor(COLOR_CYAN, COLOR_BG);
-        sprintf(buf, "%.1f", data.voltage);
+        fmtFixed(buf, fmtDivRound(data.voltageRaw, 10), 1);
         tft.drawString(buf, 3, 44, 4);
-        lastVoltage = data.voltage;
+        lastVoltage = data.voltageRaw;
     }
     
-    if (firstDraw || abs(data.current - lastCurrent) > 0.3f) {
+    if (firstDraw || abs((int32_t)data.currentRaw - lastCurrent) > 30) {
         tft.fillRect(0, 72, 78, 38, COLOR_BG);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("A", 3, 73, 1);
-        uint16_t col = data.current < 0 ? COLOR_GREEN : COLOR_YELLOW;
+        uint16_t col = data.currentRaw < 0 ? COLOR_GREEN : COLOR_YELLOW;
         tft.setTextColor(col, COLOR_BG);
-        sprintf(buf, "%.1f", fabs(data.current));
+        fmtFixed(buf, fmtDivRound(abs(data.currentRaw), 10), 1);
         tft.drawString(buf, 3, 84, 4);
-        lastCurrent = data.current;
+        lastCurrent = data.currentRaw;
     }
     
-    if (firstDraw || abs(data.power - lastPower) > 5.0f) {
+    if (firstDraw || abs((int32_t)data.power - lastPower) > 5) {
         tft.fillRect(0, 112, 78, 38, COLOR_BG);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("W", 3, 113, 1);
         uint16_t col = data.power < 0 ? COLOR_GREEN : COLOR_ORANGE;
         tft.setTextColor(col, COLOR_BG);
-        sprintf(buf, "%d", abs((int)data.power));
+        fmtUint(buf, abs(data.power));
         tft.drawString(buf, 3, 124, 4);
         lastPower = data.power;
     }
@@ -183,34 +549,28 @@ void DisplayUI::drawMainScreen(const ScooterData& data) {
     // Right column: temperatures
     tft.setTextDatum(TR_DATUM);
     
-    if (firstDraw || abs(data.tempESC - lastTempESC) > 1.0f) {
+    if (firstDraw || alertsChanged || abs((int32_t)data.tempESCRaw - lastTempESC) > 10) {
         tft.fillRect(245, 32, 75, 38, COLOR_BG);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("ESC", 317, 33, 1);
-        uint16_t col = data.tempESC > 60 ? COLOR_RED : (data.tempESC > 45 ? COLOR_YELLOW : COLOR_GREEN);
-        tft.setTextColor(col, COLOR_BG);
-        sprintf(buf, "%.0fC", data.tempESC);
+        tft.setTextColor(alertColor(AIN_TEMP_ESC), COLOR_BG);
+        fmtAppend(buf, fmtInt(buf, fmtDivRound(data.tempESCRaw, 10)), "C");
         tft.drawString(buf, 317, 44, 4);
-        lastTempESC = data.tempESC;
+        lastTempESC = data.tempESCRaw;
     }
     
-    float avgBMS = (data.tempBMS1 + data.tempBMS2) / 2.0f;
-    if (firstDraw || abs(avgBMS - lastTempBMS) > 1.0f) {
+    int16_t avgBMS = data.tempBMSAvgX10();
+    if (firstDraw || alertsChanged || abs((int32_t)avgBMS - lastTempBMS) > 10) {
         tft.fillRect(245, 72, 75, 38, COLOR_BG);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("BAT", 317, 73, 1);
-        uint16_t col = avgBMS > 50 ? COLOR_RED : (avgBMS > 40 ? COLOR_YELLOW : COLOR_GREEN);
-        tft.setTextColor(col, COLOR_BG);
-        sprintf(buf, "%.0fC", avgBMS);
+        tft.setTextColor(alertColor(AIN_TEMP_BMS), COLOR_BG);
+        fmtAppend(buf, fmtInt(buf, fmtDivRound(avgBMS, 10)), "C");
         tft.drawString(buf, 317, 84, 4);
         lastTempBMS = avgBMS;
     }
     
     // Bottom panel
-    if (firstDraw) {
-        tft.drawFastHLine(0, 155, 320, COLOR_DARKGRAY);
-    }
-    
     static uint32_t lastOdoDisplay = 0xFFFFFFFF;
     if (firstDraw || data.odometer != lastOdoDisplay) {
         tft.fillRect(0, 160, 105, 40, COLOR_BG);
@@ -218,7 +578,7 @@ void DisplayUI::drawMainScreen(const ScooterData& data) {
         tft.setTextDatum(TL_DATUM);
         tft.drawString("ODO", 5, 160, 1);
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
-        sprintf(buf, "%.1f", data.odometer / 1000.0f);
+        fmtFixed(buf, fmtDivRound(data.odometer, 100), 1);
         tft.drawString(buf, 5, 173, 4);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("km", 80, 190, 1);
@@ -232,7 +592,7 @@ void DisplayUI::drawMainScreen(const ScooterData& data) {
         tft.setTextDatum(TL_DATUM);
         tft.drawString("TRIP", 113, 160, 1);
         tft.setTextColor(COLOR_ORANGE, COLOR_BG);
-        sprintf(buf, "%.2f", data.tripDistance / 1000.0f);
+        fmtFixed(buf, fmtDivRound(data.tripDistance, 10), 2);
         tft.drawString(buf, 113, 173, 4);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("km", 183, 190, 1);
@@ -246,53 +606,43 @@ void DisplayUI::drawMainScreen(const ScooterData& data) {
         tft.setTextDatum(TL_DATUM);
         tft.drawString("TIME", 218, 160, 1);
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
-        formatTime(data.rideTime, buf);
+        fmtTime(buf, data.rideTime);
         tft.drawString(buf, 218, 173, 4);
         lastTimeDisplay = data.rideTime;
     }
     
     // Bottom row
-    if (firstDraw) {
-        tft.drawFastHLine(0, 205, 320, COLOR_DARKGRAY);
-        tft.setTextColor(COLOR_GRAY, COLOR_BG);
-        tft.setTextDatum(TL_DATUM);
-        tft.drawString("RANGE", 5, 215, 1);
-        tft.drawString("AVG", 115, 215, 1);
-        tft.drawString("MAX", 215, 215, 1);
-    }
-    
-    static float lastRange = -999;
-    if (firstDraw || data.remainingRange != lastRange) {
+    static int32_t lastRange = -1;
+    if (firstDraw || data.remainingRangeRaw != lastRange) {
         tft.fillRect(45, 212, 60, 20, COLOR_BG);
         tft.setTextColor(COLOR_GREEN, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
-        sprintf(buf, "%.1fkm", data.remainingRange);
+        fmtAppend(buf, fmtFixed(buf, fmtDivRound(data.remainingRangeRaw, 10), 1), "km");
         tft.drawString(buf, 45, 215, 2);
-        lastRange = data.remainingRange;
+        lastRange = data.remainingRangeRaw;
     }
     
-    float avgSpeed = 0;
-    if (data.tripDistance > 0 && data.rideTime > 0) {
-        avgSpeed = (data.tripDistance / 1000.0f) / (data.rideTime / 3600.0f);
-    }
-    static float lastAvgSpeed = -999;
+    int32_t avgSpeed = data.tripAvgSpeedX10();
+    static int32_t lastAvgSpeed = -1;
     if (firstDraw || avgSpeed != lastAvgSpeed) {
         tft.fillRect(145, 212, 50, 20, COLOR_BG);
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
-        sprintf(buf, "%.1f", avgSpeed);
+        fmtFixed(buf, avgSpeed, 1);
         tft.drawString(buf, 145, 215, 2);
         lastAvgSpeed = avgSpeed;
     }
     
-    static float maxSpeed = 0;
-    if (data.speed > maxSpeed || firstDraw) {
-        if (data.speed > maxSpeed) maxSpeed = data.speed;
+    // Trip maximum, so it survives screen changes and reboots
+    static int32_t lastMaxSpeed = -1;
+    int32_t maxSpeed = lroundf(tripView.ch[TRIP_SPEED].max);
+    if (firstDraw || maxSpeed != lastMaxSpeed) {
         tft.fillRect(245, 212, 50, 20, COLOR_BG);
         tft.setTextColor(COLOR_ORANGE, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
-        sprintf(buf, "%.0f", maxSpeed);
+        fmtInt(buf, maxSpeed);
         tft.drawString(buf, 245, 215, 2);
+        lastMaxSpeed = maxSpeed;
     }
 }
 
@@ -300,48 +650,44 @@ void DisplayUI::drawMainScreen(const ScooterData& data) {
 void DisplayUI::drawStatsScreen(const ScooterData& data) {
     char buf[32];
     
-    if (firstDraw) {
-        tft.fillScreen(COLOR_BG);
-        tft.setTextColor(COLOR_ORANGE, COLOR_BG);
-        tft.setTextDatum(MC_DATUM);
-        tft.drawString("POWER & CURRENT", 160, 15, 4);
-        tft.drawFastHLine(0, 35, 320, COLOR_DARKGRAY);
-    }
-    
-    // Redraw graphs only when new data point added (every 1 sec)
-    static unsigned long lastGraphDraw = 0;
-    if (firstDraw || millis() - lastGraphDraw >= 1000) {
-        drawGraph(10, 45, 300, 80, powerHistory, HISTORY_SIZE, COLOR_ORANGE, "POWER (W)");
-        drawGraph(10, 135, 300, 80, currentHistory, HISTORY_SIZE, COLOR_YELLOW, "CURRENT (A)");
-        lastGraphDraw = millis();
+    // Redraw graphs only when the shown tier gained a point
+    if (firstDraw || history.tierVersion(graphTier) != lastGraphVersion) {
+        drawGraph(10, 45, 300, 80, HIST_POWER, COLOR_ORANGE, "POWER (W)");
+        drawGraph(10, 135, 300, 80, HIST_CURRENT, COLOR_YELLOW, "CURRENT (A)");
+        lastGraphVersion = history.tierVersion(graphTier);
     }
     
     // Bottom stats - only update on change
-    static int lastPwrStat = -999;
-    static float lastCurStat = -999;
-    static float lastVoltStat = -999;
+    static int32_t lastPwrStat = -999;
+    static int32_t lastCurStat = -99999;
+    static int32_t lastVoltStat = -99999;
     
-    if (firstDraw || abs((int)data.power - lastPwrStat) > 2 || 
-        fabs(data.current - lastCurStat) > 0.1f || fabs(data.voltage - lastVoltStat) > 0.2f) {
+    if (firstDraw || abs((int32_t)data.power - lastPwrStat) > 2 || 
+        abs((int32_t)data.currentRaw - lastCurStat) > 10 || abs((int32_t)data.voltageRaw - lastVoltStat) > 20) {
         
         tft.fillRect(0, 220, 320, 20, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
         
         tft.setTextColor(COLOR_ORANGE, COLOR_BG);
-        sprintf(buf, "PWR: %dW", abs((int)data.power));
+        uint8_t len = fmtAppend(buf, 0, "PWR: ");
+        len += fmtUint(buf + len, abs(data.power));
+        fmtAppend(buf, len, "W");
         tft.drawString(buf, 20, 222, 2);
         
         tft.setTextColor(COLOR_YELLOW, COLOR_BG);
-        sprintf(buf, "CUR: %.1fA", fabs(data.current));
+        len = fmtAppend(buf, 0, "CUR: ");
+        len += fmtFixed(buf + len, fmtDivRound(abs(data.currentRaw), 10), 1);
+        fmtAppend(buf, len, "A");
         tft.drawString(buf, 130, 222, 2);
         
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
-        sprintf(buf, "V:%.1f", data.voltage);
+        len = fmtAppend(buf, 0, "V:");
+        fmtFixed(buf + len, fmtDivRound(data.voltageRaw, 10), 1);
         tft.drawString(buf, 250, 222, 2);
         
-        lastPwrStat = (int)data.power;
-        lastCurStat = data.current;
-        lastVoltStat = data.voltage;
+        lastPwrStat = data.power;
+        lastCurStat = data.currentRaw;
+        lastVoltStat = data.voltageRaw;
     }
 }
 
@@ -349,21 +695,13 @@ void DisplayUI::drawStatsScreen(const ScooterData& data) {
 void DisplayUI::drawBatteryScreen(const ScooterData& data) {
     char buf[32];
     
-    if (firstDraw) {
-        tft.fillScreen(COLOR_BG);
-        tft.setTextColor(COLOR_GREEN, COLOR_BG);
-        tft.setTextDatum(MC_DATUM);
-        tft.drawString("BATTERY", 160, 15, 4);
-        tft.drawFastHLine(0, 32, 320, COLOR_DARKGRAY);
-    }
-    
     // Battery percentage - only redraw on change
     static int lastBattPercent = -1;
     if (firstDraw || (int)data.batteryLevel != lastBattPercent) {
         tft.fillRect(5, 38, 95, 85, COLOR_BG);
         tft.setTextColor(COLOR_WHITE, COLOR_BG);
         tft.setTextDatum(MC_DATUM);
-        sprintf(buf, "%d", (int)data.batteryLevel);
+        fmtUint(buf, data.batteryLevel);
         tft.drawString(buf, 55, 78, 7);
         lastBattPercent = (int)data.batteryLevel;
     }
@@ -373,45 +711,45 @@ void DisplayUI::drawBatteryScreen(const ScooterData& data) {
     int infoY = 38;
     int lineH = 18;
     
-    static float lastVoltDisp = -999;
-    if (firstDraw || abs(data.voltage - lastVoltDisp) > 0.02f) {
+    static int32_t lastVoltDisp = -99999;
+    if (firstDraw || abs((int32_t)data.voltageRaw - lastVoltDisp) > 2) {
         tft.fillRect(infoX, infoY, 205, lineH, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("Voltage", infoX, infoY + 2, 2);
         tft.setTextColor(COLOR_CYAN, COLOR_BG);
         tft.setTextDatum(TR_DATUM);
-        sprintf(buf, "%.2fV", data.voltage);
+        fmtAppend(buf, fmtFixed(buf, data.voltageRaw, 2), "V");
         tft.drawString(buf, 315, infoY + 2, 2);
-        lastVoltDisp = data.voltage;
+        lastVoltDisp = data.voltageRaw;
     }
     
     infoY += lineH;
-    static float lastCurrDisp = -999;
-    if (firstDraw || abs(data.current - lastCurrDisp) > 0.05f) {
+    static int32_t lastCurrDisp = -99999;
+    if (firstDraw || abs((int32_t)data.currentRaw - lastCurrDisp) > 5) {
         tft.fillRect(infoX, infoY, 205, lineH, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("Current", infoX, infoY + 2, 2);
         tft.setTextColor(COLOR_YELLOW, COLOR_BG);
         tft.setTextDatum(TR_DATUM);
-        sprintf(buf, "%.2fA", data.current);
+        fmtAppend(buf, fmtFixed(buf, data.currentRaw, 2), "A");
         tft.drawString(buf, 315, infoY + 2, 2);
-        lastCurrDisp = data.current;
+        lastCurrDisp = data.currentRaw;
     }
     
     infoY += lineH;
-    static int lastPwrDisp = -999;
-    if (firstDraw || abs((int)data.power - lastPwrDisp) > 2) {
+    static int32_t lastPwrDisp = -999;
+    if (firstDraw || abs((int32_t)data.power - lastPwrDisp) > 2) {
         tft.fillRect(infoX, infoY, 205, lineH, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("Power", infoX, infoY + 2, 2);
         tft.setTextColor(COLOR_ORANGE, COLOR_BG);
         tft.setTextDatum(TR_DATUM);
-        sprintf(buf, "%dW", (int)data.power);
+        fmtAppend(buf, fmtInt(buf, data.power), "W");
         tft.drawString(buf, 315, infoY + 2, 2);
-        lastPwrDisp = (int)data.power;
+        lastPwrDisp = data.power;
     }
     
     infoY += lineH;
@@ -423,103 +761,206 @@ void DisplayUI::drawBatteryScreen(const ScooterData& data) {
         tft.drawString("Capacity", infoX, infoY + 2, 2);
         tft.setTextColor(COLOR_GREEN, COLOR_BG);
         tft.setTextDatum(TR_DATUM);
-        sprintf(buf, "%dmAh", data.capacityRemain);
+        fmtAppend(buf, fmtUint(buf, data.capacityRemain), "mAh");
         tft.drawString(buf, 315, infoY + 2, 2);
         lastCapDisp = data.capacityRemain;
     }
     
     infoY += lineH;
-    float avgBMS = (data.tempBMS1 + data.tempBMS2) / 2.0f;
-    static float lastTempDisp = -999;
-    if (firstDraw || abs(data.tempESC - lastTempDisp) > 0.5f) {
+    int16_t avgBMS = data.tempBMSAvgX10();
+    static int32_t lastTempDisp = -9999;
+    if (firstDraw || alertsChanged || abs((int32_t)data.tempESCRaw - lastTempDisp) > 5) {
         tft.fillRect(infoX, infoY, 205, lineH, COLOR_BG);
         tft.setTextDatum(TL_DATUM);
         tft.setTextColor(COLOR_GRAY, COLOR_BG);
         tft.drawString("Temp", infoX, infoY + 2, 2);
-        uint16_t tempCol = (data.tempESC > 60 || avgBMS > 50) ? COLOR_RED : COLOR_ORANGE;
+        bool hot = alerts && (alerts->level(AIN_TEMP_ESC) >= ALERT_CRIT || alerts->level(AIN_TEMP_BMS) >= ALERT_CRIT);
+        uint16_t tempCol = hot ? COLOR_RED : COLOR_ORANGE;
         tft.setTextColor(tempCol, COLOR_BG);
         tft.setTextDatum(TR_DATUM);
-        sprintf(buf, "%.0f/%.0fC", data.tempESC, avgBMS);
+        uint8_t len = fmtInt(buf, fmtDivRound(data.tempESCRaw, 10));
+        len = fmtAppend(buf, len, "/");
+        len += fmtInt(buf + len, fmtDivRound(avgBMS, 10));
+        fmtAppend(buf, len, "C");
         tft.drawString(buf, 315, infoY + 2, 2);
-        lastTempDisp = data.tempESC;
+        lastTempDisp = data.tempESCRaw;
+    }
+    
+    // Balance info - only redraw on change
+    static int32_t lastImbalance = -999;
+    int32_t imbalance = data.cellImbalanceMv();
+    if (firstDraw || alertsChanged || abs(imbalance - lastImbalance) > 1) {
+        tft.fillRect(0, 208, 150, 25, COLOR_BG);
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        tft.setTextDatum(TL_DATUM);
+        tft.drawString("BAL:", 10, 212, 2);
+        tft.setTextColor(alertColor(AIN_IMBALANCE), COLOR_BG);
+        fmtAppend(buf, fmtInt(buf, imbalance), "mV");
+        tft.drawString(buf, 50, 212, 2);
+        lastImbalance = imbalance;
     }
     
+    drawCells(data);
+}
+
+// Cell grid and the selected cell's detail line; fixed in place, as the
+// cell touch region is. Columns follow the detected pack (CellPack.h).
+void DisplayUI::drawCells(const ScooterData& data) {
+    char buf[32];
+    
     // Cell voltages - only redraw if changed
-    static float lastCells[10] = {0};
-    bool cellsChanged = firstDraw;
-    for (int i = 0; i < 10 && !cellsChanged; i++) {
-        if (abs(data.cellVoltages[i] - lastCells[i]) > 0.005f) cellsChanged = true;
+    static uint16_t lastCells[CELLS_MAX] = {0};
+    static int8_t lastSelectedCell = -1;
+    bool cellsChanged = firstDraw || selectedCell != lastSelectedCell;
+    
+    // A newly detected pack lays the grid out again
+    if (!cellGrid || cellGrid->cells != data.cellCount) {
+        cellGrid = &cellPackFor(data.cellCount);
+        selectedCell = -1;
+        tft.fillRect(0, 150, 320, 46, COLOR_BG);
+        cellsChanged = true;
+    }
+    const CellPackInfo& pack = *cellGrid;
+    
+    for (int i = 0; i < pack.cells && !cellsChanged; i++) {
+        if (abs((int32_t)data.cellMv[i] - lastCells[i]) > 5) cellsChanged = true;
     }
     
     if (cellsChanged) {
-        tft.drawFastHLine(0, 130, 320, COLOR_DARKGRAY);
-        
-        float minV = 5.0f, maxV = 0.0f;
-        for (int i = 0; i < data.cellCount; i++) {
-            if (data.cellVoltages[i] > 0) {
-                if (data.cellVoltages[i] < minV) minV = data.cellVoltages[i];
-                if (data.cellVoltages[i] > maxV) maxV = data.cellVoltages[i];
-            }
-        }
-        
-        tft.setTextColor(COLOR_GRAY, COLOR_BG);
-        tft.setTextDatum(TL_DATUM);
-        tft.drawString("CELLS", 5, 138, 1);
-        
+        uint16_t minV = data.minCellMv;
+        uint16_t maxV = data.maxCellMv;
         int startY = 152;
-        int cellsPerRow = 5;
+        int boxW = pack.gridPitch - 3;
         
-        for (int i = 0; i < data.cellCount && i < 10; i++) {
-            int row = i / cellsPerRow;
-            int col = i % cellsPerRow;
-            int x = 5 + col * 63;
+        for (int i = 0; i < pack.cells; i++) {
+            int row = i / pack.gridCols;
+            int col = i % pack.gridCols;
+            int x = 5 + col * pack.gridPitch;
             int y = startY + row * 22;
             
-            float v = data.cellVoltages[i];
+            uint16_t v = data.cellMv[i];
             
             uint16_t cellColor;
-            if (v <= 0) {
+            if (v == 0) {
                 cellColor = COLOR_DARKGRAY;
-            } else if (v == minV && minV < maxV - 0.02f) {
+            } else if (v == minV && minV + 20 < maxV) {
                 cellColor = COLOR_RED;
-            } else if (v == maxV && maxV > minV + 0.02f) {
+            } else if (v == maxV && maxV > minV + 20) {
                 cellColor = COLOR_CYAN;
             } else {
                 cellColor = COLOR_GREEN;
             }
             
-            tft.fillRect(x, y, 60, 18, COLOR_BG);
+            tft.fillRect(x, y, boxW, 18, COLOR_BG);
+            if (i == selectedCell) {
+                tft.drawRect(x - 2, y, boxW, 18, COLOR_WHITE);
+            }
             tft.setTextColor(cellColor, COLOR_BG);
             tft.setTextDatum(TL_DATUM);
             if (v > 0) {
-                sprintf(buf, "%.2fV", v);
+                fmtAppend(buf, fmtFixed(buf, fmtDivRound(v, 10), 2), pack.gridUnit ? "V" : "");
             } else {
-                sprintf(buf, "---");
+                fmtAppend(buf, 0, "---");
             }
             tft.drawString(buf, x, y + 2, 2);
-            lastCells[i] = data.cellVoltages[i];
+            lastCells[i] = data.cellMv[i];
         }
     }
     
-    // Balance info - only redraw on change
-    static float lastImbalance = -999;
-    float imbalance = (data.maxCellVoltage - data.minCellVoltage) * 1000;
-    if (firstDraw || abs(imbalance - lastImbalance) > 1) {
-        tft.drawFastHLine(0, 200, 320, COLOR_DARKGRAY);
-        tft.fillRect(0, 208, 150, 25, COLOR_BG);
-        tft.setTextColor(COLOR_GRAY, COLOR_BG);
-        tft.setTextDatum(TL_DATUM);
-        tft.drawString("BAL:", 10, 212, 2);
-        tft.setTextColor(imbalance > 50 ? COLOR_RED : COLOR_GREEN, COLOR_BG);
-        sprintf(buf, "%.0fmV", imbalance);
-        tft.drawString(buf, 50, 212, 2);
-        lastImbalance = imbalance;
+    // Selected cell details, in place of the hint
+    if (cellsChanged) {
+        tft.fillRect(150, 208, 170, 25, COLOR_BG);
+        tft.setTextDatum(TR_DATUM);
+        if (selectedCell >= 0 && selectedCell < data.cellCount) {
+            uint16_t mv = data.cellMv[selectedCell];
+            uint8_t len = fmtAppend(buf, 0, "C");
+            len += fmtUint(buf + len, selectedCell + 1);
+            len = fmtAppend(buf, len, " ");
+            len += fmtFixed(buf + len, mv, 3);
+            len = fmtAppend(buf, len, "V +");
+            len += fmtUint(buf + len, mv > data.minCellMv ? mv - data.minCellMv : 0);
+            fmtAppend(buf, len, "mV");
+            tft.setTextColor(COLOR_WHITE, COLOR_BG);
+            tft.drawString(buf, 315, 212, 2);
+        } else {
+            tft.setTextColor(COLOR_GRAY, COLOR_BG);
+            tft.drawString("TAP CELL FOR DETAIL", 310, 218, 1);
+        }
+        lastSelectedCell = selectedCell;
     }
+}
+
+// ========== GAUGE SCREEN ==========
+void DisplayUI::drawGaugeScreen(const ScooterData& data) {
+    char buf[8];
     
     if (firstDraw) {
-        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        gauge.reset();
+    }
+    
+    gauge.update((int16_t)smoothSpeedRaw);
+    
+    static int lastGaugeBattery = -1;
+    if (!bannerUp && (firstDraw || data.batteryLevel != lastGaugeBattery)) {
+        tft.fillRect(270, 0, 50, 18, COLOR_BG);
+        tft.setTextColor(COLOR_WHITE, COLOR_BG);
         tft.setTextDatum(TR_DATUM);
-        tft.drawString("TAP TO RETURN", 310, 218, 1);
+        fmtAppend(buf, fmtUint(buf, data.batteryLevel), "%");
+        tft.drawString(buf, 317, 2, 2);
+        lastGaugeBattery = data.batteryLevel;
+    }
+}
+
+// ========== RIDES SCREEN ==========
+// Reads the journal's RAM index only; redrawn when a summary changes
+void DisplayUI::drawRidesScreen() {
+    uint32_t version = journal ? journal->getVersion() : 0;
+    if (!firstDraw && version == lastJournalVersion) return;
+    lastJournalVersion = version;
+    
+    RideSummary rides[RIDES_ROWS];
+    uint8_t n = journal ? journal->recentRides(rides, RIDES_ROWS) : 0;
+    
+    tft.fillRect(0, 50, 320, 190, COLOR_BG);
+    
+    if (n == 0) {
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        tft.setTextDatum(MC_DATUM);
+        tft.drawString(journal ? "NO RIDES RECORDED" : "NO STORAGE", 160, 130, 2);
+        return;
+    }
+    
+    char buf[12];
+    uint8_t len;
+    tft.setTextDatum(TL_DATUM);
+    for (uint8_t i = 0; i < n; i++) {
+        const RideSummary& r = rides[i];
+        int y = 54 + i * 26;
+        
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        fmtUint(buf, r.seq);
+        tft.drawString(buf, 5, y, 2);
+        
+        tft.setTextColor(COLOR_WHITE, COLOR_BG);
+        len = fmtFixed(buf, fmtDivRound(r.distance, 100), 1);
+        fmtAppend(buf, len, "km");
+        tft.drawString(buf, 45, y, 2);
+        
+        fmtTime(buf, r.duration);
+        tft.drawString(buf, 115, y, 2);
+        
+        len = fmtFixed(buf, r.energyWh10, 1);
+        fmtAppend(buf, len, "Wh");
+        tft.drawString(buf, 180, y, 2);
+        
+        fmtUint(buf, fmtDivRound(r.maxSpeedRaw, 1000));
+        tft.drawString(buf, 250, y, 2);
+        
+        if (r.errors[0] != 0) {
+            tft.setTextColor(COLOR_RED, COLOR_BG);
+            fmtUint(buf, r.errors[0]);
+            tft.drawString(buf, 290, y, 2);
+        }
     }
 }
 
@@ -592,6 +1033,18 @@ void DisplayUI::drawHeadlight(int x, int y, bool on) {
     }
 }
 
+void DisplayUI::drawSwitches(int x, int y, bool cruise, bool locked) {
+    tft.setTextDatum(TL_DATUM);
+    tft.setTextColor(cruise ? COLOR_CYAN : COLOR_DARKGRAY, COLOR_BG);
+    tft.drawString("CC", x, y, 1);
+    tft.setTextColor(locked ? COLOR_RED : COLOR_DARKGRAY, COLOR_BG);
+    tft.drawString("LCK", x + 16, y, 1);
+}
+
+void DisplayUI::drawPending(int x, int y, int w, bool pending) {
+    if (pending) tft.drawFastHLine(x, y, w, COLOR_ORANGE);
+}
+
 void DisplayUI::drawErrorIcon(int x, int y, uint8_t error) {
     tft.fillTriangle(x + 10, y, x, y + 16, x + 20, y + 16, COLOR_RED);
     tft.setTextColor(COLOR_WHITE);
@@ -599,88 +1052,300 @@ void DisplayUI::drawErrorIcon(int x, int y, uint8_t error) {
     tft.drawString("!", x + 10, y + 10, 2);
 }
 
-void DisplayUI::drawGraph(int x, int y, int w, int h, float* data, int count, uint16_t color, const char* label) {
-    tft.fillRect(x, y, w, h, COLOR_BG);
-    tft.drawRect(x, y, w, h, COLOR_DARKGRAY);
+// ========== TRIP SCREEN ==========
+// Summary table plus time-in-zone bars, from the recorder's last summary
+void DisplayUI::drawTripScreen() {
+    uint32_t now = millis();
+    if (!firstDraw && (lastTripVersion == tripDrawnVersion || now - lastTripDraw < TRIP_REDRAW_MS)) return;
+    tripDrawnVersion = lastTripVersion;
+    lastTripDraw = now;
     
-    float minVal = 999999.0f;
-    float maxVal = 0.0f;
-    bool hasData = false;
+    char buf[12];
+    static const uint8_t decimals[TRIP_CHANNELS] = { 1, 1, 0, 0, 0 };
     
-    for (int i = 0; i < count; i++) {
-        if (data[i] > 0) {
-            hasData = true;
-            if (data[i] < minVal) minVal = data[i];
-            if (data[i] > maxVal) maxVal = data[i];
+    if (!bannerUp) {
+        tft.fillRect(200, 2, 120, 26, COLOR_BG);
+        tft.setTextColor(COLOR_WHITE, COLOR_BG);
+        tft.setTextDatum(MR_DATUM);
+        fmtTime(buf, tripView.movingMs / 1000);
+        tft.drawString(buf, 315, 15, 2);
+    }
+    
+    for (uint8_t r = 0; r < TRIP_CHANNELS; r++) {
+        const TripChannelSummary& c = tripView.ch[r];
+        const float values[6] = { c.mean, c.stddev, c.p50, c.p95, c.p99, c.max };
+        int y = 49 + r * 17;
+        int32_t scale = decimals[r] ? 10 : 1;
+        
+        tft.fillRect(40, y, 280, 16, COLOR_BG);
+        tft.setTextColor(r == TRIP_SPEED ? COLOR_WHITE : COLOR_CYAN, COLOR_BG);
+        tft.setTextDatum(TR_DATUM);
+        for (uint8_t i = 0; i < 6; i++) {
+            fmtFixed(buf, lroundf(values[i] * scale), decimals[r]);
+            tft.drawString(buf, 95 + i * 44, y, 2);
         }
     }
     
-    bool isPowerGraph = (color == COLOR_ORANGE);
+    // Bars are shares of moving time, scaled to the busiest zone
+    uint32_t maxSpeedZone = 1, maxPowerZone = 1;
+    for (uint8_t z = 0; z < TRIP_ZONES; z++) {
+        if (tripView.speedZoneMs[z] > maxSpeedZone) maxSpeedZone = tripView.speedZoneMs[z];
+        if (tripView.powerZoneMs[z] > maxPowerZone) maxPowerZone = tripView.powerZoneMs[z];
+    }
+    const int barTop = 157, barH = 68;
+    tft.fillRect(0, barTop, 320, barH, COLOR_BG);
+    for (uint8_t z = 0; z < TRIP_ZONES; z++) {
+        int h = (int)((uint64_t)tripView.speedZoneMs[z] * barH / maxSpeedZone);
+        if (h > 0) tft.fillRect(8 + z * 25, barTop + barH - h, 22, h, COLOR_CYAN);
+        h = (int)((uint64_t)tripView.powerZoneMs[z] * barH / maxPowerZone);
+        if (h > 0) tft.fillRect(168 + z * 25, barTop + barH - h, 22, h, z == 0 ? COLOR_GREEN : COLOR_ORANGE);
+    }
+}
+
+// ========== DIAGNOSTICS SCREEN ==========
+// Heap, allocation and stack figures from the last MemTelemetry sample
+static uint8_t fmtKb(char* buf, uint32_t bytes) {
+    return fmtAppend(buf, fmtFixed(buf, fmtDivRound(bytes * 10, 1024), 1), "K");
+}
+
+void DisplayUI::drawDiagScreen() {
+    if (!mem) return;
+    if (!firstDraw && mem->getVersion() == lastMemVersion) return;
+    lastMemVersion = mem->getVersion();
+    
+    const MemSnapshot& m = mem->snapshot();
+    char buf[16];
     
-    if (!hasData) {
-        minVal = 0;
-        maxVal = isPowerGraph ? 100.0f : 2.0f;
-    } else {
-        maxVal = maxVal * 1.2f;
-        minVal = 0;
+    tft.fillRect(80, 38, 76, 74, COLOR_BG);
+    tft.setTextDatum(TR_DATUM);
+    tft.setTextColor(COLOR_CYAN, COLOR_BG);
+    fmtKb(buf, m.freeHeap);
+    tft.drawString(buf, 152, 40, 2);
+    fmtKb(buf, m.minFreeHeap);
+    tft.drawString(buf, 152, 58, 2);
+    fmtKb(buf, m.largestBlock);
+    tft.drawString(buf, 152, 76, 2);
+    tft.setTextColor(m.fragAlarm ? COLOR_RED : COLOR_GREEN, COLOR_BG);
+    fmtAppend(buf, fmtUint(buf, m.fragPct), "%");
+    tft.drawString(buf, 152, 94, 2);
+    
+    tft.fillRect(160, 50, 160, 64, COLOR_BG);
+    for (uint8_t p = 0; p < MEM_PATHS; p++) {
+        int y = 52 + p * 15;
+        tft.setTextDatum(TL_DATUM);
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        tft.drawString(memPathName((MemPath)p), 165, y, 2);
+        tft.setTextDatum(TR_DATUM);
+        // Anything allocating every cycle on a hot path shows up here
+        tft.setTextColor(m.allocRate[p] ? COLOR_YELLOW : COLOR_GREEN, COLOR_BG);
+        fmtUint(buf, m.allocRate[p]);
+        tft.drawString(buf, 267, y, 2);
+        tft.setTextColor(COLOR_WHITE, COLOR_BG);
+        fmtUint(buf, m.allocs[p]);
+        tft.drawString(buf, 315, y, 2);
+    }
+    
+    // Two columns of tracked tasks
+    tft.fillRect(0, 134, 320, 106, COLOR_BG);
+    for (uint8_t i = 0; i < m.taskCount; i++) {
+        int x = (i & 1) ? 165 : 5;
+        int y = 136 + (i >> 1) * 20;
+        tft.setTextDatum(TL_DATUM);
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        tft.drawString(m.taskName[i], x, y, 2);
+        tft.setTextDatum(TR_DATUM);
+        tft.setTextColor(m.stackFree[i] < 512 ? COLOR_RED : COLOR_WHITE, COLOR_BG);
+        fmtUint(buf, m.stackFree[i]);
+        tft.drawString(buf, x + 150, y, 2);
+    }
+}
+
+// ========== LOOP SCREEN ==========
+// Iteration and cadence figures of the last LoopHealth report window,
+// the poll gap histogram and the most recent stall
+
+void DisplayUI::drawLoopScreen() {
+    if (!health) return;
+    LoopStall stall = health->lastStall();
+    bool fresh = firstDraw || health->getVersion() != lastHealthVersion;
+    if (!fresh && stall.at == lastStallAt) return;
+    
+    char buf[24];
+    if (fresh) {
+        lastHealthVersion = health->getVersion();
+        const LoopWindow& w = health->published();
         
-        if (isPowerGraph) {
-            // Power: round to nice values 50, 100, 200, 500, 1000W
-            if (maxVal < 50) maxVal = 50;
-            else if (maxVal < 100) maxVal = 100;
-            else if (maxVal < 200) maxVal = 200;
-            else if (maxVal < 500) maxVal = 500;
-            else if (maxVal < 1000) maxVal = 1000;
-            else maxVal = ceil(maxVal / 500) * 500;
-        } else {
-            // Current: round to nice values 0.5, 1, 2, 5, 10, 15, 20A
-            if (maxVal < 0.5f) maxVal = 0.5f;
-            else if (maxVal < 1.0f) maxVal = 1.0f;
-            else if (maxVal < 2.0f) maxVal = 2.0f;
-            else if (maxVal < 5.0f) maxVal = 5.0f;
-            else if (maxVal < 10.0f) maxVal = 10.0f;
-            else if (maxVal < 15.0f) maxVal = 15.0f;
-            else if (maxVal < 20.0f) maxVal = 20.0f;
-            else maxVal = ceil(maxVal / 5) * 5;
+        tft.fillRect(85, 49, 235, 85, COLOR_BG);
+        tft.setTextDatum(TR_DATUM);
+        for (uint8_t r = 0; r < LOOP_COUNT + CAD_COUNT; r++) {
+            const LatencyHistogram& h = r < LOOP_COUNT ? w.iter[r] : w.gap[r - LOOP_COUNT];
+            uint32_t budget = r == LOOP_PROTO ? LOOP_PROTO_BUDGET_US : LOOP_RENDER_BUDGET_US;
+            uint32_t v[4] = { h.meanUs(), h.percentile(50), h.percentile(99), h.maxUs() };
+            int y = 49 + r * 17;
+            for (uint8_t c = 0; c < 4; c++) {
+                // Iterations past their budget are the stalls
+                bool over = r < LOOP_COUNT && v[c] > budget;
+                tft.setTextColor(over ? COLOR_RED : COLOR_WHITE, COLOR_BG);
+                fmtDuration(buf, v[c]);
+                tft.drawString(buf, 135 + c * 60, y, 2);
+            }
+        }
+        
+        const LatencyHistogram& poll = w.gap[CAD_POLL];
+        tft.fillRect(100, 142, 220, 8, COLOR_BG);
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        uint8_t len = fmtAppend(buf, fmtUint(buf, poll.count()), " in ");
+        fmtDuration(buf + len, w.ms * 1000);
+        tft.drawString(buf, 315, 142, 1);
+        
+        uint16_t peak = 0;
+        for (uint8_t b = 0; b < LATENCY_BINS; b++) {
+            if (poll.bin(b) > peak) peak = poll.bin(b);
+        }
+        tft.fillRect(LOOP_HIST_X, LOOP_HIST_Y, LATENCY_BINS * 2, LOOP_HIST_H, COLOR_BG);
+        tft.drawFastHLine(LOOP_HIST_X, LOOP_HIST_Y + LOOP_HIST_H, LATENCY_BINS * 2, COLOR_DARKGRAY);
+        for (uint8_t b = 0; b < LATENCY_BINS && peak; b++) {
+            if (poll.bin(b) == 0) continue;
+            int h = (int)((uint32_t)poll.bin(b) * LOOP_HIST_H / peak);
+            if (h < 1) h = 1;
+            tft.fillRect(LOOP_HIST_X + b * 2, LOOP_HIST_Y + LOOP_HIST_H - h, 2, h, COLOR_CYAN);
         }
     }
     
-    float range = maxVal - minVal;
-    if (range < 0.01f) range = 1.0f;
+    lastStallAt = stall.at;
+    tft.fillRect(0, 222, 320, 18, COLOR_BG);
+    tft.setTextDatum(TL_DATUM);
+    if (stall.at == 0) {
+        tft.setTextColor(COLOR_GREEN, COLOR_BG);
+        tft.drawString("No stalls", 5, 222, 2);
+        return;
+    }
+    // "proto 10.2s in link at 0:42"
+    uint8_t len = fmtAppend(buf, 0, loopName((LoopId)stall.loop));
+    buf[len++] = ' ';
+    fmtDuration(buf + len, stall.us);
+    tft.setTextColor(COLOR_RED, COLOR_BG);
+    tft.drawString(buf, 5, 222, 2);
+    len = fmtAppend(buf, 0, "in ");
+    len = fmtAppend(buf, len, loopSectionName((LoopSection)stall.section));
+    len = fmtAppend(buf, len, " at ");
+    fmtTime(buf + len, stall.at / 1000);
+    tft.setTextColor(COLOR_WHITE, COLOR_BG);
+    tft.drawString(buf, 120, 222, 2);
+}
+
+// ========== ALERTS ==========
+uint16_t DisplayUI::alertColor(AlertInput in) const {
+    switch (alerts ? alerts->level(in) : ALERT_NONE) {
+        case ALERT_CRIT: return COLOR_RED;
+        case ALERT_WARN: return COLOR_YELLOW;
+        case ALERT_INFO: return COLOR_CYAN;
+        default:         return COLOR_GREEN;
+    }
+}
+
+// Most severe active alert across the top strip. Drawn after the screen,
+// so it also covers that screen's chrome; clearing it repaints the screen.
+void DisplayUI::drawAlertBanner() {
+    if (!firstDraw && !alertsChanged) return;
+    lastAlertVersion = alerts ? alerts->getVersion() : 0;
+    
+    const AlertRule* rule = alerts ? alerts->top() : nullptr;
+    if (!rule) {
+        if (bannerUp) {
+            bannerUp = false;
+            needsClear = true;
+        }
+        return;
+    }
+    
+    bannerUp = true;
+    uint16_t bg = rule->severity == ALERT_CRIT ? COLOR_RED : (rule->severity == ALERT_WARN ? COLOR_YELLOW : COLOR_CYAN);
+    tft.fillRect(0, 0, 320, ALERT_BANNER_H, bg);
+    tft.setTextColor(rule->severity == ALERT_CRIT ? COLOR_WHITE : COLOR_BG, bg);
+    tft.setTextDatum(MC_DATUM);
+    tft.drawString(rule->text, 160, ALERT_BANNER_H / 2, 4);
+    
+    uint8_t more = alerts->activeCount() - 1;
+    if (more > 0) {
+        char buf[8];
+        fmtUint(buf + fmtAppend(buf, 0, "+"), more);
+        tft.setTextDatum(MR_DATUM);
+        tft.drawString(buf, 315, ALERT_BANNER_H / 2, 2);
+    }
+}
+
+// Per-channel graph scaling: smallest full scale and display divisor
+struct GraphChannelInfo {
+    int32_t minScale;
+    int32_t divisor;
+    uint8_t decimals;
+};
+
+static const GraphChannelInfo GRAPH_CHANNELS[HIST_CHANNELS] = {
+    { 50,   1,   0 },   // power, W
+    { 50,   100, 1 },   // current, 10 mA -> A
+    { 500,  100, 0 },   // speed, 0.01 km/h -> km/h
+    { 1000, 100, 0 },   // voltage, 10 mV -> V
+    { 100,  10,  0 },   // ESC temp, 0.1 C -> C
+    { 100,  10,  0 },   // BMS temp
+    { 10,   1,   0 },   // imbalance, mV
+};
+
+static const char* const TIER_NAMES[TIER_COUNT] = { "1 MIN", "15 MIN", "5 H" };
+
+void DisplayUI::drawGraph(int x, int y, int w, int h, HistoryChannel ch, uint16_t color, const char* label) {
+    tft.fillRect(x, y, w, h, COLOR_BG);
+    tft.drawRect(x, y, w, h, COLOR_DARKGRAY);
+    
+    uint16_t n = history.getSeries(ch, graphTier, graphBuf, HISTORY_MAX_SIZE);
+    const GraphChannelInfo& info = GRAPH_CHANNELS[ch];
+    
+    int32_t maxVal = graphScale(graphBuf, n, info.minScale);
     
     tft.setTextColor(color);
     tft.setTextDatum(TL_DATUM);
     tft.drawString(label, x + 5, y + 3, 1);
     
-    char buf[16];
     tft.setTextColor(COLOR_GRAY);
+    tft.setTextDatum(TC_DATUM);
+    tft.drawString(TIER_NAMES[graphTier], x + w / 2, y + 3, 1);
+    
+    char buf[16];
     tft.setTextDatum(TR_DATUM);
-    if (isPowerGraph) {
-        sprintf(buf, "%.0f", maxVal);
+    if (info.decimals > 0 && maxVal < 10 * info.divisor) {
+        fmtFixed(buf, fmtDivRound(maxVal, info.divisor / 10), 1);
     } else {
-        if (maxVal < 10) sprintf(buf, "%.1f", maxVal);
-        else sprintf(buf, "%.0f", maxVal);
+        fmtInt(buf, fmtDivRound(maxVal, info.divisor));
     }
     tft.drawString(buf, x + w - 3, y + 3, 1);
     
+    if (n == 0) return;
+    
     int graphH = h - 20;
     int graphY = y + 15;
-    float stepX = (float)(w - 10) / count;
+    int plotW = w - 10;
+    uint16_t envColor = tft.alphaBlend(96, color, COLOR_BG);
     
+    int points = graphPoints(n, plotW);
     int prevX = -1, prevY = -1;
     
-    for (int i = 0; i < count; i++) {
-        int idx = (historyIndex + i) % count;
-        float val = data[idx];
-        if (val < minVal) val = minVal;
-        
-        int py = graphY + graphH - (int)((val - minVal) / range * graphH);
-        int px = x + 5 + (int)(i * stepX);
+    for (int j = 0; j < points; j++) {
+        GraphColumn col;
+        if (!graphColumn(graphBuf, n, points, j, col)) {
+            prevX = -1;
+            continue;
+        }
         
-        if (py < graphY) py = graphY;
-        if (py > graphY + graphH) py = graphY + graphH;
+        int px = x + 5 + (int32_t)j * plotW / points;
+        int yHi = graphY + graphPixel(col.hi, maxVal, graphH);
+        int yLo = graphY + graphPixel(col.lo, maxVal, graphH);
+        int py = graphY + graphPixel(col.avg, maxVal, graphH);
         
-        if (prevX >= 0 && val > 0) {
+        if (yLo > yHi) {
+            tft.drawFastVLine(px, yHi, yLo - yHi + 1, envColor);
+        }
+        if (prevX >= 0 && col.avg > 0) {
             tft.drawLine(prevX, prevY, px, py, color);
         }
         
@@ -688,3 +1353,127 @@ void DisplayUI::drawGraph(int x, int y, int w, int h, float* data, int count, ui
         prevY = py;
     }
 }
+
+// ========== FLEET SCREEN ==========
+// One row per scooter, refreshed with the monitor's rate window
+void DisplayUI::drawFleetScreen() {
+    if (!fleet) return;
+    if (!firstDraw && fleet->getVersion() == lastFleetVersion) return;
+    lastFleetVersion = fleet->getVersion();
+    
+    char buf[12];
+    for (uint8_t i = 0; i < fleet->size(); i++) {
+        FleetRow row;
+        fleet->getRow(i, row);
+        bool up = row.state == LinkState::CONNECTED || row.state == LinkState::AUTHENTICATED;
+        int y = 56 + i * 30;
+        
+        tft.fillRect(0, y, 320, 28, COLOR_BG);
+        tft.setTextDatum(TL_DATUM);
+        tft.setTextColor(COLOR_GRAY, COLOR_BG);
+        fmtUint(buf, i);
+        tft.drawString(buf, 5, y + 4, 2);
+        tft.setTextColor(up ? COLOR_CYAN : COLOR_DARKGRAY, COLOR_BG);
+        tft.drawString(row.stateName, 22, y, 1);
+        if (up) {
+            fmtAppend(buf, fmtInt(buf, row.rssi), "dBm");
+            tft.drawString(buf, 22, y + 12, 1);
+        }
+        if (!up) continue;
+        
+        tft.setTextDatum(TR_DATUM);
+        tft.setTextColor(row.batteryLevel < 20 ? COLOR_RED : COLOR_GREEN, COLOR_BG);
+        fmtAppend(buf, fmtUint(buf, row.batteryLevel), "%");
+        tft.drawString(buf, 150, y + 4, 2);
+        tft.setTextColor(COLOR_WHITE, COLOR_BG);
+        fmtAppend(buf, fmtInt(buf, fmtDivRound(row.tempESCRaw, 10)), "C");
+        tft.drawString(buf, 192, y + 4, 2);
+        fmtAppend(buf, fmtInt(buf, fmtDivRound(row.tempBMSX10, 10)), "C");
+        tft.drawString(buf, 234, y + 4, 2);
+        tft.setTextColor(row.errorCode ? COLOR_RED : COLOR_DARKGRAY, COLOR_BG);
+        fmtUint(buf, row.errorCode);
+        tft.drawString(buf, 266, y + 4, 2);
+        tft.setTextColor(COLOR_WHITE, COLOR_BG);
+        fmtFixed(buf, row.framesX10, 1);
+        tft.drawString(buf, 315, y + 4, 2);
+    }
+}
+
+// ========== LAYOUT SCREENS ==========
+// Labels and rules of a loaded layout, into the chrome cache like the
+// built-in screens' chrome
+void DisplayUI::drawLayoutChrome(const LayoutScreen& s, TFT_eSPI& gfx, int16_t yOff) {
+    for (uint8_t i = s.first; i < s.first + s.chromeCount; i++) {
+        const LayoutItem& it = layout->item(i);
+        switch (it.type) {
+            case LW_LABEL:
+                gfx.setTextColor(it.color, COLOR_BG);
+                gfx.setTextDatum(it.datum);
+                gfx.drawString(it.text, it.x, it.y + yOff, it.font);
+                break;
+            case LW_HLINE:
+                gfx.drawFastHLine(it.x, it.y + yOff, it.w, it.color);
+                break;
+            case LW_VLINE:
+                gfx.drawFastVLine(it.x, it.y + yOff, it.h, it.color);
+                break;
+            case LW_FRAME:
+                gfx.drawRect(it.x, it.y + yOff, it.w, it.h, it.color);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// The same redraw-on-change as the hand-written screens, with the boxes,
+// divisors and dirty state worked out at load: a frame where nothing
+// moved only walks the dynamic widgets' values
+void DisplayUI::drawLayoutScreen(const LayoutScreen& s, const ScooterData& data) {
+    LayoutContext ctx;
+    ctx.data = &data;
+    ctx.alerts = alerts;
+    ctx.speedShown = shownSpeed;
+    ctx.tripMaxSpeed = lroundf(tripView.ch[TRIP_SPEED].max);
+    
+    bool graphsDue = firstDraw || history.tierVersion(graphTier) != lastGraphVersion;
+    char buf[LAYOUT_TEXT_MAX];
+    uint16_t color;
+    
+    uint8_t end = s.first + s.chromeCount + s.dynamicCount;
+    for (uint8_t i = s.first + s.chromeCount; i < end; i++) {
+        const LayoutItem& it = layout->item(i);
+        // The banner owns the top strip; clearing it repaints the screen
+        if (bannerUp && it.boxY < ALERT_BANNER_H && it.type != LW_STATUS) continue;
+        
+        switch (it.type) {
+            case LW_VALUE:
+                if (!layout->refresh(i, ctx, firstDraw, buf, color)) break;
+                tft.fillRect(it.boxX, it.boxY, it.boxW, it.boxH, COLOR_BG);
+                tft.setTextColor(color, COLOR_BG);
+                tft.setTextDatum(it.datum);
+                tft.drawString(buf, it.x, it.y, it.font);
+                break;
+            case LW_BAR:
+                if (!layout->refresh(i, ctx, firstDraw, buf, color)) break;
+                {
+                    int16_t fill = layout->barFill(i);
+                    tft.fillRect(it.x, it.y, fill, it.h, color);
+                    tft.fillRect(it.x + fill, it.y, it.w - fill, it.h, COLOR_DARKGRAY);
+                }
+                break;
+            case LW_GRAPH:
+                if (graphsDue) drawGraph(it.x, it.y, it.w, it.h, (HistoryChannel)it.field, it.color, it.text ? it.text : "");
+                break;
+            case LW_STATUS:
+                drawStatusBar(data);
+                break;
+            case LW_CELLS:
+                drawCells(data);
+                break;
+            default:
+                break;
+        }
+    }
+    if (graphsDue) lastGraphVersion = history.tierVersion(graphTier);
+}
@@ -0,0 +1,126 @@
+#include "FastFormat.h"
+
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint32_t POW10[FMT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+static uint8_t countDigits(uint32_t v) {
+    uint8_t n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+// Writes exactly 'digits' characters ending at buf[digits - 1], zero-padded
+static void writeDigits(char* buf, uint32_t v, uint8_t digits) {
+    char* p = buf + digits;
+    while (v >= 100 && p - buf >= 2) {
+        uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--p = DIGIT_PAIRS[pair + 1];
+        *--p = DIGIT_PAIRS[pair];
+    }
+    while (p > buf) {
+        *--p = '0' + (v % 10);
+        v /= 10;
+    }
+}
+
+uint8_t fmtUint(char* buf, uint32_t value) {
+    uint8_t n = countDigits(value);
+    writeDigits(buf, value, n);
+    buf[n] = '\0';
+    return n;
+}
+
+uint8_t fmtInt(char* buf, int32_t value) {
+    if (value < 0) {
+        buf[0] = '-';
+        return fmtUint(buf + 1, 0u - (uint32_t)value) + 1;
+    }
+    return fmtUint(buf, (uint32_t)value);
+}
+
+uint8_t fmtFixed(char* buf, int32_t scaled, uint8_t decimals) {
+    if (decimals == 0) return fmtInt(buf, scaled);
+    if (decimals > FMT_MAX_DECIMALS) decimals = FMT_MAX_DECIMALS;
+
+    uint8_t len = 0;
+    uint32_t mag;
+    if (scaled < 0) {
+        buf[len++] = '-';
+        mag = 0u - (uint32_t)scaled;
+    } else {
+        mag = (uint32_t)scaled;
+    }
+
+    uint32_t whole = mag / POW10[decimals];
+    uint32_t frac = mag - whole * POW10[decimals];
+
+    len += fmtUint(buf + len, whole);
+    buf[len++] = '.';
+    writeDigits(buf + len, frac, decimals);
+    len += decimals;
+    buf[len] = '\0';
+    return len;
+}
+
+static uint8_t padLeft(char* buf, uint8_t len, uint8_t width, char pad) {
+    if (len >= width) return len;
+    uint8_t shift = width - len;
+    for (int i = len; i >= 0; i--) buf[i + shift] = buf[i];
+    for (uint8_t i = 0; i < shift; i++) buf[i] = pad;
+    return width;
+}
+
+uint8_t fmtUintRight(char* buf, uint32_t value, uint8_t width, char pad) {
+    return padLeft(buf, fmtUint(buf, value), width, pad);
+}
+
+uint8_t fmtFixedRight(char* buf, int32_t scaled, uint8_t decimals, uint8_t width, char pad) {
+    return padLeft(buf, fmtFixed(buf, scaled, decimals), width, pad);
+}
+
+uint8_t fmtTime(char* buf, uint32_t seconds) {
+    uint32_t h = seconds / 3600;
+    uint32_t rem = seconds - h * 3600;
+    uint32_t m = rem / 60;
+    uint32_t s = rem - m * 60;
+
+    uint8_t len = 0;
+    if (h > 0) {
+        len = fmtUint(buf, h);
+        buf[len++] = ':';
+    }
+    writeDigits(buf + len, m, 2);
+    len += 2;
+    buf[len++] = ':';
+    writeDigits(buf + len, s, 2);
+    len += 2;
+    buf[len] = '\0';
+    return len;
+}
+
+uint8_t fmtDuration(char* buf, uint32_t us) {
+    if (us < 1000) return fmtAppend(buf, fmtUint(buf, us), "us");
+    if (us < 999950) return fmtAppend(buf, fmtFixed(buf, (int32_t)((us + 50) / 100), 1), "ms");
+    return fmtAppend(buf, fmtFixed(buf, (int32_t)((us + 50000) / 100000), 1), "s");
+}
+
+uint8_t fmtAppend(char* buf, uint8_t len, const char* suffix) {
+    while (*suffix) buf[len++] = *suffix++;
+    buf[len] = '\0';
+    return len;
+}
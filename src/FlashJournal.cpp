@@ -0,0 +1,279 @@
+#include "FlashJournal.h"
+
+#define MOVING_SPEED_RAW    500
+
+FlashJournal::FlashJournal()
+    : mounted(false), version(0), riding(false), rideStart(0), lastMoving(0),
+      lastCheckpoint(0), lastEnergy(0), energyMwMs(0), ringHead(0), ringCount(0), lastRingSample(0),
+      lastError(0), escHot(false), bmsHot(false), task(nullptr), summaryPending(false),
+      faultPending(false), faultsMissed(0) {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    memset(&header, 0, sizeof(header));
+    memset(rides, 0, sizeof(rides));
+    memset(&ride, 0, sizeof(ride));
+}
+
+bool FlashJournal::begin() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("[JRN] LittleFS mount failed");
+        return false;
+    }
+    if (!LittleFS.exists(JOURNAL_FAULT_DIR)) LittleFS.mkdir(JOURNAL_FAULT_DIR);
+
+    loadIndex();
+    mounted = true;
+
+    xTaskCreatePinnedToCore(taskEntry, "journal", 4096, this, 1, &task, 1);
+    Serial.printf("[JRN] %lu rides, %lu faults\n",
+                  (unsigned long)(header.nextRide - 1), (unsigned long)header.nextFault);
+    return true;
+}
+
+bool FlashJournal::loadIndex() {
+    File f = LittleFS.open(JOURNAL_INDEX_PATH, FILE_READ);
+    if (f) {
+        bool ok = f.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                  header.magic == JOURNAL_MAGIC && header.version == JOURNAL_VERSION &&
+                  header.slots == JOURNAL_RIDE_SLOTS &&
+                  f.read((uint8_t*)rides, sizeof(rides)) == sizeof(rides);
+        f.close();
+        if (ok) return true;
+        Serial.println("[JRN] Index unreadable, starting fresh");
+    }
+
+    header.magic = JOURNAL_MAGIC;
+    header.version = JOURNAL_VERSION;
+    header.slots = JOURNAL_RIDE_SLOTS;
+    header.nextRide = 1;
+    header.nextFault = 0;
+    memset(rides, 0, sizeof(rides));
+    return false;
+}
+
+uint8_t FlashJournal::recentRides(RideSummary* out, uint8_t max) const {
+    uint8_t n = 0;
+    portENTER_CRITICAL(&lock);
+    for (uint32_t seq = header.nextRide - 1; seq > 0 && n < max; seq--) {
+        const RideSummary& r = rides[seq % JOURNAL_RIDE_SLOTS];
+        if (r.seq != seq) break;
+        out[n++] = r;
+    }
+    portEXIT_CRITICAL(&lock);
+    return n;
+}
+
+// ========== Ride tracking ==========
+
+void FlashJournal::startRide(const ScooterData& data, uint32_t now) {
+    memset(&ride, 0, sizeof(ride));
+    ride.startOdometer = data.odometer;
+    ride.startBattery = data.batteryLevel;
+    ride.minCellMv = 0xFFFF;
+    rideStart = now;
+    lastCheckpoint = now;
+    lastEnergy = now;
+    energyMwMs = 0;
+    riding = true;
+}
+
+void FlashJournal::trackRide(const ScooterData& data, uint32_t now) {
+    // Odometer is polled slowly and may still be zero at ride start
+    if (ride.startOdometer == 0) ride.startOdometer = data.odometer;
+    if (data.odometer > ride.startOdometer) ride.distance = data.odometer - ride.startOdometer;
+
+    ride.duration = (lastMoving - rideStart) / 1000;
+    ride.endBattery = data.batteryLevel;
+
+    int32_t energyWh10 = (int32_t)(energyMwMs / 360000000LL);
+    ride.energyWh10 = energyWh10 < 0 ? 0 : (energyWh10 > 0xFFFF ? 0xFFFF : energyWh10);
+
+    if (data.speedRaw > ride.maxSpeedRaw) ride.maxSpeedRaw = data.speedRaw;
+    if (data.currentRaw > ride.maxCurrentRaw) ride.maxCurrentRaw = data.currentRaw;
+    if (data.tempESCRaw > ride.maxTempESCRaw) ride.maxTempESCRaw = data.tempESCRaw;
+    int8_t bms = data.tempBMS1 > data.tempBMS2 ? data.tempBMS1 : data.tempBMS2;
+    if (bms > ride.maxTempBMS) ride.maxTempBMS = bms;
+    if (data.minCellMv > 0 && data.minCellMv < ride.minCellMv) ride.minCellMv = data.minCellMv;
+
+    if (data.errorCode != 0) {
+        for (uint8_t i = 0; i < sizeof(ride.errors); i++) {
+            if (ride.errors[i] == data.errorCode) break;
+            if (ride.errors[i] == 0) {
+                ride.errors[i] = data.errorCode;
+                break;
+            }
+        }
+    }
+}
+
+void FlashJournal::finishRide() {
+    riding = false;
+    // Short hops are not worth a flash write unless already checkpointed
+    if (ride.seq == 0 && ride.distance < JOURNAL_MIN_RIDE_M) return;
+    queueSummary();
+    Serial.printf("[JRN] Ride %lu: %lu m, %u s, %u.%u Wh\n", (unsigned long)ride.seq,
+                  (unsigned long)ride.distance, ride.duration,
+                  ride.energyWh10 / 10, ride.energyWh10 % 10);
+}
+
+void FlashJournal::queueSummary() {
+    portENTER_CRITICAL(&lock);
+    if (ride.seq == 0) ride.seq = header.nextRide++;
+    rides[ride.seq % JOURNAL_RIDE_SLOTS] = ride;
+    summaryPending = true;
+    version++;
+    portEXIT_CRITICAL(&lock);
+    if (task) xTaskNotifyGive(task);
+}
+
+// ========== Fault capture ==========
+
+void FlashJournal::captureFault(FaultReason reason, const ScooterData& data) {
+    if (faultPending) {
+        faultsMissed++;
+        Serial.printf("[JRN] Fault skipped, writer busy (%lu missed)\n", (unsigned long)faultsMissed);
+        return;
+    }
+
+    // Unroll the ring oldest first
+    uint16_t start = (ringHead + JOURNAL_FAULT_SAMPLES - ringCount) % JOURNAL_FAULT_SAMPLES;
+    for (uint16_t i = 0; i < ringCount; i++) {
+        faultBuf[i] = ring[(start + i) % JOURNAL_FAULT_SAMPLES];
+    }
+
+    portENTER_CRITICAL(&lock);
+    faultHeader.magic = JOURNAL_MAGIC;
+    faultHeader.seq = header.nextFault++;
+    faultHeader.rideSeq = ride.seq;
+    faultHeader.odometer = data.odometer;
+    faultHeader.reason = reason;
+    faultHeader.errorCode = data.errorCode;
+    faultHeader.samples = ringCount;
+    faultPending = true;
+    summaryPending = true;      // persists nextFault
+    portEXIT_CRITICAL(&lock);
+
+    Serial.printf("[JRN] Fault %lu captured (reason %u, error %u)\n",
+                  (unsigned long)faultHeader.seq, reason, data.errorCode);
+    if (task) xTaskNotifyGive(task);
+}
+
+void FlashJournal::checkFaults(const ScooterData& data, uint32_t now) {
+    int8_t bms = data.tempBMS1 > data.tempBMS2 ? data.tempBMS1 : data.tempBMS2;
+
+    if (now - lastRingSample >= JOURNAL_FAULT_PERIOD_MS) {
+        lastRingSample = now;
+        FaultSample& s = ring[ringHead];
+        s.time = now;
+        s.speedRaw = data.speedRaw;
+        s.currentRaw = data.currentRaw;
+        s.voltageRaw = data.voltageRaw;
+        s.tempESCRaw = data.tempESCRaw;
+        s.minCellMv = data.minCellMv;
+        s.tempBMS = bms;
+        s.errorCode = data.errorCode;
+        ringHead = (ringHead + 1) % JOURNAL_FAULT_SAMPLES;
+        if (ringCount < JOURNAL_FAULT_SAMPLES) ringCount++;
+    }
+
+    if (data.errorCode != 0 && data.errorCode != lastError) {
+        captureFault(FAULT_ERROR_CODE, data);
+    }
+    lastError = data.errorCode;
+
+    if (!escHot && data.tempESCRaw >= JOURNAL_TEMP_ESC_TRIP) {
+        escHot = true;
+        captureFault(FAULT_TEMP_ESC, data);
+    } else if (escHot && data.tempESCRaw < JOURNAL_TEMP_ESC_TRIP - JOURNAL_TEMP_ESC_HYST) {
+        escHot = false;
+    }
+
+    if (!bmsHot && bms >= JOURNAL_TEMP_BMS_TRIP) {
+        bmsHot = true;
+        captureFault(FAULT_TEMP_BMS, data);
+    } else if (bmsHot && bms < JOURNAL_TEMP_BMS_TRIP - JOURNAL_TEMP_BMS_HYST) {
+        bmsHot = false;
+    }
+}
+
+void FlashJournal::update(const ScooterData& data, uint32_t now) {
+    if (!mounted) return;
+
+    if (riding && !data.connected) {
+        finishRide();
+        return;
+    }
+    if (!data.connected) return;
+
+    checkFaults(data, now);
+
+    bool moving = data.speedRaw > MOVING_SPEED_RAW;
+    if (moving) {
+        if (!riding) startRide(data, now);
+        lastMoving = now;
+    }
+    if (!riding) return;
+
+    // Signed, so regen comes off the total: 10 mV * 10 mA = 0.1 mW
+    energyMwMs += (int64_t)data.voltageRaw * data.currentRaw * (now - lastEnergy) / 10;
+    lastEnergy = now;
+
+    trackRide(data, now);
+
+    if (now - lastMoving >= JOURNAL_RIDE_END_MS) {
+        finishRide();
+    } else if (now - lastCheckpoint >= JOURNAL_CHECKPOINT_MS) {
+        lastCheckpoint = now;
+        queueSummary();
+    }
+}
+
+// ========== Writer task ==========
+
+void FlashJournal::taskEntry(void* arg) {
+    static_cast<FlashJournal*>(arg)->run();
+}
+
+void FlashJournal::writeSummary() {
+    static RideSummary copy[JOURNAL_RIDE_SLOTS];
+    JournalHeader h;
+
+    portENTER_CRITICAL(&lock);
+    summaryPending = false;
+    h = header;
+    memcpy(copy, rides, sizeof(copy));
+    portEXIT_CRITICAL(&lock);
+
+    // LittleFS commits the file atomically on close
+    File f = LittleFS.open(JOURNAL_INDEX_PATH, FILE_WRITE);
+    if (!f) {
+        Serial.println("[JRN] Index write failed");
+        return;
+    }
+    f.write((const uint8_t*)&h, sizeof(h));
+    f.write((const uint8_t*)copy, sizeof(copy));
+    f.close();
+}
+
+void FlashJournal::writeFault() {
+    char path[24];
+    snprintf(path, sizeof(path), JOURNAL_FAULT_DIR "/F%u.bin",
+             (unsigned)(faultHeader.seq % JOURNAL_FAULT_FILES));
+
+    File f = LittleFS.open(path, FILE_WRITE);
+    if (f) {
+        f.write((const uint8_t*)&faultHeader, sizeof(faultHeader));
+        f.write((const uint8_t*)faultBuf, faultHeader.samples * sizeof(FaultSample));
+        f.close();
+    } else {
+        Serial.printf("[JRN] Cannot write %s\n", path);
+    }
+    faultPending = false;
+}
+
+void FlashJournal::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (faultPending) writeFault();
+        if (summaryPending) writeSummary();
+    }
+}
@@ -0,0 +1,81 @@
+#include "FleetMonitor.h"
+
+FleetMonitor::FleetMonitor() : count(0), lastRate(0), lastReport(0), version(0) {
+    for (uint8_t i = 0; i < FLEET_MAX_SCOOTERS; i++) {
+        clients[i] = nullptr;
+        lastFrames[i] = 0;
+        lastGrants[i] = 0;
+        framesX10[i] = 0;
+        requestsX10[i] = 0;
+    }
+}
+
+bool FleetMonitor::add(M365Client* client) {
+    if (count >= FLEET_MAX_SCOOTERS) return false;
+    client->setPaced(true);
+    clients[count++] = client;
+    return true;
+}
+
+void FleetMonitor::begin() {
+    for (uint8_t i = 0; i < count; i++) clients[i]->begin();
+    lastRate = lastReport = millis();
+    Serial.printf("[FLEET] %u scooters, one request per %d ms shared\n", count, FLEET_GRANT_MS);
+}
+
+void FleetMonitor::update() {
+    uint32_t now = millis();
+    uint32_t ready = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        clients[i]->update();
+        if (clients[i]->wantsSend(now)) ready |= 1UL << i;
+    }
+
+    int8_t pick = scheduler.next(now, ready);
+    if (pick >= 0) clients[pick]->sendNext(now);
+
+    if (now - lastRate >= FLEET_RATE_MS) updateRates(now);
+    if (now - lastReport >= FLEET_REPORT_MS) {
+        lastReport = now;
+        report();
+    }
+}
+
+// Achieved refresh per scooter: decoded frames and requests granted
+void FleetMonitor::updateRates(uint32_t now) {
+    uint32_t elapsed = now - lastRate;
+    lastRate = now;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t frames = clients[i]->getSampleCount();
+        uint32_t grants = scheduler.getGrants(i);
+        framesX10[i] = (uint16_t)((frames - lastFrames[i]) * 10000UL / elapsed);
+        requestsX10[i] = (uint16_t)((grants - lastGrants[i]) * 10000UL / elapsed);
+        lastFrames[i] = frames;
+        lastGrants[i] = grants;
+    }
+    version++;
+}
+
+void FleetMonitor::getRow(uint8_t i, FleetRow& out) const {
+    ScooterData d = clients[i]->getData();
+    out.state = clients[i]->getState();
+    out.stateName = clients[i]->getStateName();
+    out.rssi = d.rssi;
+    out.batteryLevel = d.batteryLevel;
+    out.tempESCRaw = d.tempESCRaw;
+    out.tempBMSX10 = d.tempBMSAvgX10();
+    out.errorCode = d.errorCode;
+    out.framesX10 = framesX10[i];
+}
+
+void FleetMonitor::report() const {
+    uint8_t up = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (clients[i]->isConnected()) up++;
+    }
+    Serial.printf("[FLEET] %u/%u connected\n", up, count);
+    for (uint8_t i = 0; i < count; i++) {
+        Serial.printf("[FLEET]   #%u %s: %u.%u req/s, %u.%u frames/s\n", i, clients[i]->getStateName(),
+                      requestsX10[i] / 10, requestsX10[i] % 10, framesX10[i] / 10, framesX10[i] % 10);
+    }
+}
@@ -0,0 +1,21 @@
+#include "FleetScheduler.h"
+
+FleetScheduler::FleetScheduler() : lastGrant(0), tickMs(FLEET_TICK_MS), cursor(FLEET_MAX_SCOOTERS - 1) {
+    for (uint8_t i = 0; i < FLEET_MAX_SCOOTERS; i++) grants[i] = 0;
+}
+
+int8_t FleetScheduler::next(uint32_t now, uint32_t ready) {
+    if (!ready || now - lastGrant < tickMs) return -1;
+
+    // Start after the last link served
+    for (uint8_t k = 1; k <= FLEET_MAX_SCOOTERS; k++) {
+        uint8_t i = (cursor + k) % FLEET_MAX_SCOOTERS;
+        if (ready & (1UL << i)) {
+            cursor = i;
+            lastGrant = now;
+            grants[i]++;
+            return i;
+        }
+    }
+    return -1;
+}
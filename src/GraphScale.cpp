@@ -0,0 +1,40 @@
+#include "GraphScale.h"
+
+int32_t niceScale(int32_t v, int32_t minScale) {
+    if (v < minScale) return minScale;
+    int32_t decade = 1;
+    while (decade <= v / 10) decade *= 10;
+    if (v <= decade) return decade;
+    if (v <= 2 * decade) return 2 * decade;
+    if (v <= 5 * decade) return 5 * decade;
+    return 10 * decade;
+}
+
+int32_t graphScale(const HistoryBucket* buckets, uint16_t n, int32_t minScale) {
+    int32_t maxVal = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        if (buckets[i].count > 0 && buckets[i].max > maxVal) maxVal = buckets[i].max;
+    }
+    return niceScale(maxVal + maxVal / 5, minScale);
+}
+
+bool graphColumn(const HistoryBucket* buckets, uint16_t n, uint16_t points, uint16_t j, GraphColumn& col) {
+    uint16_t i0 = (uint32_t)j * n / points;
+    uint16_t i1 = (uint32_t)(j + 1) * n / points;
+    
+    int32_t lo = 32767, hi = -32768, sum = 0, cnt = 0;
+    for (uint16_t i = i0; i < i1; i++) {
+        if (buckets[i].count == 0) continue;
+        if (buckets[i].min < lo) lo = buckets[i].min;
+        if (buckets[i].max > hi) hi = buckets[i].max;
+        sum += buckets[i].avg;
+        cnt++;
+    }
+    if (cnt == 0) return false;
+    
+    col.lo = lo < 0 ? 0 : lo;
+    col.hi = hi;
+    col.avg = sum / cnt;
+    if (col.avg < 0) col.avg = 0;
+    return true;
+}
@@ -0,0 +1,155 @@
+#include "HistoryStore.h"
+
+HistoryStore::HistoryStore() {
+    reset();
+}
+
+void HistoryStore::reset() {
+    for (int t = 0; t < TIER_COUNT; t++) {
+        head[t] = 0;
+        count[t] = 0;
+        version[t] = 0;
+    }
+    for (int c = 0; c < HIST_CHANNELS; c++) {
+        acc10s[c].count = 0;
+        acc1min[c].count = 0;
+    }
+    lastRawSample = 0;
+    bucket10sStart = 0;
+    bucket1minStart = 0;
+    started = false;
+}
+
+static inline int16_t clamp16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+void HistoryStore::extract(const ScooterData& data, int16_t* values) {
+    values[HIST_POWER] = data.power;
+    values[HIST_CURRENT] = data.currentRaw < 0 ? clamp16(-(int32_t)data.currentRaw) : data.currentRaw;
+    values[HIST_SPEED] = data.speedRaw / 10;
+    values[HIST_VOLTAGE] = clamp16(data.voltageRaw);
+    values[HIST_TEMP_ESC] = data.tempESCRaw;
+    values[HIST_TEMP_BMS] = data.tempBMSAvgX10();
+    values[HIST_IMBALANCE] = clamp16(data.cellImbalanceMv());
+}
+
+void HistoryStore::accumulate(Accumulator& acc, int16_t value) {
+    if (acc.count == 0) {
+        acc.min = value;
+        acc.max = value;
+        acc.sum = 0;
+    } else {
+        if (value < acc.min) acc.min = value;
+        if (value > acc.max) acc.max = value;
+    }
+    acc.sum += value;
+    if (acc.count < 0xFFFF) acc.count++;
+}
+
+HistoryBucket HistoryStore::closeBucket(Accumulator& acc) {
+    HistoryBucket b;
+    if (acc.count == 0) {
+        b.min = b.max = b.avg = 0;
+        b.count = 0;
+    } else {
+        b.min = acc.min;
+        b.max = acc.max;
+        b.avg = (int16_t)(acc.sum / acc.count);
+        b.count = acc.count;
+    }
+    acc.count = 0;
+    return b;
+}
+
+void HistoryStore::addSample(const ScooterData& data, uint32_t now) {
+    int16_t values[HIST_CHANNELS];
+    extract(data, values);
+
+    if (!started) {
+        lastRawSample = now - HISTORY_RAW_PERIOD_MS;
+        bucket10sStart = now;
+        bucket1minStart = now;
+        started = true;
+    }
+
+    for (int c = 0; c < HIST_CHANNELS; c++) {
+        accumulate(acc10s[c], values[c]);
+        accumulate(acc1min[c], values[c]);
+    }
+
+    if (now - lastRawSample >= HISTORY_RAW_PERIOD_MS) {
+        for (int c = 0; c < HIST_CHANNELS; c++) {
+            raw[c][head[TIER_RAW]] = values[c];
+        }
+        head[TIER_RAW] = (head[TIER_RAW] + 1) % HISTORY_RAW_SIZE;
+        if (count[TIER_RAW] < HISTORY_RAW_SIZE) count[TIER_RAW]++;
+        version[TIER_RAW]++;
+        lastRawSample += HISTORY_RAW_PERIOD_MS;
+        // Don't try to catch up after a long stall
+        if (now - lastRawSample >= HISTORY_RAW_PERIOD_MS) lastRawSample = now;
+    }
+
+    if (now - bucket10sStart >= 10000) {
+        for (int c = 0; c < HIST_CHANNELS; c++) {
+            tier10s[c][head[TIER_10S]] = closeBucket(acc10s[c]);
+        }
+        head[TIER_10S] = (head[TIER_10S] + 1) % HISTORY_10S_SIZE;
+        if (count[TIER_10S] < HISTORY_10S_SIZE) count[TIER_10S]++;
+        version[TIER_10S]++;
+        bucket10sStart = now;
+    }
+
+    if (now - bucket1minStart >= 60000) {
+        for (int c = 0; c < HIST_CHANNELS; c++) {
+            tier1min[c][head[TIER_1MIN]] = closeBucket(acc1min[c]);
+        }
+        head[TIER_1MIN] = (head[TIER_1MIN] + 1) % HISTORY_1MIN_SIZE;
+        if (count[TIER_1MIN] < HISTORY_1MIN_SIZE) count[TIER_1MIN]++;
+        version[TIER_1MIN]++;
+        bucket1minStart = now;
+    }
+}
+
+uint16_t HistoryStore::tierCapacity(HistoryTier tier) const {
+    switch (tier) {
+        case TIER_RAW:  return HISTORY_RAW_SIZE;
+        case TIER_10S:  return HISTORY_10S_SIZE;
+        case TIER_1MIN: return HISTORY_1MIN_SIZE;
+        default:        return 0;
+    }
+}
+
+uint32_t HistoryStore::tierPeriodMs(HistoryTier tier) const {
+    switch (tier) {
+        case TIER_RAW:  return HISTORY_RAW_PERIOD_MS;
+        case TIER_10S:  return 10000;
+        case TIER_1MIN: return 60000;
+        default:        return 0;
+    }
+}
+
+uint16_t HistoryStore::getSeries(HistoryChannel ch, HistoryTier tier, HistoryBucket* out, uint16_t maxCount) const {
+    uint16_t cap = tierCapacity(tier);
+    uint16_t n = count[tier];
+    if (n > maxCount) n = maxCount;
+    uint16_t start = (head[tier] + cap - n) % cap;
+
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t idx = (start + i) % cap;
+        if (tier == TIER_RAW) {
+            int16_t v = raw[ch][idx];
+            out[i].min = v;
+            out[i].max = v;
+            out[i].avg = v;
+            out[i].count = 1;
+        } else if (tier == TIER_10S) {
+            out[i] = tier10s[ch][idx];
+        } else {
+            out[i] = tier1min[ch][idx];
+        }
+    }
+    return n;
+}
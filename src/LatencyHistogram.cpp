@@ -0,0 +1,57 @@
+#include "LatencyHistogram.h"
+#include <string.h>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    memset(bins, 0, sizeof(bins));
+    n = 0;
+    peak = 0;
+    sumUs = 0;
+}
+
+// Octave from the leading bit, sub-bin from the next three
+uint8_t LatencyHistogram::binOf(uint32_t us) {
+    if (us < (1UL << LATENCY_MIN_SHIFT)) return 0;
+    uint8_t octave = 31 - __builtin_clz(us);
+    uint32_t b = ((uint32_t)(octave - LATENCY_MIN_SHIFT) << LATENCY_SUB_BITS) |
+                 ((us >> (octave - LATENCY_SUB_BITS)) & ((1 << LATENCY_SUB_BITS) - 1));
+    return b < LATENCY_BINS ? b : LATENCY_BINS - 1;
+}
+
+uint32_t LatencyHistogram::binLow(uint8_t b) {
+    uint8_t octave = LATENCY_MIN_SHIFT + (b >> LATENCY_SUB_BITS);
+    uint32_t sub = b & ((1 << LATENCY_SUB_BITS) - 1);
+    return ((1UL << LATENCY_SUB_BITS) | sub) << (octave - LATENCY_SUB_BITS);
+}
+
+void LatencyHistogram::add(uint32_t us) {
+    uint16_t& c = bins[binOf(us)];
+    if (c != 0xFFFF) c++;
+    n++;
+    sumUs += us;
+    if (us > peak) peak = us;
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t pct) const {
+    if (n == 0) return 0;
+    uint32_t total = 0;
+    for (uint8_t b = 0; b < LATENCY_BINS; b++) total += bins[b];
+
+    uint32_t rank = (total * pct + 99) / 100;
+    if (rank == 0) rank = 1;
+    uint32_t below = 0;
+    for (uint8_t b = 0; b < LATENCY_BINS; b++) {
+        if (below + bins[b] < rank) {
+            below += bins[b];
+            continue;
+        }
+        uint32_t low = b == 0 ? 0 : binLow(b);
+        uint32_t high = b == LATENCY_BINS - 1 ? peak : binLow(b + 1);
+        uint32_t at = low + (uint32_t)((uint64_t)(high - low) * (rank - below) / bins[b]);
+        return at < peak ? at : peak;
+    }
+    return peak;
+}
@@ -0,0 +1,120 @@
+#include "LogEncoder.h"
+#include <string.h>
+
+static inline void put16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+// Standard CRC-32 (zlib/IEEE), nibble table to stay small in flash
+uint32_t logCrc32(const uint8_t* data, size_t len) {
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+void logWriteSchema(uint8_t* block) {
+    memset(block, 0, LOG_BLOCK_SIZE);
+    memcpy(block, "M365LOG", 8);
+    put16(block + 8, LOG_FORMAT_VERSION);
+    put16(block + 10, LOG_BLOCK_SIZE);
+    block[12] = TF_COUNT;
+
+    uint16_t pos = 13;
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        const TelemetryField& f = TELEMETRY_FIELDS[i];
+        uint8_t nameLen = strlen(f.name);
+        uint8_t unitLen = strlen(f.unit);
+        put16(block + pos, f.scale);
+        pos += 2;
+        block[pos++] = nameLen;
+        memcpy(block + pos, f.name, nameLen);
+        pos += nameLen;
+        block[pos++] = unitLen;
+        memcpy(block + pos, f.unit, unitLen);
+        pos += unitLen;
+    }
+
+    put32(block + LOG_BLOCK_SIZE - 4, logCrc32(block, LOG_BLOCK_SIZE - 4));
+}
+
+LogEncoder::LogEncoder() : block(nullptr), pos(0), count(0), baseTime(0), lastTime(0) {
+}
+
+void LogEncoder::begin(uint8_t* buf, uint32_t seq, uint32_t time) {
+    block = buf;
+    put32(block, LOG_BLOCK_MAGIC);
+    put32(block + 4, seq);
+    put32(block + 8, time);
+    pos = LOG_HEADER_BYTES;
+    count = 0;
+    baseTime = time;
+    lastTime = time;
+    memset(prev, 0, sizeof(prev));
+}
+
+static inline uint16_t putVarint(uint8_t* p, uint16_t n, uint64_t v) {
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+bool LogEncoder::append(const ScooterData& data, uint32_t time) {
+    if (!block) return false;
+
+    int32_t values[TF_COUNT];
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        values[i] = telemetryValue(data, i);
+        if (values[i] != prev[i]) mask |= 1ULL << i;
+    }
+
+    // Encoded aside, then taken only if it fits: reserving LOG_MAX_RECORD
+    // up front would close a sector block with a third of it unused
+    uint8_t rec[LOG_MAX_RECORD];
+    uint16_t n = putVarint(rec, 0, time - lastTime);
+    n = putVarint(rec, n, mask);
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        if (!(mask & (1ULL << i))) continue;
+        int32_t d = values[i] - prev[i];
+        n = putVarint(rec, n, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+    }
+    if (pos + n > LOG_BLOCK_SIZE - LOG_TRAILER_BYTES) return false;
+
+    memcpy(block + pos, rec, n);
+    pos += n;
+    memcpy(prev, values, sizeof(prev));
+    lastTime = time;
+    count++;
+    return true;
+}
+
+void LogEncoder::seal() {
+    if (!block) return;
+    memset(block + pos, 0, LOG_BLOCK_SIZE - LOG_TRAILER_BYTES - pos);
+    uint8_t* trailer = block + LOG_BLOCK_SIZE - LOG_TRAILER_BYTES;
+    put16(trailer, pos - LOG_HEADER_BYTES);
+    put16(trailer + 2, count);
+    put32(trailer + 4, logCrc32(block, LOG_BLOCK_SIZE - 4));
+    block = nullptr;
+}
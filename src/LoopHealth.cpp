@@ -0,0 +1,169 @@
+#include "LoopHealth.h"
+#include "FastFormat.h"
+
+static const char* const LOOP_NAMES[LOOP_COUNT] = { "proto", "render" };
+static const char* const SECTION_NAMES[SEC_COUNT] = {
+    "link", "log", "touch", "power", "alerts", "draw", "clear", "status", "misc", "report"
+};
+static const char* const CADENCE_NAMES[CAD_COUNT] = { "update", "poll", "frame" };
+static const uint32_t BUDGET_US[LOOP_COUNT] = { LOOP_PROTO_BUDGET_US, LOOP_RENDER_BUDGET_US };
+
+static void clearWindow(LoopWindow& w) {
+    for (uint8_t l = 0; l < LOOP_COUNT; l++) w.iter[l].reset();
+    for (uint8_t c = 0; c < CAD_COUNT; c++) w.gap[c].reset();
+    memset(w.sectionMaxUs, 0, sizeof(w.sectionMaxUs));
+    memset(w.stalls, 0, sizeof(w.stalls));
+    memset(w.stallSections, 0, sizeof(w.stallSections));
+    w.ms = 0;
+}
+
+LoopHealth::LoopHealth() : windowStart(0), version(0) {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    memset(runs, 0, sizeof(runs));
+    memset(lastEvent, 0, sizeof(lastEvent));
+    memset(&stall, 0, sizeof(stall));
+    clearWindow(live);
+    clearWindow(shown);
+}
+
+// ========== Iterations ==========
+// Section times collect in the task's own Run; the shared window is
+// only locked once, at the end of an iteration
+
+void LoopHealth::closeSection(Run& r, uint32_t now) {
+    r.spent[r.section] += now - r.sectionStart;
+    r.sectionStart = now;
+}
+
+void LoopHealth::begin(LoopId loop, LoopSection first) {
+    Run& r = runs[loop];
+    r.start = micros();
+    r.sectionStart = r.start;
+    r.section = first;
+    memset(r.spent, 0, sizeof(r.spent));
+}
+
+void LoopHealth::section(LoopId loop, LoopSection s) {
+    Run& r = runs[loop];
+    closeSection(r, micros());
+    r.section = s;
+}
+
+void LoopHealth::end(LoopId loop) {
+    Run& r = runs[loop];
+    uint32_t now = micros();
+    closeSection(r, now);
+    uint32_t us = now - r.start;
+
+    uint8_t worst = 0;
+    for (uint8_t s = 1; s < SEC_COUNT; s++) {
+        if (r.spent[s] > r.spent[worst]) worst = s;
+    }
+    bool stalled = us > BUDGET_US[loop];
+
+    portENTER_CRITICAL(&lock);
+    live.iter[loop].add(us);
+    for (uint8_t s = 0; s < SEC_COUNT; s++) {
+        if (r.spent[s] > live.sectionMaxUs[loop][s]) live.sectionMaxUs[loop][s] = r.spent[s];
+    }
+    if (stalled) {
+        if (live.stalls[loop] != 0xFFFF) live.stalls[loop]++;
+        if (live.stallSections[worst] != 0xFFFF) live.stallSections[worst]++;
+        stall.loop = loop;
+        stall.section = worst;
+        stall.us = us;
+        stall.sectionUs = r.spent[worst];
+        stall.at = millis() | 1;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (!stalled) return;
+    // After the iteration is timed, so the print isn't charged to it
+    uint32_t ms = millis();
+    if (r.lastPrint != 0 && ms - r.lastPrint < LOOP_STALL_PRINT_MS) {
+        r.suppressed++;
+        return;
+    }
+    char total[12], part[12];
+    fmtDuration(total, us);
+    fmtDuration(part, r.spent[worst]);
+    Serial.printf("[LOOP] %s stall: %s, %s of it in %s (+%lu more)\n", LOOP_NAMES[loop], total, part,
+                  SECTION_NAMES[worst], (unsigned long)r.suppressed);
+    r.lastPrint = ms | 1;
+    r.suppressed = 0;
+}
+
+// ========== Cadence ==========
+
+void LoopHealth::cadence(LoopCadence ch) {
+    uint32_t now = micros() | 1;
+    uint32_t prev = lastEvent[ch];
+    lastEvent[ch] = now;
+    if (prev == 0) return;
+    portENTER_CRITICAL(&lock);
+    live.gap[ch].add(now - prev);
+    portEXIT_CRITICAL(&lock);
+}
+
+void LoopHealth::breakCadence(LoopCadence ch) {
+    lastEvent[ch] = 0;
+}
+
+// ========== Reporting ==========
+
+LoopStall LoopHealth::lastStall() {
+    portENTER_CRITICAL(&lock);
+    LoopStall s = stall;
+    portEXIT_CRITICAL(&lock);
+    return s;
+}
+
+static void printHistogram(const char* what, const char* name, const LatencyHistogram& h) {
+    char mean[12], p50[12], p99[12], peak[12];
+    fmtDuration(mean, h.meanUs());
+    fmtDuration(p50, h.percentile(50));
+    fmtDuration(p99, h.percentile(99));
+    fmtDuration(peak, h.maxUs());
+    Serial.printf("[LOOP] %-4s %-6s n %-5lu mean %-8s p50 %-8s p99 %-8s max %s\n", what, name,
+                  (unsigned long)h.count(), mean, p50, p99, peak);
+}
+
+void LoopHealth::report() {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&lock);
+    shown = live;
+    shown.ms = now - windowStart;
+    clearWindow(live);
+    windowStart = now;
+    portEXIT_CRITICAL(&lock);
+    version++;
+
+    for (uint8_t l = 0; l < LOOP_COUNT; l++) printHistogram("iter", LOOP_NAMES[l], shown.iter[l]);
+    for (uint8_t c = 0; c < CAD_COUNT; c++) printHistogram("gap", CADENCE_NAMES[c], shown.gap[c]);
+
+    for (uint8_t l = 0; l < LOOP_COUNT; l++) {
+        if (shown.stalls[l] == 0) continue;
+        // Worst single stretch per section, to tell one long block from many short ones
+        Serial.printf("[LOOP] %s: %u stalls over %lu us; worst per section:", LOOP_NAMES[l], shown.stalls[l],
+                      (unsigned long)BUDGET_US[l]);
+        for (uint8_t s = 0; s < SEC_COUNT; s++) {
+            if (shown.sectionMaxUs[l][s] == 0) continue;
+            char buf[12];
+            fmtDuration(buf, shown.sectionMaxUs[l][s]);
+            Serial.printf(" %s %s", SECTION_NAMES[s], buf);
+        }
+        Serial.println();
+    }
+}
+
+const char* loopName(LoopId loop) {
+    return LOOP_NAMES[loop];
+}
+
+const char* loopSectionName(LoopSection s) {
+    return SECTION_NAMES[s];
+}
+
+const char* loopCadenceName(LoopCadence ch) {
+    return CADENCE_NAMES[ch];
+}
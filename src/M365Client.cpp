@@ -0,0 +1,321 @@
+#include "M365Client.h"
+
+M365Client::M365Client(M365Transport& link) : transport(link), scooterData(protocol.data()) {
+    state = LinkState::DISCONNECTED;
+    connectionStartTime = 0;
+    paced = false;
+    captureCount = 0;
+    replay = nullptr;
+    pendingReplay = nullptr;
+    replayRealtime = true;
+    replayStart = 0;
+    replayBusyUs = 0;
+    speedSample.speedRaw = 0;
+    speedSample.at = 0;
+    speedSample.seq = 0;
+    speedSeen = 0;
+    speedAt = 0;
+    snapshotLock = portMUX_INITIALIZER_UNLOCKED;
+    controlLock = portMUX_INITIALIZER_UNLOCKED;
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        requestedSet[t] = false;
+        requestedSteps[t] = 0;
+    }
+    pendingMask = 0;
+    cellReadLen = CELLS_MAX * 2;
+    commands.setHook(onControl, this);
+}
+
+void M365Client::begin() {
+    transport.begin();
+    setPollInterval(POLL_INTERVAL_DEFAULT);
+}
+
+void M365Client::setPollInterval(uint16_t ms) {
+    uint16_t scaled = ms / transport.pollDivisor();
+    poller.setInterval(scaled ? scaled : 1);
+}
+
+ScooterData M365Client::getData() const {
+    portENTER_CRITICAL(&snapshotLock);
+    ScooterData copy = snapshot;
+    portEXIT_CRITICAL(&snapshotLock);
+    return copy;
+}
+
+SpeedSample M365Client::getSpeedSample() const {
+    portENTER_CRITICAL(&snapshotLock);
+    SpeedSample copy = speedSample;
+    portEXIT_CRITICAL(&snapshotLock);
+    return copy;
+}
+
+void M365Client::publish() {
+    portENTER_CRITICAL(&snapshotLock);
+    snapshot = scooterData;
+    speedSample.speedRaw = scooterData.speedRaw;
+    speedSample.at = speedAt;
+    speedSample.seq = speedSeen;
+    portEXIT_CRITICAL(&snapshotLock);
+}
+
+// The display filter wants the time each speed reply arrived, not when
+// it was published
+void M365Client::stampSpeed(uint32_t at) {
+    uint32_t seen = protocol.getSpeedSamples();
+    if (seen == speedSeen) return;
+    speedSeen = seen;
+    speedAt = at;
+}
+
+void M365Client::drainRx() {
+    uint8_t buf[M365_RX_CHUNK];
+    uint32_t time;
+    size_t n;
+    while ((n = transport.receive(buf, sizeof(buf), time)) > 0) {
+        for (uint8_t i = 0; i < captureCount; i++) {
+            captures[i]->capture(time, buf, n);
+        }
+        protocol.processResponse(buf, n);
+        stampSpeed(time);
+    }
+}
+
+// drainRx() may be walking the list: the sink is in place before the
+// count that exposes it
+void M365Client::addCapture(CaptureSink* sink) {
+    uint8_t n = captureCount;
+    if (n >= M365_MAX_CAPTURES) return;
+    captures[n] = sink;
+    __sync_synchronize();
+    captureCount = n + 1;
+}
+
+// Replay stands in for the transport: the capture drives the parser.
+// Taken over by update() on the protocol task.
+void M365Client::startReplay(M365Replay* r, bool realtime) {
+    replayRealtime = realtime;
+    pendingReplay = r;
+}
+
+void M365Client::updateReplay(unsigned long now) {
+    if (!replay) return;
+    
+    uint32_t start = micros();
+    int32_t fed = replay->feed(now - replayStart, replayRealtime, replayRealtime ? 0xFFFF : 256);
+    replayBusyUs += micros() - start;
+    stampSpeed(now);
+    if (fed >= 0) return;
+    
+    uint32_t spent = now - replayStart;
+    Serial.printf("[M365] Replay done: %lu notifications, %lu frames, %lu fields in %lu ms\n",
+                  (unsigned long)replay->getRecords(), (unsigned long)protocol.getFrames(),
+                  (unsigned long)protocol.getFields(), (unsigned long)spent);
+    // Fast mode is throttled to 256 records per tick, so its rate is taken
+    // over the time spent parsing, not the wall time
+    if (!replayRealtime && replayBusyUs > 0) {
+        Serial.printf("[M365] Replay rate: %lu frames/s, %lu fields/s (%lu us parsing)\n",
+                      (unsigned long)((uint64_t)protocol.getFrames() * 1000000 / replayBusyUs),
+                      (unsigned long)((uint64_t)protocol.getFields() * 1000000 / replayBusyUs),
+                      (unsigned long)replayBusyUs);
+    }
+    replay = nullptr;
+}
+
+// ========== Controls ==========
+
+bool M365Client::control(ControlType type, int8_t value, uint32_t at) {
+    if (state != LinkState::CONNECTED && state != LinkState::AUTHENTICATED) return false;
+    
+    portENTER_CRITICAL(&controlLock);
+    if (!requestedSet[type] && requestedSteps[type] == 0) requestedAt[type] = at;
+    if (value == CTL_STEP) {
+        requestedSteps[type]++;
+    } else {
+        requestedSet[type] = true;
+        requestedValue[type] = value;
+        requestedSteps[type] = 0;
+    }
+    portEXIT_CRITICAL(&controlLock);
+    return true;
+}
+
+void M365Client::takeControls() {
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        portENTER_CRITICAL(&controlLock);
+        bool set = requestedSet[t];
+        uint8_t value = requestedValue[t];
+        uint8_t steps = requestedSteps[t];
+        uint32_t at = requestedAt[t];
+        requestedSet[t] = false;
+        requestedSteps[t] = 0;
+        portEXIT_CRITICAL(&controlLock);
+        
+        ControlType type = (ControlType)t;
+        bool ok = true;
+        if (set) ok = commands.request(type, value, scooterData, at);
+        while (ok && steps--) ok = commands.request(type, CTL_STEP, scooterData, at);
+        if (!ok) Serial.printf("[CTL] %s refused while moving\n", CONTROL_SPECS[t].name);
+    }
+}
+
+bool M365Client::sendControl(const ControlFrame& frame) {
+    if (frame.cmd == CMD_READ) return sendCommand(ADDR_ESC, CMD_READ, frame.reg, frame.value);
+    
+    uint8_t packet[M365_WRITE_LEN];
+    M365Protocol::buildWrite(packet, ADDR_ESC, frame.reg, frame.value);
+    return transport.send(packet, M365_WRITE_LEN);
+}
+
+void M365Client::onControl(void* ctx, ControlType type, uint8_t value, bool ok, uint32_t latencyMs) {
+    if (ok) {
+        Serial.printf("[CTL] %s -> %u confirmed %lu ms after the tap\n", CONTROL_SPECS[type].name,
+                      value, (unsigned long)latencyMs);
+    } else {
+        Serial.printf("[CTL] %s -> %u not confirmed after %d tries\n", CONTROL_SPECS[type].name,
+                      value, CTL_MAX_TRIES);
+    }
+}
+
+bool M365Client::sendCommand(uint8_t addr, uint8_t cmd, uint8_t reg, uint8_t len) {
+    if (!transport.canSend()) return false;
+    
+    uint8_t packet[M365_COMMAND_LEN];
+    M365Protocol::buildCommand(packet, addr, cmd, reg, len);
+    return transport.send(packet, M365_COMMAND_LEN);
+}
+
+bool M365Client::requestESCData() {
+    return sendCommand(ADDR_ESC, CMD_READ, REG_ESC_BATTERY, 0x14);
+}
+
+bool M365Client::requestBMSData() {
+    return sendCommand(ADDR_BMS, CMD_READ, REG_BMS_CURRENT, 0x04);
+}
+
+bool M365Client::requestCellVoltages() {
+    return sendCommand(ADDR_BMS, CMD_READ, REG_BMS_CELLS, protocol.getCellReadLen());
+}
+
+void M365Client::update() {
+    unsigned long now = millis();
+    
+    if (pendingReplay) {
+        replay = pendingReplay;
+        pendingReplay = nullptr;
+        replayStart = now;
+        replayBusyUs = 0;
+        state = LinkState::REPLAY;
+        scooterData.connected = true;
+        connectionStartTime = now;
+        Serial.printf("[M365] Replaying capture (%s)\n", replayRealtime ? "real time" : "fast");
+    }
+    
+    if (state == LinkState::REPLAY) {
+        updateReplay(now);
+        publish();
+        return;
+    }
+    
+    LinkState link = transport.update(now);
+    bool wasUp = isConnected();
+    state = link;
+    
+    if (isConnected() && !wasUp) {
+        connectionStartTime = now;
+        poller.reset(now);
+        protocol.reset();
+        scooterData.connected = true;
+        Serial.printf("[M365] Link up (%s)\n", transport.name());
+    } else if (!isConnected() && wasUp) {
+        scooterData.connected = false;
+        // Whatever was in flight is void on the next link
+        commands.reset();
+        portENTER_CRITICAL(&controlLock);
+        for (uint8_t t = 0; t < CTL_COUNT; t++) {
+            requestedSet[t] = false;
+            requestedSteps[t] = 0;
+        }
+        portEXIT_CRITICAL(&controlLock);
+        Serial.printf("[M365] Link down (%s)\n", transport.name());
+    }
+    
+    drainRx();
+    
+    // Reads go full width until a reply has sized the pack
+    uint8_t cellLen = protocol.getCellReadLen();
+    if (cellLen != cellReadLen) {
+        cellReadLen = cellLen;
+        poller.setCellReadLen(cellLen);
+        if (protocol.getCellPack()) Serial.printf("[M365] %uS pack\n", protocol.getCellPack()->cells);
+    }
+    
+    if (isConnected()) {
+        scooterData.rideTime = (now - connectionStartTime) / 1000;
+        scooterData.rssi = transport.getRSSI();
+        
+        if (scooterData.remainingRangeRaw == 0) {
+            scooterData.remainingRangeRaw = scooterData.batteryLevel * 45;
+        }
+        
+        takeControls();
+        commands.check(scooterData, now);
+    }
+    
+    if (!paced) sendNext(now);
+    
+    uint8_t pending = 0;
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        if (commands.busy((ControlType)t)) pending |= 1 << t;
+    }
+    pendingMask = pending;
+    
+    publish();
+}
+
+bool M365Client::wantsSend(uint32_t now) {
+    if (state == LinkState::REPLAY || !transport.canSend()) return false;
+    return (isConnected() && commands.ready(now)) || poller.isDue(now);
+}
+
+// Writes and their read-backs go ahead of the poll schedule, which just
+// picks up again on the next pass. The UART link also polls while
+// nothing answers yet.
+bool M365Client::sendNext(uint32_t now) {
+    M365Request req;
+    ControlFrame ctl;
+    if (isConnected() && transport.canSend() && commands.next(now, ctl)) {
+        return sendControl(ctl);
+    }
+    if (transport.canSend() && poller.due(now, req)) {
+        return sendCommand(req.addr, CMD_READ, req.reg, req.len);
+    }
+    return false;
+}
+
+const char* M365Client::getStateName() const {
+    switch (state) {
+        case LinkState::DISCONNECTED: return "DISCONNECTED";
+        case LinkState::SCANNING:     return "SCANNING...";
+        case LinkState::CONNECTING:   return "CONNECTING...";
+        case LinkState::CONNECTED:    return "CONNECTED";
+        case LinkState::AUTHENTICATED: return "READY";
+        case LinkState::REPLAY:       return "REPLAY";
+        default: return "UNKNOWN";
+    }
+}
+
+void M365Client::report() const {
+    Serial.printf("[M365] %s: %lu frames, %lu bad, %lu rx dropped\n", transport.name(),
+                  (unsigned long)protocol.getFrames(), (unsigned long)protocol.getBadFrames(),
+                  (unsigned long)transport.getRxDropped());
+    for (uint8_t t = 0; t < CTL_COUNT; t++) {
+        const ControlStats& st = commands.getStats((ControlType)t);
+        if (st.acked + st.failed == 0) continue;
+        Serial.printf("[CTL] %s: %lu ok (avg %lu ms, max %lu ms), %lu failed, %lu coalesced\n",
+                      CONTROL_SPECS[t].name, (unsigned long)st.acked,
+                      (unsigned long)(st.acked ? st.totalMs / st.acked : 0), (unsigned long)st.maxMs,
+                      (unsigned long)st.failed, (unsigned long)st.coalesced);
+    }
+    transport.report();
+}
@@ -0,0 +1,68 @@
+#include "M365Poller.h"
+
+static const M365Request SCHEDULE[POLL_SLOTS] = {
+    { ADDR_ESC, REG_ESC_SPEED,      2 },
+    { ADDR_ESC, REG_ESC_BATTERY,    1 },
+    { ADDR_BMS, REG_BMS_CURRENT,    4 },
+    { ADDR_ESC, REG_ESC_MODE,       1 },
+    { ADDR_ESC, REG_ESC_SPEED,      2 },
+    { ADDR_ESC, REG_ESC_ODOMETER,   4 },
+    { ADDR_ESC, REG_ESC_TRIP,       2 },
+    { ADDR_ESC, REG_ESC_FRAME_TEMP, 2 },
+    { ADDR_ESC, REG_ESC_SPEED,      2 },
+    { ADDR_BMS, REG_BMS_TEMP,       2 },
+    { ADDR_ESC, REG_ESC_RANGE,      2 },
+    { ADDR_BMS, REG_BMS_CAPACITY,   2 },
+    { ADDR_ESC, REG_ESC_SPEED,      2 },
+    { ADDR_BMS, REG_BMS_CELLS,      0 },    // setCellReadLen()
+    { ADDR_ESC, REG_ESC_AVERAGE,    2 },
+    { ADDR_ESC, REG_ESC_ERROR,      1 },
+};
+
+// Slow movers take turns in slot 14, one per cycle. The switch states
+// are here so changes made on the scooter itself show up too.
+#define POLL_SLOW_SLOT  14
+#define POLL_SLOW_COUNT 5
+static const M365Request SLOW[POLL_SLOW_COUNT] = {
+    { ADDR_ESC, REG_ESC_AVERAGE,    2 },
+    { ADDR_BMS, REG_BMS_FULL_CAP,   2 },
+    { ADDR_ESC, REG_ESC_STATUS,     2 },
+    { ADDR_ESC, REG_ESC_LIGHT,      2 },
+    { ADDR_ESC, REG_ESC_CRUISE,     2 },
+};
+
+// Parked: just enough to notice the ride starting
+static const M365Request REDUCED[2] = {
+    { ADDR_ESC, REG_ESC_SPEED,      2 },
+    { ADDR_BMS, REG_BMS_CURRENT,    4 },
+};
+
+M365Poller::M365Poller()
+    : lastPoll(0), intervalMs(POLL_INTERVAL_DEFAULT), index(0), reduced(false),
+      cellLen(CELLS_MAX * 2), polls(0) {
+}
+
+void M365Poller::reset(uint32_t now) {
+    lastPoll = now;
+    index = 0;
+}
+
+bool M365Poller::due(uint32_t now, M365Request& req) {
+    if (now - lastPoll < intervalMs) return false;
+
+    // Keep the cadence on the interval grid rather than on whenever the
+    // caller happened to look, but don't burst after a long stall
+    lastPoll = (now - lastPoll >= 2u * intervalMs) ? now : lastPoll + intervalMs;
+
+    if (reduced) {
+        req = REDUCED[index & 1];
+    } else if (index % POLL_SLOTS == POLL_SLOW_SLOT) {
+        req = SLOW[(index / POLL_SLOTS) % POLL_SLOW_COUNT];
+    } else {
+        req = SCHEDULE[index % POLL_SLOTS];
+        if (req.len == 0) req.len = cellLen;
+    }
+    index++;
+    polls++;
+    return true;
+}
@@ -0,0 +1,241 @@
+#include "M365Protocol.h"
+#include <string.h>
+
+M365Protocol::M365Protocol()
+    : rxIndex(0), frames(0), fields(0), badFrames(0), speedSamples(0), cellPack(nullptr) {
+}
+
+uint16_t M365Protocol::checksum(const uint8_t* data, uint8_t len) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return (sum ^ 0xFFFF);
+}
+
+uint8_t M365Protocol::buildCommand(uint8_t* packet, uint8_t addr, uint8_t cmd, uint8_t reg, uint8_t len) {
+    packet[0] = 0x55;
+    packet[1] = 0xAA;
+    packet[2] = 0x03;
+    packet[3] = addr;
+    packet[4] = cmd;
+    packet[5] = reg;
+    packet[6] = len;
+    
+    uint16_t crc = checksum(&packet[2], 5);
+    packet[7] = crc & 0xFF;
+    packet[8] = (crc >> 8) & 0xFF;
+    return M365_COMMAND_LEN;
+}
+
+uint8_t M365Protocol::buildWrite(uint8_t* packet, uint8_t addr, uint8_t reg, uint16_t value) {
+    packet[0] = 0x55;
+    packet[1] = 0xAA;
+    packet[2] = 0x04;
+    packet[3] = addr;
+    packet[4] = CMD_WRITE;
+    packet[5] = reg;
+    packet[6] = value & 0xFF;
+    packet[7] = (value >> 8) & 0xFF;
+    
+    uint16_t crc = checksum(&packet[2], 6);
+    packet[8] = crc & 0xFF;
+    packet[9] = (crc >> 8) & 0xFF;
+    return M365_WRITE_LEN;
+}
+
+void M365Protocol::processResponse(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (rxIndex == 0 && data[i] != 0x55) continue;
+        if (rxIndex == 1 && data[i] != 0xAA) { rxIndex = 0; continue; }
+        
+        rxBuffer[rxIndex++] = data[i];
+        
+        if (rxIndex >= 4) {
+            uint8_t pktLen = rxBuffer[2];
+            if (rxIndex >= pktLen + 4 + 2) {
+                uint8_t addr = rxBuffer[3];
+                uint8_t reg = (pktLen > 1) ? rxBuffer[5] : 0;
+                uint16_t sum = rxBuffer[pktLen + 4] | (rxBuffer[pktLen + 5] << 8);
+                
+                // A corrupted length or payload must not reach the fields
+                if (sum != checksum(&rxBuffer[2], pktLen + 2)) {
+                    badFrames++;
+                } else {
+                    if (addr == ADDR_ESC_REPLY) {
+                        fields += parseESCResponse(reg, &rxBuffer[6], pktLen - 2);
+                    } else if (addr == ADDR_BMS_REPLY) {
+                        fields += parseBMSResponse(reg, &rxBuffer[6], pktLen - 2);
+                    }
+                    frames++;
+                }
+                
+                rxIndex = 0;
+            }
+        }
+        
+        if (rxIndex >= sizeof(rxBuffer)) rxIndex = 0;
+    }
+}
+
+// Both parsers return the number of ScooterData fields they updated
+
+uint8_t M365Protocol::parseESCResponse(uint8_t reg, const uint8_t* data, uint8_t len) {
+    switch (reg) {
+        case REG_ESC_SPEED:
+            if (len >= 2) {
+                int16_t raw = data[0] | (data[1] << 8);
+                scooterData.speedRaw = raw < 0 ? -raw : raw;
+                speedSamples++;
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_BATTERY:
+            scooterData.batteryLevel = data[0];
+            return 1;
+            
+        case REG_ESC_MODE:
+            {
+                uint8_t rawMode = data[0] & 0x03;
+                if (rawMode == 0) scooterData.mode = 1;
+                else if (rawMode == 1) scooterData.mode = 0;
+                else scooterData.mode = 2;
+            }
+            return 1;
+            
+        case REG_ESC_ODOMETER:
+            if (len >= 4) {
+                scooterData.odometer = data[0] | (data[1] << 8) | 
+                                       (data[2] << 16) | (data[3] << 24);
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_TRIP:
+            if (len >= 2) {
+                scooterData.tripDistance = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_RANGE:
+            if (len >= 2) {
+                scooterData.remainingRangeRaw = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_AVERAGE:
+            if (len >= 2) {
+                scooterData.averageSpeedRaw = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_UPTIME:
+            if (len >= 4) {
+                scooterData.rideTime = data[0] | (data[1] << 8) | 
+                                       (data[2] << 16) | (data[3] << 24);
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_FRAME_TEMP:
+            if (len >= 2) {
+                scooterData.tempESCRaw = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_ERROR:
+            scooterData.errorCode = data[0];
+            return 1;
+            
+        case 0x21:
+            if (len >= 1) {
+                scooterData.headlight = (data[0] & 0x01) != 0;
+                return 1;
+            }
+            break;
+            
+        case REG_ESC_STATUS:
+            scooterData.isLocked = (data[0] & ESC_STATUS_LOCKED) != 0;
+            return 1;
+            
+        case REG_ESC_LIGHT:
+            scooterData.headlight = data[0] == 2;
+            scooterData.taillight = data[0] == 2;
+            return 2;
+            
+        case REG_ESC_CRUISE:
+            scooterData.cruise = data[0] == 1;
+            return 1;
+    }
+    return 0;
+}
+
+uint8_t M365Protocol::parseBMSResponse(uint8_t reg, const uint8_t* data, uint8_t len) {
+    if (reg == REG_BMS_CURRENT && len >= 4) {
+        int16_t rawCurr = data[0] | (data[1] << 8);
+        scooterData.currentRaw = rawCurr;
+        scooterData.voltageRaw = data[2] | (data[3] << 8);
+        
+        int32_t absCurr = rawCurr < 0 ? -rawCurr : rawCurr;
+        scooterData.power = (int32_t)scooterData.voltageRaw * absCurr / 10000;
+        return 3;
+    }
+    
+    switch (reg) {
+        case REG_BMS_VOLTAGE:
+            if (len >= 2) {
+                scooterData.voltageRaw = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+            
+        case REG_BMS_CURRENT:
+            if (len >= 2) {
+                scooterData.currentRaw = data[0] | (data[1] << 8);
+                scooterData.power = (int32_t)scooterData.voltageRaw * scooterData.currentRaw / 10000;
+                return 2;
+            }
+            break;
+            
+        case REG_BMS_TEMP:
+            if (len >= 2) {
+                scooterData.tempBMS1 = (int16_t)data[0] - 20;
+                scooterData.tempBMS2 = (int16_t)data[1] - 20;
+                return 2;
+            }
+            break;
+            
+        case REG_BMS_CELLS:
+            // The first populated reply (reads stay full width until then)
+            // picks the pack; from then on its fixed-length decoder runs
+            // without looking at the count. A BMS still answering zeros
+            // after connecting says nothing about the pack.
+            if (!cellPack) {
+                uint8_t present = cellsPresent(data, len);
+                if (present == 0) return 0;
+                cellPack = &cellPackFor(present);
+                memset(scooterData.cellMv, 0, sizeof(scooterData.cellMv));
+            }
+            return cellPack->decode(scooterData, data, len);
+            
+        case REG_BMS_CAPACITY:
+            if (len >= 2) {
+                scooterData.capacityRemain = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+            
+        case REG_BMS_FULL_CAP:
+            if (len >= 2) {
+                scooterData.capacityFull = data[0] | (data[1] << 8);
+                return 1;
+            }
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "M365Replay.h"
+
+M365Replay::M365Replay(M365Protocol& p)
+    : protocol(p), read(nullptr), ctx(nullptr), pending(false), ended(true),
+      pendingTime(0), pendingLen(0), started(false), firstTime(0), lastTime(0),
+      records(0), bytes(0) {
+}
+
+bool M365Replay::begin(ReadFn fn, void* c) {
+    read = fn;
+    ctx = c;
+    pending = false;
+    started = false;
+    records = 0;
+    bytes = 0;
+
+    uint8_t header[CAPTURE_HEADER_BYTES];
+    ended = read(ctx, header, sizeof(header)) != sizeof(header) || !captureCheckHeader(header);
+    protocol.reset();
+    return !ended;
+}
+
+bool M365Replay::readNext() {
+    uint8_t rec[CAPTURE_RECORD_BYTES];
+    if (read(ctx, rec, sizeof(rec)) != sizeof(rec)) return false;
+
+    pendingTime = rec[0] | (rec[1] << 8) | ((uint32_t)rec[2] << 16) | ((uint32_t)rec[3] << 24);
+    pendingLen = rec[4] | (rec[5] << 8);
+    if (pendingLen > CAPTURE_MAX_PAYLOAD) return false;
+    if (read(ctx, payload, pendingLen) != pendingLen) return false;
+
+    if (!started) {
+        firstTime = pendingTime;
+        started = true;
+    }
+    return true;
+}
+
+int32_t M365Replay::feed(uint32_t elapsedMs, bool realtime, uint16_t maxRecords) {
+    int32_t fed = 0;
+    while (fed < maxRecords) {
+        if (!pending) {
+            if (ended || !readNext()) {
+                ended = true;
+                return fed > 0 ? fed : -1;
+            }
+            pending = true;
+        }
+        if (realtime && pendingTime - firstTime > elapsedMs) break;
+
+        protocol.processResponse(payload, pendingLen);
+        lastTime = pendingTime;
+        records++;
+        bytes += pendingLen;
+        pending = false;
+        fed++;
+    }
+    return fed;
+}
@@ -0,0 +1,142 @@
+#include "MemTelemetry.h"
+#include <new>
+
+volatile uint32_t MemTelemetry::pathAllocs[MEM_PATHS] = { 0 };
+volatile uint32_t MemTelemetry::totalAllocs = 0;
+TaskHandle_t volatile MemTelemetry::pathOwner[MEM_PATHS] = { nullptr };
+
+static const char* const PATH_NAMES[MEM_PATHS] = { "proto", "log", "render", "scan" };
+static const char* const TASK_NAMES[] = MEM_TASK_NAMES;
+
+static_assert(sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]) <= MEM_MAX_TASKS, "Too many tracked tasks");
+
+// ========== Allocation hook ==========
+// Every C++ allocation in the image (ours, NimBLE's, std::string's) goes
+// through here. Counters are bumped with atomics: this runs on both cores
+// and must not take a lock inside the allocator path.
+
+void MemTelemetry::countAlloc() {
+    __atomic_add_fetch(&totalAllocs, 1, __ATOMIC_RELAXED);
+    // No scope is ever open before the scheduler runs
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (!self) return;
+    for (uint8_t p = 0; p < MEM_PATHS; p++) {
+        if (pathOwner[p] == self) __atomic_add_fetch(&pathAllocs[p], 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void* countedAlloc(size_t size) {
+    MemTelemetry::countAlloc();
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) abort();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) abort();
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+MemScope::MemScope(MemPath p) : path(p) {
+    prev = MemTelemetry::pathOwner[path];
+    MemTelemetry::pathOwner[path] = xTaskGetCurrentTaskHandle();
+}
+
+MemScope::~MemScope() {
+    MemTelemetry::pathOwner[path] = prev;
+}
+
+// ========== Sampling ==========
+
+MemTelemetry::MemTelemetry() : lastSample(0), lastReport(0), version(0) {
+    memset(&snap, 0, sizeof(snap));
+    for (uint8_t i = 0; i < MEM_MAX_TASKS; i++) handles[i] = nullptr;
+    for (uint8_t p = 0; p < MEM_PATHS; p++) lastAllocs[p] = 0;
+}
+
+// Tasks start at different times (SD and BLE ones may never exist), so
+// names are looked up until found
+void MemTelemetry::resolveTasks() {
+    uint8_t n = sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]);
+    snap.taskCount = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        if (!handles[i]) handles[i] = xTaskGetHandle(TASK_NAMES[i]);
+        if (!handles[i]) continue;
+        snap.taskName[snap.taskCount] = TASK_NAMES[i];
+        snap.stackFree[snap.taskCount] = uxTaskGetStackHighWaterMark(handles[i]);
+        snap.taskCount++;
+    }
+}
+
+void MemTelemetry::update(uint32_t now) {
+    if (lastSample != 0 && now - lastSample < MEM_SAMPLE_MS) return;
+    uint32_t elapsed = lastSample ? now - lastSample : MEM_SAMPLE_MS;
+    lastSample = now;
+
+    snap.freeHeap = ESP.getFreeHeap();
+    snap.minFreeHeap = ESP.getMinFreeHeap();
+    snap.largestBlock = ESP.getMaxAllocHeap();
+    snap.fragPct = snap.freeHeap ? 100 - (uint8_t)((uint64_t)snap.largestBlock * 100 / snap.freeHeap) : 0;
+
+    bool alarm = snap.fragAlarm;
+    if (!alarm && snap.freeHeap < MEM_FRAG_MIN_FREE && snap.fragPct >= MEM_FRAG_ALARM_PCT) alarm = true;
+    else if (alarm && (snap.freeHeap >= MEM_FRAG_MIN_FREE || snap.fragPct <= MEM_FRAG_CLEAR_PCT)) alarm = false;
+    if (alarm != snap.fragAlarm) {
+        Serial.printf("[MEM] Fragmentation alarm %s: %lu free, largest block %lu (%u%%)\n",
+                      alarm ? "raised" : "cleared", (unsigned long)snap.freeHeap,
+                      (unsigned long)snap.largestBlock, snap.fragPct);
+        snap.fragAlarm = alarm;
+    }
+
+    resolveTasks();
+
+    for (uint8_t p = 0; p < MEM_PATHS; p++) {
+        uint32_t n = pathAllocs[p];
+        snap.allocs[p] = n;
+        snap.allocRate[p] = (uint32_t)((uint64_t)(n - lastAllocs[p]) * 1000 / elapsed);
+        lastAllocs[p] = n;
+    }
+    snap.allocsTotal = totalAllocs;
+    version++;
+
+    if (now - lastReport >= MEM_REPORT_MS) {
+        lastReport = now;
+        report();
+    }
+}
+
+void MemTelemetry::report() const {
+    Serial.printf("[MEM] free %lu  min %lu  largest %lu  frag %u%%%s  allocs %lu\n",
+                  (unsigned long)snap.freeHeap, (unsigned long)snap.minFreeHeap,
+                  (unsigned long)snap.largestBlock, snap.fragPct, snap.fragAlarm ? " ALARM" : "",
+                  (unsigned long)snap.allocsTotal);
+    for (uint8_t p = 0; p < MEM_PATHS; p++) {
+        Serial.printf("[MEM]   path %-6s allocs %lu (%lu/s)\n", PATH_NAMES[p],
+                      (unsigned long)snap.allocs[p], (unsigned long)snap.allocRate[p]);
+    }
+    for (uint8_t i = 0; i < snap.taskCount; i++) {
+        Serial.printf("[MEM]   task %-11s stack free %lu\n", snap.taskName[i], (unsigned long)snap.stackFree[i]);
+    }
+}
+
+const char* memPathName(MemPath path) {
+    return PATH_NAMES[path];
+}
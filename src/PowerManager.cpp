@@ -0,0 +1,152 @@
+#include "PowerManager.h"
+#include "DisplayUI.h"
+#include "M365Client.h"
+#include "TouchInput.h"
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#endif
+
+// BLE needs the APB at 80 MHz, so 80 is the floor while connected
+static const PowerProfile PROFILES[POWER_MODE_COUNT] = {
+    // name      bl   MHz  poll  conn  reduced  ui
+    { "ACTIVE",  255, 240, 100,  12,   false,   50   },
+    { "IDLE",    64,  160, 250,  40,   false,   250  },
+    { "PARKED",  8,   80,  400,  160,  true,    1000 },
+};
+
+PowerManager::PowerManager(DisplayUI& display, M365Client& m365)
+    : ui(display), client(m365), mode(POWER_ACTIVE), stillSince(0),
+      lastAccount(0), lastReport(0), lightSleep(false), pendingWaitUs(0) {
+    for (int m = 0; m < POWER_MODE_COUNT; m++) {
+        modeMs[m] = 0;
+        waitMsTotal[m] = 0;
+    }
+}
+
+void PowerManager::begin() {
+    uint32_t now = millis();
+    stillSince = now;
+    lastAccount = now;
+    lastReport = now;
+
+#if CONFIG_PM_ENABLE
+    // PENIRQ pulls low on touch; let it end a light sleep
+    gpio_wakeup_enable((gpio_num_t)TOUCH_IRQ, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    lightSleep = true;
+#endif
+
+    apply(PROFILES[mode]);
+    Serial.printf("[PWR] Init, light sleep %s\n", lightSleep ? "on" : "off");
+}
+
+const PowerProfile& PowerManager::profile() const {
+    return PROFILES[mode];
+}
+
+void PowerManager::apply(const PowerProfile& p) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t cfg;
+    cfg.max_freq_mhz = p.cpuMhz;
+    cfg.min_freq_mhz = 80;
+    cfg.light_sleep_enable = (mode != POWER_ACTIVE);
+    esp_pm_configure(&cfg);
+#else
+    setCpuFrequencyMhz(p.cpuMhz);
+#endif
+    ui.setBacklight(p.backlight);
+    client.setPollInterval(p.pollMs);
+    client.setReducedPolling(p.reducedPolling);
+    client.setConnInterval(p.connInterval);
+}
+
+void PowerManager::account(uint32_t now) {
+    modeMs[mode] += now - lastAccount;
+    lastAccount = now;
+    waitMsTotal[mode] += pendingWaitUs / 1000;
+    pendingWaitUs %= 1000;
+}
+
+void PowerManager::accountWait(uint32_t us) {
+    pendingWaitUs += us;
+}
+
+void PowerManager::setMode(PowerMode next, uint32_t now) {
+    if (next == mode) return;
+    account(now);
+    Serial.printf("[PWR] %s -> %s\n", PROFILES[mode].name, PROFILES[next].name);
+    mode = next;
+    apply(PROFILES[mode]);
+}
+
+bool PowerManager::notifyActivity(uint32_t now) {
+    stillSince = now;
+    if (mode == POWER_ACTIVE) return false;
+    setMode(POWER_ACTIVE, now);
+    return true;
+}
+
+void PowerManager::update(const ScooterData& data, uint32_t now) {
+    int32_t current = data.isCharging ? 0 : data.currentRaw;
+    if (current < 0) current = -current;
+    bool riding = data.connected &&
+        (data.speedRaw > POWER_WAKE_SPEED_RAW || current > POWER_WAKE_CURRENT_RAW);
+
+    if (riding) {
+        stillSince = now;
+        setMode(POWER_ACTIVE, now);
+    } else {
+        uint32_t still = now - stillSince;
+        if (still >= POWER_PARKED_AFTER_MS) {
+            setMode(POWER_PARKED, now);
+        } else if (still >= POWER_IDLE_AFTER_MS && mode == POWER_ACTIVE) {
+            setMode(POWER_IDLE, now);
+        }
+    }
+
+    account(now);
+
+    if (now - lastReport >= POWER_REPORT_MS) {
+        lastReport = now;
+        report();
+    }
+}
+
+uint16_t PowerManager::estimatedMa(PowerMode m) const {
+    const PowerProfile& p = PROFILES[m];
+
+    // Fraction of time the render task was awake, in permille
+    uint32_t busy = 1000;
+    if (modeMs[m] > 0 && waitMsTotal[m] <= modeMs[m]) {
+        busy = 1000 - waitMsTotal[m] * 1000ULL / modeMs[m];
+    }
+
+    uint32_t cpuMa = 20 + p.cpuMhz / 8;
+    uint32_t waitMa = lightSleep ? POWER_EST_SLEEP_MA : cpuMa;
+    uint32_t radioMa = POWER_EST_RADIO_MA_MS * 100 / (p.connInterval * 125);
+    uint32_t backlightMa = POWER_EST_BACKLIGHT_MA * p.backlight / 255;
+
+    return POWER_EST_BASE_MA + backlightMa + radioMa +
+           (cpuMa * busy + waitMa * (1000 - busy)) / 1000;
+}
+
+uint16_t PowerManager::averageMa() const {
+    uint64_t charge = 0;
+    uint32_t total = 0;
+    for (int m = 0; m < POWER_MODE_COUNT; m++) {
+        charge += (uint64_t)estimatedMa((PowerMode)m) * modeMs[m];
+        total += modeMs[m];
+    }
+    return total ? (uint16_t)(charge / total) : estimatedMa(mode);
+}
+
+void PowerManager::report() const {
+    for (int m = 0; m < POWER_MODE_COUNT; m++) {
+        Serial.printf("[PWR] %-6s %6lus  ~%umA\n", PROFILES[m].name,
+                      (unsigned long)(modeMs[m] / 1000), estimatedMa((PowerMode)m));
+    }
+    Serial.printf("[PWR] Average ~%umA\n", averageMa());
+}
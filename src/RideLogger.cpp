@@ -0,0 +1,149 @@
+#include "RideLogger.h"
+
+#define NO_BLOCK 0xFF
+
+RideLogger::RideLogger()
+    : spi(VSPI), active(false), pool(nullptr), freeQueue(nullptr), fullQueue(nullptr),
+      task(nullptr), current(NO_BLOCK), seq(0), dropped(0), fileBytes(0), blocksWritten(0),
+      writes(0), writeErrors(0), maxWriteUs(0) {
+}
+
+bool RideLogger::begin() {
+    spi.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
+    if (!SD.begin(SD_CS, spi, SD_SPI_HZ)) {
+        Serial.println("[LOG] No SD card");
+        return false;
+    }
+
+    pool = (uint8_t*)malloc(LOGGER_BLOCKS * LOG_BLOCK_SIZE);
+    if (!pool) {
+        Serial.println("[LOG] Buffer alloc failed");
+        return false;
+    }
+
+    if (!openNextFile()) return false;
+
+    freeQueue = xQueueCreate(LOGGER_BLOCKS, sizeof(uint8_t));
+    fullQueue = xQueueCreate(LOGGER_BLOCKS, sizeof(uint8_t));
+    for (uint8_t i = 0; i < LOGGER_BLOCKS; i++) {
+        xQueueSend(freeQueue, &i, 0);
+    }
+
+    xTaskCreatePinnedToCore(taskEntry, "sdlog", 4096, this, 1, &task, 1);
+    active = true;
+    return true;
+}
+
+bool RideLogger::openNextFile() {
+    if (!SD.exists(LOGGER_DIR)) SD.mkdir(LOGGER_DIR);
+
+    char path[24];
+    for (uint16_t n = 1; n < 10000; n++) {
+        snprintf(path, sizeof(path), LOGGER_DIR "/R%04u.M3L", n);
+        if (!SD.exists(path)) break;
+    }
+
+    file = SD.open(path, FILE_WRITE);
+    if (!file) {
+        Serial.printf("[LOG] Cannot create %s\n", path);
+        return false;
+    }
+
+    // Schema block goes out synchronously, before any writer exists
+    logWriteSchema(pool);
+    if (file.write(pool, LOG_BLOCK_SIZE) != LOG_BLOCK_SIZE) {
+        Serial.println("[LOG] Header write failed");
+        file.close();
+        return false;
+    }
+    file.flush();
+    fileBytes = LOG_BLOCK_SIZE;
+
+    Serial.printf("[LOG] Recording to %s\n", path);
+    return true;
+}
+
+void RideLogger::log(const ScooterData& data, uint32_t now) {
+    if (!active) return;
+
+    if (encoder.isOpen() && !encoder.append(data, now)) {
+        sealCurrent();
+    }
+
+    if (!encoder.isOpen()) {
+        // Writer behind: drop rather than wait on the card
+        if (xQueueReceive(freeQueue, &current, 0) != pdTRUE) {
+            current = NO_BLOCK;
+            dropped++;
+            return;
+        }
+        encoder.begin(pool + current * LOG_BLOCK_SIZE, seq++, now);
+        encoder.append(data, now);
+    }
+}
+
+void RideLogger::service(uint32_t now) {
+    if (active && encoder.isOpen() && now - encoder.openedAt() >= LOGGER_SEAL_MS) {
+        sealCurrent();
+    }
+}
+
+void RideLogger::sealCurrent() {
+    encoder.seal();
+    xQueueSend(fullQueue, &current, 0);
+    current = NO_BLOCK;
+}
+
+void RideLogger::taskEntry(void* arg) {
+    static_cast<RideLogger*>(arg)->run();
+}
+
+// Blocks are taken from and returned to the free queue in pool order,
+// so sealed ones arrive consecutive and a batch is one contiguous run,
+// cut at the end of the pool and at the next LOGGER_WRITE_BYTES of file
+void RideLogger::run() {
+    for (;;) {
+        uint8_t first;
+        xQueueReceive(fullQueue, &first, portMAX_DELAY);
+
+        uint8_t want = (LOGGER_WRITE_BYTES - fileBytes % LOGGER_WRITE_BYTES) / LOG_BLOCK_SIZE;
+        if (want > LOGGER_BLOCKS - first) want = LOGGER_BLOCKS - first;
+        uint8_t n = 1;
+        uint32_t since = millis();
+        while (n < want) {
+            uint32_t waited = millis() - since;
+            if (waited >= LOGGER_FLUSH_MS) break;
+            uint8_t idx;
+            if (xQueueReceive(fullQueue, &idx, pdMS_TO_TICKS(LOGGER_FLUSH_MS - waited)) != pdTRUE) break;
+            n++;
+        }
+
+        size_t bytes = n * LOG_BLOCK_SIZE;
+        uint32_t start = micros();
+        size_t done = file.write(pool + first * LOG_BLOCK_SIZE, bytes);
+        // Flush per write keeps the directory entry current if power dies
+        file.flush();
+        uint32_t spent = micros() - start;
+
+        fileBytes += done;
+        writes++;
+        if (done == bytes) {
+            blocksWritten += n;
+        } else {
+            writeErrors++;
+        }
+        if (spent > maxWriteUs) maxWriteUs = spent;
+
+        for (uint8_t i = 0; i < n; i++) {
+            uint8_t idx = first + i;
+            xQueueSend(freeQueue, &idx, 0);
+        }
+    }
+}
+
+void RideLogger::report() const {
+    if (!active) return;
+    Serial.printf("[LOG] blocks %lu in %lu writes  dropped %lu  errors %lu  max write %lu us\n",
+                  (unsigned long)blocksWritten, (unsigned long)writes, (unsigned long)dropped,
+                  (unsigned long)writeErrors, (unsigned long)maxWriteUs);
+}
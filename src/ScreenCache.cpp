@@ -0,0 +1,116 @@
+#include "ScreenCache.h"
+#include <stdlib.h>
+
+ScreenCache::ScreenCache(TFT_eSPI& display)
+    : tft(display), painter(nullptr), painterCtx(nullptr) {
+    for (int i = 0; i < SCREEN_CACHE_SLOTS; i++) {
+        runs[i] = nullptr;
+        runCount[i] = 0;
+    }
+}
+
+void ScreenCache::setPainter(ChromePainter p, void* ctx) {
+    painter = p;
+    painterCtx = ctx;
+}
+
+void ScreenCache::invalidate(uint8_t slot) {
+    if (slot >= SCREEN_CACHE_SLOTS) return;
+    free(runs[slot]);
+    runs[slot] = nullptr;
+    runCount[slot] = 0;
+}
+
+size_t ScreenCache::bytesUsed() const {
+    size_t total = 0;
+    for (int i = 0; i < SCREEN_CACHE_SLOTS; i++) {
+        total += runCount[i] * sizeof(RleRun);
+    }
+    return total;
+}
+
+bool ScreenCache::build(uint8_t slot) {
+    if (slot >= SCREEN_CACHE_SLOTS || !painter) return false;
+    invalidate(slot);
+
+    const int16_t w = tft.width();
+    const int16_t h = tft.height();
+
+    TFT_eSprite strip(&tft);
+    strip.setColorDepth(16);
+    if (!strip.createSprite(w, SCREEN_CACHE_STRIP_H)) {
+        Serial.println("[UI] Chrome strip alloc failed");
+        return false;
+    }
+
+    uint16_t capacity = 256;
+    RleRun* buf = (RleRun*)malloc(capacity * sizeof(RleRun));
+    if (!buf) {
+        strip.deleteSprite();
+        return false;
+    }
+
+    uint16_t n = 0;
+    bool ok = true;
+
+    for (int16_t top = 0; top < h && ok; top += SCREEN_CACHE_STRIP_H) {
+        strip.fillSprite(0x0000);
+        painter(painterCtx, slot, strip, -top);
+
+        int16_t rows = (h - top) < SCREEN_CACHE_STRIP_H ? (h - top) : SCREEN_CACHE_STRIP_H;
+        for (int16_t y = 0; y < rows && ok; y++) {
+            for (int16_t x = 0; x < w; x++) {
+                uint16_t c = strip.readPixel(x, y);
+                // Runs continue across row ends; the blit is one window
+                if (n > 0 && buf[n - 1].color == c && buf[n - 1].count < 0xFFFF) {
+                    buf[n - 1].count++;
+                    continue;
+                }
+                if (n == capacity) {
+                    RleRun* grown = capacity < 0x8000
+                        ? (RleRun*)realloc(buf, capacity * 2 * sizeof(RleRun)) : nullptr;
+                    if (!grown) {
+                        ok = false;
+                        break;
+                    }
+                    buf = grown;
+                    capacity *= 2;
+                }
+                buf[n].color = c;
+                buf[n].count = 1;
+                n++;
+            }
+        }
+    }
+
+    strip.deleteSprite();
+
+    if (!ok) {
+        free(buf);
+        Serial.println("[UI] Chrome cache overflow");
+        return false;
+    }
+
+    RleRun* fitted = (RleRun*)realloc(buf, n * sizeof(RleRun));
+    runs[slot] = fitted ? fitted : buf;
+    runCount[slot] = n;
+
+    Serial.printf("[UI] Chrome %u cached: %u runs, %u bytes\n",
+                  slot, n, (unsigned)(n * sizeof(RleRun)));
+    return true;
+}
+
+bool ScreenCache::blit(uint8_t slot) {
+    if (!isBuilt(slot) && !build(slot)) return false;
+
+    const RleRun* r = runs[slot];
+    uint16_t n = runCount[slot];
+
+    tft.startWrite();
+    tft.setAddrWindow(0, 0, tft.width(), tft.height());
+    for (uint16_t i = 0; i < n; i++) {
+        tft.pushBlock(r[i].color, r[i].count);
+    }
+    tft.endWrite();
+    return true;
+}
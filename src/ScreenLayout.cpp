@@ -0,0 +1,240 @@
+#include "ScreenLayout.h"
+#include "HistoryStore.h"
+#include "FastFormat.h"
+#include "LogEncoder.h"
+#include <string.h>
+#include <stdlib.h>
+
+static inline uint16_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Shown units of the derived fields, like TelemetryField::scale
+static const uint16_t LAYOUT_FIELD_SCALE[LF_LAST - LF_FIRST + 1] = {
+    1,      // speed shown, km/h
+    10,     // BMS average, 0.1 C
+    10,     // average speed, 0.1 km/h
+    1,      // trip max, km/h
+    1,      // imbalance, mV
+};
+
+static const int32_t POW10[FMT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000 };
+
+ScreenLayout::ScreenLayout() : screenCount(0), itemCount(0), error(nullptr) {
+}
+
+bool ScreenLayout::fail(const char* why) {
+    screenCount = 0;
+    itemCount = 0;
+    error = why;
+    return false;
+}
+
+// TFT_eSPI's built-in fonts; 0 for the ones the panel doesn't carry
+uint8_t ScreenLayout::fontHeight(uint8_t font) {
+    switch (font) {
+        case 1:  return 8;
+        case 2:  return 16;
+        case 4:  return 26;
+        case 6:  return 48;
+        case 7:  return 48;
+        case 8:  return 75;
+        default: return 0;
+    }
+}
+
+static bool validField(uint8_t type, uint8_t field) {
+    switch (type) {
+        case LW_VALUE:
+        case LW_BAR:
+            return field < TF_COUNT || (field >= LF_FIRST && field <= LF_LAST);
+        case LW_GRAPH:
+            return field < HIST_CHANNELS;
+        default:
+            return true;
+    }
+}
+
+// Clear box and divisor, so a frame does no geometry or scaling lookups
+void ScreenLayout::resolve(LayoutItem& it) {
+    it.boxW = it.w;
+    it.boxH = it.h ? it.h : fontHeight(it.font);
+    uint8_t col = it.datum % 3;
+    uint8_t row = it.datum / 3;
+    it.boxX = it.x - (col == 1 ? it.boxW / 2 : col == 2 ? it.boxW : 0);
+    it.boxY = it.y - (row == 1 ? it.boxH / 2 : row == 2 ? it.boxH : 0);
+
+    int32_t scale = 1;
+    if (it.field < TF_COUNT) {
+        scale = TELEMETRY_FIELDS[it.field].scale;
+    } else if (it.field >= LF_FIRST && it.field <= LF_LAST) {
+        scale = LAYOUT_FIELD_SCALE[it.field - LF_FIRST];
+    }
+    it.divisor = scale / POW10[it.decimals];
+    if (it.divisor < 1) it.divisor = 1;
+}
+
+bool ScreenLayout::decode(const uint8_t* p, LayoutItem& it, uint8_t nRules, uint16_t nStrings) {
+    it.type = p[0];
+    it.field = p[1];
+    it.font = p[2];
+    it.datum = p[3];
+    it.x = (int16_t)get16(p + 4);
+    it.y = (int16_t)get16(p + 6);
+    it.w = (int16_t)get16(p + 8);
+    it.h = (int16_t)get16(p + 10);
+    it.color = get16(p + 12);
+    it.decimals = p[14];
+    it.flags = p[15];
+    it.firstRule = p[16];
+    it.ruleCount = p[17];
+    uint16_t text = get16(p + 18);
+    it.deadband = get16(p + 20);
+    it.span = get16(p + 22);
+
+    bool isText = it.type == LW_LABEL || it.type == LW_VALUE;
+    if (it.type >= LW_TYPES) return fail("bad widget type");
+    if (isText && fontHeight(it.font) == 0) return fail("bad font");
+    if (it.datum > LD_BR || it.decimals > FMT_MAX_DECIMALS) return fail("bad format");
+    if (!validField(it.type, it.field)) return fail("bad field");
+    if (it.firstRule + it.ruleCount > nRules) return fail("bad rule range");
+    if (it.type == LW_BAR && it.span == 0) return fail("bar without span");
+    if (text != LAYOUT_NO_TEXT && text >= nStrings) return fail("bad text");
+    it.text = text == LAYOUT_NO_TEXT ? nullptr : strings + text;
+    if (it.type == LW_LABEL && !it.text) return fail("label without text");
+    resolve(it);
+    return true;
+}
+
+bool ScreenLayout::load(const uint8_t* blob, size_t len) {
+    screenCount = 0;
+    itemCount = 0;
+    error = nullptr;
+
+    if (len < LAYOUT_HEADER_BYTES + 4 || memcmp(blob, "M365LYT", 8) != 0) return fail("not a layout");
+    if (get16(blob + 8) != LAYOUT_VERSION) return fail("unsupported version");
+
+    uint8_t nScreens = blob[10];
+    uint8_t nWidgets = blob[11];
+    uint8_t nRules = blob[12];
+    uint16_t nStrings = get16(blob + 14);
+    if (nScreens == 0 || nScreens > LAYOUT_MAX_SCREENS || nWidgets > LAYOUT_MAX_WIDGETS ||
+        nRules > LAYOUT_MAX_RULES || nStrings > LAYOUT_MAX_STRINGS) {
+        return fail("too large");
+    }
+
+    size_t screenAt = LAYOUT_HEADER_BYTES;
+    size_t widgetAt = screenAt + nScreens * LAYOUT_SCREEN_BYTES;
+    size_t ruleAt = widgetAt + nWidgets * LAYOUT_WIDGET_BYTES;
+    size_t stringAt = ruleAt + nRules * LAYOUT_RULE_BYTES;
+    size_t crcAt = stringAt + nStrings;
+    if (len != crcAt + 4) return fail("length mismatch");
+    if (logCrc32(blob, crcAt) != get32(blob + crcAt)) return fail("CRC mismatch");
+    if (nStrings > 0 && blob[stringAt + nStrings - 1] != 0) return fail("unterminated string");
+
+    memcpy(strings, blob + stringAt, nStrings);
+
+    for (uint8_t r = 0; r < nRules; r++) {
+        const uint8_t* p = blob + ruleAt + r * LAYOUT_RULE_BYTES;
+        LayoutRule& rule = rules[r];
+        rule.op = p[0];
+        rule.arg = p[1];
+        rule.color = get16(p + 2);
+        rule.value = (int32_t)get32(p + 4);
+        if (rule.op >= LR_OPS || (rule.op == LR_ALERT && rule.arg >= AIN_COUNT)) return fail("bad rule");
+    }
+
+    // Each screen's widgets in two passes over the blob, chrome first
+    uint8_t n = 0;
+    for (uint8_t s = 0; s < nScreens; s++) {
+        const uint8_t* p = blob + screenAt + s * LAYOUT_SCREEN_BYTES;
+        LayoutScreen& sc = screens[s];
+        sc.screen = p[0];
+        sc.first = n;
+        uint8_t first = p[1];
+        uint8_t count = p[2];
+        if (first + count > nWidgets || n + count > LAYOUT_MAX_WIDGETS) return fail("bad screen range");
+        for (uint8_t i = 0; i < s; i++) {
+            if (screens[i].screen == sc.screen) return fail("screen listed twice");
+        }
+        for (uint8_t pass = 0; pass < 2; pass++) {
+            for (uint8_t w = first; w < first + count; w++) {
+                const uint8_t* wp = blob + widgetAt + w * LAYOUT_WIDGET_BYTES;
+                if (layoutIsChrome(wp[0]) != (pass == 0)) continue;
+                if (!decode(wp, items[n++], nRules, nStrings)) return false;
+            }
+            if (pass == 0) sc.chromeCount = n - sc.first;
+        }
+        sc.dynamicCount = n - sc.first - sc.chromeCount;
+    }
+
+    for (uint8_t i = 0; i < n; i++) {
+        lastValue[i] = 0;
+        lastColor[i] = 0;
+    }
+    itemCount = n;
+    screenCount = nScreens;
+    return true;
+}
+
+const LayoutScreen* ScreenLayout::find(uint8_t screen) const {
+    for (uint8_t s = 0; s < screenCount; s++) {
+        if (screens[s].screen == screen) return &screens[s];
+    }
+    return nullptr;
+}
+
+int32_t ScreenLayout::value(const LayoutContext& ctx, uint8_t field) {
+    const ScooterData& d = *ctx.data;
+    switch (field) {
+        case LF_SPEED_SHOWN:    return ctx.speedShown;
+        case LF_TEMP_BMS_AVG:   return d.tempBMSAvgX10();
+        case LF_AVG_SPEED:      return d.tripAvgSpeedX10();
+        case LF_TRIP_MAX_SPEED: return ctx.tripMaxSpeed;
+        case LF_IMBALANCE:      return d.cellImbalanceMv();
+        default:                return telemetryValue(d, field);
+    }
+}
+
+uint16_t ScreenLayout::colorOf(const LayoutItem& it, const LayoutContext& ctx, int32_t v) const {
+    for (uint8_t r = it.firstRule; r < it.firstRule + it.ruleCount; r++) {
+        const LayoutRule& rule = rules[r];
+        bool hit;
+        switch (rule.op) {
+            case LR_LT:    hit = v < rule.value; break;
+            case LR_GT:    hit = v > rule.value; break;
+            case LR_ALERT: hit = ctx.alerts && ctx.alerts->level((AlertInput)rule.arg) >= rule.value; break;
+            default:       hit = false; break;
+        }
+        if (hit) return rule.color;
+    }
+    return it.color;
+}
+
+bool ScreenLayout::refresh(uint8_t index, const LayoutContext& ctx, bool force, char* text, uint16_t& color) {
+    const LayoutItem& it = items[index];
+    int32_t v = value(ctx, it.field);
+    color = colorOf(it, ctx, v);
+    if (!force && abs(v - lastValue[index]) <= it.deadband && color == lastColor[index]) return false;
+    lastValue[index] = v;
+    lastColor[index] = color;
+
+    if (it.type != LW_VALUE) return true;
+    if (it.flags & LWF_ABS) v = abs(v);
+    uint8_t len = (it.flags & LWF_TIME) ? fmtTime(text, (uint32_t)v)
+                                        : fmtFixed(text, fmtDivRound(v, it.divisor), it.decimals);
+    if (it.text && len + strlen(it.text) < LAYOUT_TEXT_MAX) fmtAppend(text, len, it.text);
+    return true;
+}
+
+int16_t ScreenLayout::barFill(uint8_t index) const {
+    const LayoutItem& it = items[index];
+    int32_t v = lastValue[index];
+    if (v <= 0) return 0;
+    if (v >= it.span) return it.w;
+    return (int16_t)(v * it.w / it.span);
+}
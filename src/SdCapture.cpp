@@ -0,0 +1,66 @@
+#include "SdCapture.h"
+
+SdCapture::SdCapture() : stream(nullptr), task(nullptr), dropped(0) {
+}
+
+bool SdCapture::begin() {
+    if (!SD.exists(CAPTURE_DIR)) SD.mkdir(CAPTURE_DIR);
+
+    char path[32];
+    for (uint16_t n = 1; n < 10000; n++) {
+        snprintf(path, sizeof(path), CAPTURE_DIR "/C%04u.CAP", n);
+        if (!SD.exists(path)) break;
+    }
+
+    file = SD.open(path, FILE_WRITE);
+    if (!file) {
+        Serial.printf("[CAP] Cannot create %s\n", path);
+        return false;
+    }
+
+    uint8_t header[CAPTURE_HEADER_BYTES];
+    captureWriteHeader(header);
+    file.write(header, sizeof(header));
+
+    stream = xStreamBufferCreate(CAPTURE_STREAM_SIZE, 1);
+    xTaskCreatePinnedToCore(taskEntry, "capture", 4096, this, 1, &task, 1);
+    Serial.printf("[CAP] Recording notifications to %s\n", path);
+    return true;
+}
+
+void SdCapture::capture(uint32_t timeMs, const uint8_t* data, uint16_t len) {
+    if (!stream) return;
+
+    // Whole record or nothing, so the file never holds a torn record
+    uint8_t rec[CAPTURE_RECORD_BYTES + CAPTURE_MAX_PAYLOAD];
+    captureWriteRecord(rec, timeMs, len);
+    memcpy(rec + CAPTURE_RECORD_BYTES, data, len);
+    size_t n = CAPTURE_RECORD_BYTES + len;
+    if (xStreamBufferSpacesAvailable(stream) < n) {
+        dropped++;
+        return;
+    }
+    xStreamBufferSend(stream, rec, n, 0);
+}
+
+void SdCapture::taskEntry(void* arg) {
+    static_cast<SdCapture*>(arg)->run();
+}
+
+void SdCapture::run() {
+    static uint8_t chunk[CAPTURE_CHUNK];
+    size_t fill = 0;
+    uint32_t lastFlush = millis();
+
+    for (;;) {
+        fill += xStreamBufferReceive(stream, chunk + fill, sizeof(chunk) - fill, pdMS_TO_TICKS(500));
+
+        bool stale = fill > 0 && millis() - lastFlush >= CAPTURE_FLUSH_MS;
+        if (fill == sizeof(chunk) || stale) {
+            file.write(chunk, fill);
+            file.flush();
+            fill = 0;
+            lastFlush = millis();
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "SerialStream.h"
+
+static uint16_t crc16(const uint8_t* data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Consistent Overhead Byte Stuffing; out needs len + len/254 + 1 bytes
+static uint16_t cobsEncode(const uint8_t* in, uint16_t len, uint8_t* out) {
+    uint16_t code = 0;
+    uint16_t pos = 1;
+    uint8_t run = 1;
+    for (uint16_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code] = run;
+            code = pos++;
+            run = 1;
+            continue;
+        }
+        out[pos++] = in[i];
+        if (++run == 0xFF) {
+            out[code] = run;
+            code = pos++;
+            run = 1;
+        }
+    }
+    out[code] = run;
+    return pos;
+}
+
+static inline uint16_t putVarint(uint8_t* p, uint16_t pos, uint64_t v) {
+    while (v >= 0x80) {
+        p[pos++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[pos++] = (uint8_t)v;
+    return pos;
+}
+
+SerialStream::SerialStream()
+    : enabled(false), schemaPending(false), keyPending(false), seq(0), lastKeyframe(0), coalesced(0),
+      capturing(false), captureSeq(0), captureDropped(0) {
+    memset(sent, 0, sizeof(sent));
+}
+
+void SerialStream::setEnabled(bool on) {
+    if (on == enabled) return;
+    enabled = on;
+    if (on) {
+        schemaPending = true;
+        keyPending = true;
+        seq = 0;
+    }
+    Serial.printf("[STREAM] %s\n", on ? "on" : "off");
+}
+
+void SerialStream::poll() {
+    while (Serial.available()) {
+        int c = Serial.read();
+        if (c == STREAM_CMD_START) setEnabled(true);
+        else if (c == STREAM_CMD_STOP) setEnabled(false);
+        else if (c == STREAM_CMD_CAPTURE_ON || c == STREAM_CMD_CAPTURE_OFF) {
+            capturing = c == STREAM_CMD_CAPTURE_ON;
+            captureSeq = 0;
+            Serial.printf("[STREAM] capture %s\n", capturing ? "on" : "off");
+        }
+    }
+}
+
+bool SerialStream::sendFrame(const uint8_t* frame, uint16_t len) {
+    static uint8_t out[STREAM_MAX_SCHEMA + STREAM_MAX_SCHEMA / 254 + 3];
+    // Delimiter on both sides so a text line printed just before cannot
+    // merge into the frame
+    out[0] = 0x00;
+    uint16_t n = 1 + cobsEncode(frame, len, out + 1);
+    out[n++] = 0x00;
+
+    // All or nothing: a partial frame would cost the reader a resync
+    if (Serial.availableForWrite() < n) return false;
+    Serial.write(out, n);
+    return true;
+}
+
+bool SerialStream::sendSchema() {
+    uint8_t frame[STREAM_MAX_SCHEMA];
+    uint16_t pos = 0;
+    frame[pos++] = STREAM_FRAME_SCHEMA;
+    frame[pos++] = seq;
+    frame[pos++] = TF_COUNT;
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        const TelemetryField& f = TELEMETRY_FIELDS[i];
+        frame[pos++] = f.scale;
+        frame[pos++] = f.scale >> 8;
+        uint8_t len = strlen(f.name);
+        frame[pos++] = len;
+        memcpy(frame + pos, f.name, len);
+        pos += len;
+        len = strlen(f.unit);
+        frame[pos++] = len;
+        memcpy(frame + pos, f.unit, len);
+        pos += len;
+    }
+    uint16_t crc = crc16(frame, pos);
+    frame[pos++] = crc;
+    frame[pos++] = crc >> 8;
+    return sendFrame(frame, pos);
+}
+
+void SerialStream::publish(const ScooterData& data, uint32_t now) {
+    if (!enabled) return;
+
+    if (schemaPending) {
+        if (!sendSchema()) return;
+        schemaPending = false;
+    }
+
+    bool key = keyPending || now - lastKeyframe >= STREAM_KEYFRAME_MS;
+
+    int32_t values[TF_COUNT];
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        values[i] = telemetryValue(data, i);
+        if (key || values[i] != sent[i]) mask |= 1ULL << i;
+    }
+    if (mask == 0) return;
+
+    uint8_t frame[STREAM_MAX_FRAME];
+    uint16_t pos = 0;
+    frame[pos++] = key ? STREAM_FRAME_KEY : STREAM_FRAME_DELTA;
+    frame[pos++] = seq;
+    pos = putVarint(frame, pos, now);
+    pos = putVarint(frame, pos, mask);
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        if (!(mask & (1ULL << i))) continue;
+        int32_t d = values[i] - (key ? 0 : sent[i]);
+        pos = putVarint(frame, pos, ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+    }
+    uint16_t crc = crc16(frame, pos);
+    frame[pos++] = crc;
+    frame[pos++] = crc >> 8;
+
+    if (!sendFrame(frame, pos)) {
+        // Nothing recorded as sent, so these changes ride on the next frame
+        coalesced++;
+        return;
+    }
+
+    seq++;
+    memcpy(sent, values, sizeof(sent));
+    if (key) {
+        keyPending = false;
+        lastKeyframe = now;
+    }
+}
+
+void SerialStream::capture(uint32_t timeMs, const uint8_t* data, uint16_t len) {
+    if (!capturing) return;
+    if (len > STREAM_MAX_SCHEMA - 10) len = STREAM_MAX_SCHEMA - 10;
+
+    uint8_t frame[STREAM_MAX_SCHEMA];
+    uint16_t pos = 0;
+    frame[pos++] = STREAM_FRAME_CAPTURE;
+    frame[pos++] = captureSeq;
+    pos = putVarint(frame, pos, timeMs);
+    memcpy(frame + pos, data, len);
+    pos += len;
+    uint16_t crc = crc16(frame, pos);
+    frame[pos++] = crc;
+    frame[pos++] = crc >> 8;
+
+    if (!sendFrame(frame, pos)) {
+        captureDropped++;
+        return;
+    }
+    captureSeq++;
+}
@@ -0,0 +1,47 @@
+#include "SpeedFilter.h"
+
+SpeedFilter::SpeedFilter() {
+    reset();
+}
+
+void SpeedFilter::reset() {
+    x = 0;
+    v = 0;
+    last = 0;
+    primed = false;
+}
+
+void SpeedFilter::add(int32_t z, uint32_t at) {
+    uint32_t dt = at - last;
+    if (!primed || dt > SPEED_MAX_GAP_MS) {
+        x = z;
+        v = 0;
+        last = at;
+        primed = true;
+        return;
+    }
+    if (dt == 0) return;
+
+    int32_t predicted = x + (int32_t)((int64_t)v * dt / 1000);
+    int32_t r = z - predicted;
+    x = predicted + (SPEED_ALPHA_Q8 * r) / 256;
+    v += (int32_t)((int64_t)SPEED_BETA_Q8 * r * 1000 / 256 / (int32_t)dt);
+    last = at;
+}
+
+int32_t SpeedFilter::estimate(uint32_t now) const {
+    if (!primed) return 0;
+    int32_t ahead = (int32_t)(now - last);
+    if (ahead < 0) ahead = 0;
+    if (ahead > SPEED_HORIZON_MS) ahead = SPEED_HORIZON_MS;
+    int32_t e = x + (int32_t)((int64_t)v * ahead / 1000);
+    return e < 0 ? 0 : e;
+}
+
+int16_t SpeedFilter::hold(int16_t shown, int32_t est) {
+    int32_t base = (int32_t)shown * 1000;
+    if (est > base + 500 + SPEED_HYSTERESIS_RAW || est < base - 500 - SPEED_HYSTERESIS_RAW) {
+        return (int16_t)((est + 500) / 1000);
+    }
+    return shown;
+}
@@ -0,0 +1,188 @@
+#include "SpeedGauge.h"
+#include "DisplayUI.h"
+#include "FastFormat.h"
+#include "TrigLUT.h"
+
+SpeedGauge::SpeedGauge(TFT_eSPI& display)
+    : tft(display), lastAngle(GAUGE_ANGLE_MIN), lastReadout(-1) {
+}
+
+static uint32_t isqrt(uint32_t v) {
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+static inline int32_t polarX(int32_t angle, int32_t r) {
+    return (lutSin(angle) * r) >> 15;
+}
+
+static inline int32_t polarY(int32_t angle, int32_t r) {
+    return -((lutCos(angle) * r) >> 15);
+}
+
+int16_t SpeedGauge::speedToAngle(int32_t speedRaw) const {
+    if (speedRaw < 0) speedRaw = 0;
+    if (speedRaw > GAUGE_MAX_SPEED_RAW) speedRaw = GAUGE_MAX_SPEED_RAW;
+    int32_t angle = GAUGE_ANGLE_MIN +
+        speedRaw * (GAUGE_ANGLE_MAX - GAUGE_ANGLE_MIN) / GAUGE_MAX_SPEED_RAW;
+    return (int16_t)(angle - (angle - GAUGE_ANGLE_MIN) % GAUGE_ANGLE_STEP);
+}
+
+void SpeedGauge::drawDial(TFT_eSPI& gfx, int16_t yOff) {
+    const int16_t cy = GAUGE_CY + yOff;
+    
+    // Ticks every 5 km/h, labels every 10 km/h
+    gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+    gfx.setTextDatum(MC_DATUM);
+    for (int kmh = 0; kmh <= GAUGE_MAX_SPEED_RAW / 1000; kmh += 5) {
+        int16_t a = speedToAngle(kmh * 1000);
+        bool major = (kmh % 10) == 0;
+        int32_t r0 = GAUGE_R_OUT + 4;
+        int32_t r1 = GAUGE_R_OUT + (major ? 12 : 8);
+        gfx.drawWideLine(GAUGE_CX + polarX(a, r0), cy + polarY(a, r0),
+                         GAUGE_CX + polarX(a, r1), cy + polarY(a, r1),
+                         major ? 2 : 1, COLOR_GRAY, COLOR_BG);
+        if (major) {
+            char buf[4];
+            fmtUint(buf, kmh);
+            gfx.drawString(buf, GAUGE_CX + polarX(a, GAUGE_R_OUT + 22),
+                           cy + polarY(a, GAUGE_R_OUT + 22), 2);
+        }
+    }
+
+    fillRingSector(gfx, cy, GAUGE_ANGLE_MIN, GAUGE_ANGLE_MAX, COLOR_DARKGRAY);
+
+    gfx.setTextColor(COLOR_GRAY, COLOR_BG);
+    gfx.drawString("km/h", GAUGE_CX, 216 + yOff, 2);
+}
+
+void SpeedGauge::reset() {
+    lastAngle = GAUGE_ANGLE_MIN;
+    lastReadout = -1;
+    drawNeedle(lastAngle, COLOR_WHITE);
+}
+
+void SpeedGauge::update(int16_t speedRaw) {
+    int16_t angle = speedToAngle(speedRaw);
+
+    if (angle != lastAngle) {
+        // Only the sector between old and new needle position changes
+        tft.startWrite();
+        if (angle > lastAngle) {
+            fillRingSector(tft, GAUGE_CY, lastAngle, angle, COLOR_ORANGE);
+        } else {
+            fillRingSector(tft, GAUGE_CY, angle, lastAngle, COLOR_DARKGRAY);
+        }
+        tft.endWrite();
+        drawNeedle(lastAngle, COLOR_BG);
+        drawNeedle(angle, COLOR_WHITE);
+        lastAngle = angle;
+    }
+
+    drawReadout(speedRaw);
+}
+
+void SpeedGauge::drawNeedle(int16_t angle, uint16_t color) {
+    tft.drawWedgeLine(GAUGE_CX + polarX(angle, GAUGE_HUB_R), GAUGE_CY + polarY(angle, GAUGE_HUB_R),
+                      GAUGE_CX + polarX(angle, GAUGE_NEEDLE_LEN), GAUGE_CY + polarY(angle, GAUGE_NEEDLE_LEN),
+                      2.5f, 1.0f, color, COLOR_BG);
+    tft.fillCircle(GAUGE_CX, GAUGE_CY, GAUGE_HUB_R, COLOR_ORANGE);
+}
+
+void SpeedGauge::drawReadout(int16_t speedRaw) {
+    int16_t readout = fmtDivRound(speedRaw, 100);
+    if (readout == lastReadout) return;
+
+    char buf[8];
+    fmtFixed(buf, readout, 1);
+    tft.fillRect(GAUGE_CX - 45, 178, 90, 26, COLOR_BG);
+    tft.setTextColor(COLOR_WHITE, COLOR_BG);
+    tft.setTextDatum(MC_DATUM);
+    tft.drawString(buf, GAUGE_CX, 191, 4);
+    lastReadout = readout;
+}
+
+// Splits [a0, a1) at quadrant boundaries so each chunk's bounding box is
+// spanned by its four corner points
+void SpeedGauge::fillRingSector(TFT_eSPI& gfx, int16_t cy, int16_t a0, int16_t a1, uint16_t color) {
+    while (a0 < a1) {
+        int16_t next = ((a0 + 3600) / 900 + 1) * 900 - 3600;
+        if (next > a1) next = a1;
+        fillSectorChunk(gfx, cy, a0, next, color);
+        a0 = next;
+    }
+}
+
+void SpeedGauge::fillSectorChunk(TFT_eSPI& gfx, int16_t cy, int16_t a0, int16_t a1, uint16_t color) {
+    const int32_t s0 = lutSin(a0), c0 = lutCos(a0);
+    const int32_t s1 = lutSin(a1), c1 = lutCos(a1);
+
+    int32_t xs[4] = { polarX(a0, GAUGE_R_IN), polarX(a0, GAUGE_R_OUT),
+                      polarX(a1, GAUGE_R_IN), polarX(a1, GAUGE_R_OUT) };
+    int32_t ys[4] = { polarY(a0, GAUGE_R_IN), polarY(a0, GAUGE_R_OUT),
+                      polarY(a1, GAUGE_R_IN), polarY(a1, GAUGE_R_OUT) };
+    int32_t minX = xs[0], maxX = xs[0], minY = ys[0], maxY = ys[0];
+    for (int i = 1; i < 4; i++) {
+        if (xs[i] < minX) minX = xs[i];
+        if (xs[i] > maxX) maxX = xs[i];
+        if (ys[i] < minY) minY = ys[i];
+        if (ys[i] > maxY) maxY = ys[i];
+    }
+    minX -= 2; maxX += 2; minY -= 2; maxY += 2;
+
+    // Ring membership on 4*d^2 so the +-0.5 px pixel-centre bounds stay integer
+    const int32_t fullLo = (2 * GAUGE_R_IN + 1) * (2 * GAUGE_R_IN + 1);
+    const int32_t fullHi = (2 * GAUGE_R_OUT - 1) * (2 * GAUGE_R_OUT - 1);
+    const int32_t edgeLo = (2 * GAUGE_R_IN - 1) * (2 * GAUGE_R_IN - 1);
+    const int32_t edgeHi = (2 * GAUGE_R_OUT + 1) * (2 * GAUGE_R_OUT + 1);
+
+    for (int32_t dy = minY; dy <= maxY; dy++) {
+        int32_t runStart = 0;
+        int32_t runLen = 0;
+
+        for (int32_t dx = minX; dx <= maxX + 1; dx++) {
+            uint8_t alpha = 0;
+
+            if (dx <= maxX &&
+                s0 * dy + c0 * dx >= 0 &&       // clockwise of a0
+                -c1 * dx - s1 * dy > 0) {       // counter-clockwise of a1
+                int32_t d4 = 4 * (dx * dx + dy * dy);
+                if (d4 >= fullLo && d4 <= fullHi) {
+                    alpha = 255;
+                } else if (d4 > edgeLo && d4 < edgeHi) {
+                    // Edge pixel: coverage from distance in 1/16 px
+                    int32_t d16 = isqrt((uint32_t)(dx * dx + dy * dy) << 8);
+                    int32_t outer = (GAUGE_R_OUT * 16 + 8 - d16) * 16;
+                    int32_t inner = (d16 - GAUGE_R_IN * 16 + 8) * 16;
+                    int32_t cov = outer < inner ? outer : inner;
+                    alpha = cov <= 0 ? 0 : (cov >= 255 ? 255 : cov);
+                }
+            }
+
+            if (alpha == 255) {
+                if (runLen == 0) runStart = dx;
+                runLen++;
+                continue;
+            }
+
+            if (runLen > 0) {
+                gfx.drawFastHLine(GAUGE_CX + runStart, cy + dy, runLen, color);
+                runLen = 0;
+            }
+            if (alpha > 0) {
+                gfx.drawPixel(GAUGE_CX + dx, cy + dy, gfx.alphaBlend(alpha, color, COLOR_BG));
+            }
+        }
+    }
+}
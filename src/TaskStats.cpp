@@ -0,0 +1,59 @@
+#include "TaskStats.h"
+
+TaskStats::TaskStats(const char* taskName)
+    : name(taskName), handle(nullptr), core(0), workStart(0), lastTick(0),
+      windowStart(0), busyUs(0), maxWorkUs(0), maxGapUs(0), cycles(0) {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void TaskStats::attach(TaskHandle_t h, uint8_t c) {
+    handle = h;
+    core = c;
+    windowStart = micros();
+}
+
+void TaskStats::beginWork() {
+    workStart = micros();
+}
+
+void TaskStats::endWork() {
+    uint32_t spent = micros() - workStart;
+    portENTER_CRITICAL(&lock);
+    busyUs += spent;
+    if (spent > maxWorkUs) maxWorkUs = spent;
+    portEXIT_CRITICAL(&lock);
+}
+
+void TaskStats::tick() {
+    uint32_t now = micros();
+    portENTER_CRITICAL(&lock);
+    if (lastTick != 0 && now - lastTick > maxGapUs) maxGapUs = now - lastTick;
+    lastTick = now;
+    cycles++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void TaskStats::report() {
+    uint32_t now = micros();
+
+    portENTER_CRITICAL(&lock);
+    uint32_t window = now - windowStart;
+    uint32_t busy = busyUs;
+    uint32_t maxWork = maxWorkUs;
+    uint32_t maxGap = maxGapUs;
+    uint32_t n = cycles;
+    windowStart = now;
+    busyUs = 0;
+    maxWorkUs = 0;
+    maxGapUs = 0;
+    cycles = 0;
+    portEXIT_CRITICAL(&lock);
+
+    uint32_t loadX10 = window ? (uint32_t)((uint64_t)busy * 1000 / window) : 0;
+    uint32_t stack = handle ? uxTaskGetStackHighWaterMark(handle) : 0;
+
+    Serial.printf("[TASK] %-6s core %u  cpu %lu.%lu%%  cycles %lu  max work %lu us  max gap %lu us  stack free %lu\n",
+                  name, core, (unsigned long)(loadX10 / 10), (unsigned long)(loadX10 % 10),
+                  (unsigned long)n, (unsigned long)maxWork, (unsigned long)maxGap,
+                  (unsigned long)stack);
+}
@@ -0,0 +1,72 @@
+#include "TelemetryFields.h"
+
+const TelemetryField TELEMETRY_FIELDS[TF_COUNT] = {
+    { "speed",      "km/h", 1000 },
+    { "avg_speed",  "km/h", 1000 },
+    { "current",    "A",    100  },
+    { "voltage",    "V",    100  },
+    { "power",      "W",    1    },
+    { "range",      "km",   100  },
+    { "temp_esc",   "C",    10   },
+    { "temp_bms1",  "C",    1    },
+    { "temp_bms2",  "C",    1    },
+    { "battery",    "%",    1    },
+    { "cap_remain", "mAh",  1    },
+    { "cap_full",   "mAh",  1    },
+    { "odometer",   "km",   1000 },
+    { "trip",       "km",   1000 },
+    { "ride_time",  "s",    1    },
+    { "error",      "",     1    },
+    { "mode",       "",     1    },
+    { "flags",      "",     1    },
+    { "rssi",       "dBm",  1    },
+    { "cell0",      "V",    1000 },
+    { "cell1",      "V",    1000 },
+    { "cell2",      "V",    1000 },
+    { "cell3",      "V",    1000 },
+    { "cell4",      "V",    1000 },
+    { "cell5",      "V",    1000 },
+    { "cell6",      "V",    1000 },
+    { "cell7",      "V",    1000 },
+    { "cell8",      "V",    1000 },
+    { "cell9",      "V",    1000 },
+    { "cell10",     "V",    1000 },
+    { "cell11",     "V",    1000 },
+    { "cell12",     "V",    1000 },
+    { "cell13",     "V",    1000 },
+    { "cell14",     "V",    1000 },
+    { "cell15",     "V",    1000 },
+};
+
+int32_t telemetryValue(const ScooterData& d, uint8_t id) {
+    switch (id) {
+        case TF_SPEED:      return d.speedRaw;
+        case TF_AVG_SPEED:  return d.averageSpeedRaw;
+        case TF_CURRENT:    return d.currentRaw;
+        case TF_VOLTAGE:    return d.voltageRaw;
+        case TF_POWER:      return d.power;
+        case TF_RANGE:      return d.remainingRangeRaw;
+        case TF_TEMP_ESC:   return d.tempESCRaw;
+        case TF_TEMP_BMS1:  return d.tempBMS1;
+        case TF_TEMP_BMS2:  return d.tempBMS2;
+        case TF_BATTERY:    return d.batteryLevel;
+        case TF_CAP_REMAIN: return d.capacityRemain;
+        case TF_CAP_FULL:   return d.capacityFull;
+        case TF_ODOMETER:   return (int32_t)d.odometer;
+        case TF_TRIP:       return (int32_t)d.tripDistance;
+        case TF_RIDE_TIME:  return (int32_t)d.rideTime;
+        case TF_ERROR:      return d.errorCode;
+        case TF_MODE:       return d.mode;
+        case TF_FLAGS:
+            return (d.isCharging ? TF_FLAG_CHARGING : 0) |
+                   (d.isLocked ? TF_FLAG_LOCKED : 0) |
+                   (d.headlight ? TF_FLAG_HEADLIGHT : 0) |
+                   (d.taillight ? TF_FLAG_TAILLIGHT : 0) |
+                   (d.connected ? TF_FLAG_CONNECTED : 0) |
+                   (d.cruise ? TF_FLAG_CRUISE : 0);
+        case TF_RSSI:       return d.rssi;
+        default:
+            if (id >= TF_CELL0 && id <= TF_CELL15) return d.cellMv[id - TF_CELL0];
+            return 0;
+    }
+}
@@ -0,0 +1,167 @@
+#include "TouchInput.h"
+
+TouchInput* TouchInput::instance = nullptr;
+
+TouchInput::TouchInput()
+    : queue(nullptr), task(nullptr) {
+    instance = this;
+}
+
+void TouchInput::begin() {
+    pinMode(TOUCH_CS, OUTPUT);
+    digitalWrite(TOUCH_CS, HIGH);
+    pinMode(TOUCH_IRQ, INPUT_PULLUP);
+    pinMode(TOUCH_CLK, OUTPUT);
+    digitalWrite(TOUCH_CLK, LOW);
+    pinMode(TOUCH_MOSI, OUTPUT);
+    pinMode(TOUCH_MISO, INPUT);
+
+    queue = xQueueCreate(TOUCH_QUEUE_LEN, sizeof(TouchEvent));
+    xTaskCreatePinnedToCore(taskEntry, "touch", 3072, this, 2, &task, 1);
+
+    attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ), onIrq, FALLING);
+}
+
+bool TouchInput::poll(TouchEvent& evt, uint32_t waitMs) {
+    if (!queue) return false;
+    return xQueueReceive(queue, &evt, pdMS_TO_TICKS(waitMs)) == pdTRUE;
+}
+
+void IRAM_ATTR TouchInput::onIrq() {
+    if (!instance || !instance->task) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(instance->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void TouchInput::taskEntry(void* arg) {
+    static_cast<TouchInput*>(arg)->run();
+}
+
+static int16_t mapAxis(int32_t raw, int32_t rawMin, int32_t rawMax, int32_t size) {
+    int32_t v = (raw - rawMin) * size / (rawMax - rawMin);
+    if (v < 0) v = 0;
+    if (v > size - 1) v = size - 1;
+    return (int16_t)v;
+}
+
+// One 12-bit conversion: 8 command clocks, then 16 read clocks of which
+// the first is BUSY and the last three are zero (same framing as a
+// hardware transfer16() >> 3)
+uint16_t TouchInput::readChannel(uint8_t cmd) {
+    for (int8_t i = 7; i >= 0; i--) {
+        digitalWrite(TOUCH_MOSI, (cmd >> i) & 1);
+        digitalWrite(TOUCH_CLK, HIGH);
+        delayMicroseconds(1);
+        digitalWrite(TOUCH_CLK, LOW);
+        delayMicroseconds(1);
+    }
+    digitalWrite(TOUCH_MOSI, LOW);
+
+    uint16_t v = 0;
+    for (uint8_t i = 0; i < 16; i++) {
+        digitalWrite(TOUCH_CLK, HIGH);
+        delayMicroseconds(1);
+        v = (v << 1) | digitalRead(TOUCH_MISO);
+        digitalWrite(TOUCH_CLK, LOW);
+        delayMicroseconds(1);
+    }
+    return v >> 3;
+}
+
+// Average of the two closest readings out of three
+static int16_t bestTwoAvg(int16_t a, int16_t b, int16_t c) {
+    int16_t ab = abs(a - b), ac = abs(a - c), bc = abs(b - c);
+    if (ab <= ac && ab <= bc) return (a + b) >> 1;
+    if (ac <= ab && ac <= bc) return (a + c) >> 1;
+    return (b + c) >> 1;
+}
+
+bool TouchInput::readPoint(int16_t& x, int16_t& y) {
+    digitalWrite(TOUCH_CS, LOW);
+
+    int32_t z = (int32_t)readChannel(0xB1) + 4095 - readChannel(0xC1);
+    int16_t rx[3] = { 0 }, ry[3] = { 0 };
+    if (z >= TOUCH_MIN_PRESSURE) {
+        readChannel(0x91);      // first X after the Z reads is noisy
+        for (uint8_t i = 0; i < 3; i++) {
+            rx[i] = readChannel(0x91);
+            ry[i] = readChannel(0xD1);
+        }
+    }
+    readChannel(0xD0);          // power down, PENIRQ enabled
+
+    digitalWrite(TOUCH_CS, HIGH);
+
+    if (z < TOUCH_MIN_PRESSURE) return false;
+    x = mapAxis(bestTwoAvg(rx[0], rx[1], rx[2]), TOUCH_RAW_X_MIN, TOUCH_RAW_X_MAX, 320);
+    y = mapAxis(bestTwoAvg(ry[0], ry[1], ry[2]), TOUCH_RAW_Y_MIN, TOUCH_RAW_Y_MAX, 240);
+    return true;
+}
+
+void TouchInput::post(TouchGesture gesture, int16_t x, int16_t y, int16_t dx, int16_t dy) {
+    TouchEvent evt;
+    evt.gesture = gesture;
+    evt.x = x;
+    evt.y = y;
+    evt.dx = dx;
+    evt.dy = dy;
+    evt.time = millis();
+    // Drop rather than block if the UI is behind
+    xQueueSend(queue, &evt, 0);
+}
+
+void TouchInput::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Let the panel settle, then require a real pressure reading
+        vTaskDelay(pdMS_TO_TICKS(TOUCH_SAMPLE_MS));
+        int16_t startX, startY;
+        if (!readPoint(startX, startY)) continue;
+
+        uint32_t start = millis();
+        int16_t lastX = startX, lastY = startY;
+        bool moved = false;
+        bool longSent = false;
+        uint8_t misses = 0;
+
+        // Track the finger until two consecutive empty samples
+        while (misses < 2) {
+            vTaskDelay(pdMS_TO_TICKS(TOUCH_SAMPLE_MS));
+
+            int16_t x, y;
+            if (digitalRead(TOUCH_IRQ) == LOW && readPoint(x, y)) {
+                misses = 0;
+                lastX = x;
+                lastY = y;
+                if (abs(x - startX) > TOUCH_MOVE_SLOP || abs(y - startY) > TOUCH_MOVE_SLOP) {
+                    moved = true;
+                }
+            } else {
+                misses++;
+            }
+
+            if (!longSent && !moved && millis() - start >= TOUCH_LONG_MS) {
+                post(GESTURE_LONG_PRESS, startX, startY, 0, 0);
+                longSent = true;
+            }
+        }
+
+        int16_t dx = lastX - startX;
+        int16_t dy = lastY - startY;
+
+        if (!longSent) {
+            if (abs(dx) >= TOUCH_SWIPE_MIN && abs(dx) >= abs(dy)) {
+                post(dx < 0 ? GESTURE_SWIPE_LEFT : GESTURE_SWIPE_RIGHT, startX, startY, dx, dy);
+            } else if (abs(dy) >= TOUCH_SWIPE_MIN) {
+                post(dy < 0 ? GESTURE_SWIPE_UP : GESTURE_SWIPE_DOWN, startX, startY, dx, dy);
+            } else if (!moved && millis() - start <= TOUCH_TAP_MAX_MS) {
+                post(GESTURE_TAP, startX, startY, 0, 0);
+            }
+        }
+
+        // PENIRQ also toggles during conversions; discard those wakeups
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+}
@@ -0,0 +1,102 @@
+#include "TripRecorder.h"
+
+TripRecorder::TripRecorder()
+    : version(0), resetRequested(false), mounted(false), dirty(false), lastSave(0),
+      task(nullptr), savePending(false) {
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    stats.summarize(summary);
+}
+
+void TripRecorder::begin() {
+    File f = LittleFS.open(TRIP_STATE_PATH, FILE_READ);
+    if (f) {
+        TripStats loaded;
+        bool ok = f.read((uint8_t*)&loaded, sizeof(loaded)) == sizeof(loaded) && loaded.valid();
+        f.close();
+        if (ok) {
+            stats = loaded;
+            stats.resume();
+        } else {
+            Serial.println("[TRIP] Saved state unreadable, starting fresh");
+        }
+    }
+    publish();
+    Serial.printf("[TRIP] %lu samples, %lu s moving\n",
+                  (unsigned long)summary.samples, (unsigned long)(summary.movingMs / 1000));
+
+    mounted = true;
+    xTaskCreatePinnedToCore(taskEntry, "trip", 3072, this, 1, &task, 1);
+}
+
+void TripRecorder::getSummary(TripSummary& out) const {
+    portENTER_CRITICAL(&lock);
+    out = summary;
+    portEXIT_CRITICAL(&lock);
+}
+
+void TripRecorder::publish() {
+    TripSummary s;
+    stats.summarize(s);
+    portENTER_CRITICAL(&lock);
+    summary = s;
+    version++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void TripRecorder::newTrip(const char* why) {
+    Serial.printf("[TRIP] New trip (%s)\n", why);
+    stats.reset();
+    publish();
+    dirty = true;
+}
+
+void TripRecorder::update(const ScooterData& data, uint32_t now) {
+    if (resetRequested) {
+        resetRequested = false;
+        newTrip("reset");
+        queueSave(now);
+    }
+
+    // Scooter trip meter restarts from zero at every power-on
+    if (data.tripDistance > 0 && data.tripDistance < stats.lastTripM()) {
+        newTrip("scooter restarted");
+        queueSave(now);
+    }
+
+    if (data.connected && stats.add(data, now)) {
+        publish();
+        dirty = true;
+    }
+
+    if (dirty && now - lastSave >= TRIP_SAVE_MS) queueSave(now);
+}
+
+void TripRecorder::queueSave(uint32_t now) {
+    lastSave = now;
+    if (!mounted || savePending) return;
+    saveBuf = stats;
+    dirty = false;
+    savePending = true;
+    if (task) xTaskNotifyGive(task);
+}
+
+// ========== Writer task ==========
+
+void TripRecorder::taskEntry(void* arg) {
+    static_cast<TripRecorder*>(arg)->run();
+}
+
+void TripRecorder::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!savePending) continue;
+        File f = LittleFS.open(TRIP_STATE_PATH, FILE_WRITE);
+        if (f) {
+            f.write((const uint8_t*)&saveBuf, sizeof(saveBuf));
+            f.close();
+        } else {
+            Serial.println("[TRIP] State write failed");
+        }
+        savePending = false;
+    }
+}
@@ -0,0 +1,197 @@
+#include "TripStats.h"
+#include <math.h>
+#include <string.h>
+
+// ========== RunningStats ==========
+
+void RunningStats::reset() {
+    count = 0;
+    mean = 0.0f;
+    m2 = 0.0f;
+    min = 0.0f;
+    max = 0.0f;
+}
+
+void RunningStats::add(float x) {
+    count++;
+    if (count == 1) {
+        mean = x;
+        m2 = 0.0f;
+        min = x;
+        max = x;
+        return;
+    }
+    float delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+    if (x < min) min = x;
+    if (x > max) max = x;
+}
+
+// ========== P2Quantile ==========
+
+void P2Quantile::reset(float quantile) {
+    p = quantile;
+    count = 0;
+    for (int i = 0; i < 5; i++) {
+        q[i] = 0.0f;
+        n[i] = i;
+    }
+    np[0] = 0.0f;
+    np[1] = 2.0f * p;
+    np[2] = 4.0f * p;
+    np[3] = 2.0f + 2.0f * p;
+    np[4] = 4.0f;
+}
+
+static void sort5(float* v, uint8_t count) {
+    for (uint8_t i = 1; i < count; i++) {
+        float x = v[i];
+        int8_t j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+}
+
+void P2Quantile::add(float x) {
+    // The first five samples seed the markers
+    if (count < 5) {
+        q[count++] = x;
+        if (count == 5) sort5(q, 5);
+        return;
+    }
+    count++;
+
+    int k;
+    if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= q[k + 1]) k++;
+    }
+
+    for (int i = k + 1; i < 5; i++) n[i]++;
+    np[1] += p / 2.0f;
+    np[2] += p;
+    np[3] += (1.0f + p) / 2.0f;
+    np[4] += 1.0f;
+
+    // Nudge the middle markers towards their desired positions
+    for (int i = 1; i < 4; i++) {
+        float d = np[i] - n[i];
+        if ((d >= 1.0f && n[i + 1] - n[i] > 1) || (d <= -1.0f && n[i - 1] - n[i] < -1)) {
+            int s = d > 0 ? 1 : -1;
+            float qp = q[i] + (float)s / (n[i + 1] - n[i - 1]) *
+                       ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                        (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+            if (q[i - 1] < qp && qp < q[i + 1]) {
+                q[i] = qp;
+            } else {
+                // Parabola overshoots: fall back to linear
+                q[i] += s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+            }
+            n[i] += s;
+        }
+    }
+}
+
+float P2Quantile::value() const {
+    if (count >= 5) return q[2];
+    if (count == 0) return 0.0f;
+    float v[5];
+    memcpy(v, q, sizeof(v));
+    sort5(v, count);
+    return v[(uint8_t)(p * (count - 1) + 0.5f)];
+}
+
+// ========== TripStats ==========
+
+TripStats::TripStats() {
+    reset();
+}
+
+void TripStats::reset() {
+    magic = TRIP_STATS_MAGIC;
+    version = TRIP_STATS_VERSION;
+    started = false;
+    for (uint8_t c = 0; c < TRIP_CHANNELS; c++) {
+        channels[c].run.reset();
+        channels[c].p50.reset(0.50f);
+        channels[c].p95.reset(0.95f);
+        channels[c].p99.reset(0.99f);
+    }
+    for (uint8_t z = 0; z < TRIP_ZONES; z++) {
+        speedZoneMs[z] = 0;
+        powerZoneMs[z] = 0;
+    }
+    movingMs = 0;
+    lastSample = 0;
+    tripM = 0;
+}
+
+void TripStats::addChannel(TripChannel ch, float x) {
+    TripChannelStats& s = channels[ch];
+    s.run.add(x);
+    s.p50.add(x);
+    s.p95.add(x);
+    s.p99.add(x);
+}
+
+// Bands of 'width' starting at zone 'first'; the last zone is open ended
+static uint8_t zoneOf(int32_t value, int32_t width, uint8_t first) {
+    int32_t z = first + value / width;
+    return z >= TRIP_ZONES - 1 ? TRIP_ZONES - 1 : (uint8_t)z;
+}
+
+bool TripStats::add(const ScooterData& d, uint32_t now) {
+    if (started && now - lastSample < TRIP_SAMPLE_MS) return false;
+
+    uint32_t dt = started ? now - lastSample : 0;
+    if (dt > TRIP_MAX_GAP_MS) dt = TRIP_MAX_GAP_MS;
+    started = true;
+    lastSample = now;
+    if (d.tripDistance > 0) tripM = d.tripDistance;
+
+    addChannel(TRIP_TEMP_ESC, d.tempESCRaw / 10.0f);
+    addChannel(TRIP_TEMP_BMS, d.tempBMSAvgX10() / 10.0f);
+
+    if (d.speedRaw < TRIP_MOVING_SPEED_RAW) return true;
+
+    addChannel(TRIP_SPEED, d.speedKmh());
+    addChannel(TRIP_CURRENT, d.currentA());
+    // d.power is a magnitude; the sign comes from the current
+    int32_t powerW = (int32_t)d.voltageRaw * d.currentRaw / 10000;
+    addChannel(TRIP_POWER, powerW);
+
+    movingMs += dt;
+    speedZoneMs[zoneOf(d.speedRaw, TRIP_SPEED_ZONE_KMH * 1000, 0)] += dt;
+    // Zone 0 is regeneration
+    powerZoneMs[powerW < 0 ? 0 : zoneOf(powerW, TRIP_POWER_ZONE_W, 1)] += dt;
+    return true;
+}
+
+void TripStats::summarize(TripSummary& out) const {
+    for (uint8_t c = 0; c < TRIP_CHANNELS; c++) {
+        const TripChannelStats& s = channels[c];
+        TripChannelSummary& o = out.ch[c];
+        o.mean = s.run.mean;
+        o.stddev = sqrtf(s.run.variance());
+        o.max = s.run.max;
+        o.p50 = s.p50.value();
+        o.p95 = s.p95.value();
+        o.p99 = s.p99.value();
+    }
+    for (uint8_t z = 0; z < TRIP_ZONES; z++) {
+        out.speedZoneMs[z] = speedZoneMs[z];
+        out.powerZoneMs[z] = powerZoneMs[z];
+    }
+    out.movingMs = movingMs;
+    out.samples = channels[TRIP_TEMP_ESC].run.count;
+}
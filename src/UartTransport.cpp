@@ -0,0 +1,87 @@
+#include "UartTransport.h"
+
+UartTransport::UartTransport(HardwareSerial& serial)
+    : port(serial), echoLen(0), echoPos(0), awaiting(false), gotReply(false), sentAt(0),
+      lastByteUs(0), lastRxMs(0), everReceived(false), requests(0), timeouts(0), collisions(0) {
+}
+
+void UartTransport::begin() {
+    port.setRxBufferSize(UART_BUS_RX_BUFFER);
+    port.begin(UART_BUS_BAUD, SERIAL_8N1, UART_BUS_RX, UART_BUS_TX);
+    lastByteUs = micros();
+    Serial.printf("[UART] Bus on RX %d / TX %d\n", UART_BUS_RX, UART_BUS_TX);
+}
+
+LinkState UartTransport::update(uint32_t now) {
+    // Nothing to connect to: the link is up while something answers
+    if (everReceived && now - lastRxMs < UART_SILENT_MS) return LinkState::CONNECTED;
+    return LinkState::CONNECTING;
+}
+
+// Bytes still in the FIFO count as traffic we haven't timed yet
+bool UartTransport::busIdle() {
+    return port.available() == 0 && micros() - lastByteUs >= UART_BUS_IDLE_US;
+}
+
+bool UartTransport::canSend() {
+    if (awaiting) {
+        if (gotReply && busIdle()) {
+            awaiting = false;
+        } else if (millis() - sentAt >= UART_REPLY_TIMEOUT_MS) {
+            awaiting = false;
+            timeouts++;
+        } else {
+            return false;
+        }
+    }
+    return busIdle();
+}
+
+bool UartTransport::send(const uint8_t* data, size_t len) {
+    if (len > UART_MAX_ECHO || !canSend()) return false;
+    
+    memcpy(echo, data, len);
+    echoLen = len;
+    echoPos = 0;
+    
+    port.write(data, len);
+    sentAt = millis();
+    lastByteUs = micros();
+    awaiting = true;
+    gotReply = false;
+    requests++;
+    return true;
+}
+
+size_t UartTransport::receive(uint8_t* buf, size_t maxLen, uint32_t& timeMs) {
+    size_t n = 0;
+    while (n < maxLen && port.available()) {
+        uint8_t b = port.read();
+        lastByteUs = micros();
+        
+        if (echoPos < echoLen) {
+            if (b == echo[echoPos]) {
+                echoPos++;
+                continue;
+            }
+            // Our frame was corrupted on the wire; the rest is someone else's
+            collisions++;
+            echoLen = 0;
+            echoPos = 0;
+        }
+        buf[n++] = b;
+    }
+    
+    if (n) {
+        timeMs = millis();
+        lastRxMs = timeMs;
+        everReceived = true;
+        gotReply = true;
+    }
+    return n;
+}
+
+void UartTransport::report() const {
+    Serial.printf("[UART] %lu requests, %lu timeouts, %lu collisions\n",
+                  (unsigned long)requests, (unsigned long)timeouts, (unsigned long)collisions);
+}
@@ -1,82 +1,356 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
-#include <XPT2046_Touchscreen.h>
 
 #include "ScooterData.h"
 #include "DisplayUI.h"
-#include "M365BLE.h"
+#include "M365Client.h"
+#ifdef M365_TRANSPORT_UART
+#include "UartTransport.h"
+#else
+#include "BleTransport.h"
+#endif
+#include "TouchInput.h"
+#include "PowerManager.h"
+#include "TaskStats.h"
+#include "RideLogger.h"
+#include "FlashJournal.h"
+#include "SerialStream.h"
+#include "SdCapture.h"
+#include "M365Replay.h"
+#include "TripRecorder.h"
+#include "AlertEngine.h"
+#include "AlertBuzzer.h"
+#include "MemTelemetry.h"
+#include "BootTrace.h"
+#include "ScreenLayout.h"
+#include "LoopHealth.h"
+#ifdef M365_FLEET
+#ifdef M365_TRANSPORT_UART
+#error "Fleet mode needs the BLE transport"
+#endif
+#include "FleetMonitor.h"
+#endif
 
-#define TOUCH_CLK   25
-#define TOUCH_MISO  39
-#define TOUCH_MOSI  32
-#define TOUCH_CS    33
-#define TOUCH_IRQ   36
+// NimBLE host runs on core 0; keep the protocol next to it and give
+// the display core 1 to itself
+#define PROTO_CORE          0
+#define PROTO_PRIORITY      3
+#define PROTO_STACK         6144
+#define PROTO_PERIOD_MS     10
 
-SPIClass touchSPI(VSPI);
-XPT2046_Touchscreen touch(TOUCH_CS);
+#define RENDER_CORE         1
+#define RENDER_PRIORITY     2
+#define RENDER_STACK        8192
+
+#define TASK_REPORT_MS      10000
+
+// Dropping one of these on the SD card replays it instead of scanning
+#define REPLAY_PATH         "/REPLAY.CAP"   // original timing
+#define REPLAY_FAST_PATH    "/REPLAYF.CAP"  // as fast as it parses
+
+// Compiled screen layout on the internal LittleFS (tools/layout_compile.py)
+#define LAYOUT_PATH         "/layout.bin"
 
 TFT_eSPI tft = TFT_eSPI();
 DisplayUI ui(tft);
-M365BLE ble;
+#ifdef M365_TRANSPORT_UART
+UartTransport transport(Serial2);
+#else
+BleTransport transport;
+#endif
+M365Client scooter(transport);
+#ifdef M365_FLEET
+// 'transport' above is link 0, the scooter the riding screens follow
+BleTransport fleetLinks[FLEET_MAX_SCOOTERS - 1];
+FleetMonitor fleet;
+#endif
+TouchInput touchInput;
+PowerManager power(ui, scooter);
+RideLogger logger;
+FlashJournal journal;
+TripRecorder trip;
+SerialStream stream;
+SdCapture sdCapture;
+AlertEngine alerts;
+AlertBuzzer buzzer;
+MemTelemetry memTelemetry;
+ScreenLayout layout;
+LoopHealth health;
+M365Replay* replay = nullptr;
+File replayFile;
 
-unsigned long lastUIUpdate = 0;
-unsigned long lastTouch = 0;
-const unsigned long UI_INTERVAL = 50;
-const unsigned long TOUCH_DEBOUNCE = 200;
+// Set once setup() has brought up everything the protocol task feeds
+static volatile bool consumersReady = false;
 
-void setup() {
-    Serial.begin(115200);
-    Serial.println("\n[M365 Dashboard]");
-    
-    ui.begin();
-    ui.showStatus("Starting...");
-    
-    // Touch on VSPI
-    pinMode(TOUCH_CS, OUTPUT);
-    digitalWrite(TOUCH_CS, HIGH);
-    pinMode(TOUCH_IRQ, INPUT_PULLUP);
-    
-    touchSPI.begin(TOUCH_CLK, TOUCH_MISO, TOUCH_MOSI, TOUCH_CS);
-    touch.begin(touchSPI);
-    touch.setRotation(1);
+TaskStats protoStats("proto");
+TaskStats renderStats("render");
+
+// ========== Protocol task (core 0) ==========
+// Owns M365Client: link, poll schedule and frame decoding. The render
+// side only ever sees the published ScooterData snapshot. Started first
+// thing in setup(), so NimBLE init and the connect run while the panel
+// and storage come up on the other core.
+static void protocolTask(void* arg) {
+#ifdef M365_FLEET
+    fleet.begin();
+#else
+    scooter.begin();
+#endif
+    bootMark(BOOT_BLE_UP);
     
-    ble.begin();
-    ui.showStatus("Scanning...");
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t loggedSample = 0;
+    uint32_t lastPolls = 0;
+    for (;;) {
+        protoStats.tick();
+        protoStats.beginWork();
+        health.begin(LOOP_PROTO, SEC_LINK);
+        health.cadence(CAD_UPDATE);
+        {
+            MemScope scope(MEM_PATH_PROTO);
+#ifdef M365_FLEET
+            fleet.update();
+#else
+            scooter.update();
+#endif
+        }
+        // Poll cadence only means something while the link is up
+        uint32_t polls = scooter.getPolls();
+        if (!scooter.isConnected()) health.breakCadence(CAD_POLL);
+        else if (polls != lastPolls) health.cadence(CAD_POLL);
+        lastPolls = polls;
+        if (scooter.isConnected()) bootMark(BOOT_CONNECTED);
+        if (scooter.getSampleCount() > 0) bootMark(BOOT_FIRST_FRAME);
+        
+        ScooterData data = scooter.getData();
+        uint32_t now = millis();
+        
+        if (consumersReady) {
+            health.section(LOOP_PROTO, SEC_LOG);
+            MemScope scope(MEM_PATH_LOG);
+            // One log record per update that decoded anything
+            uint32_t samples = scooter.getSampleCount();
+            if (samples != loggedSample) {
+                loggedSample = samples;
+                logger.log(data, now);
+                stream.publish(data, now);
+            }
+            stream.poll();
+            logger.service(now);
+            journal.update(data, now);
+            trip.update(data, now);
+        }
+        health.end(LOOP_PROTO);
+        protoStats.endWork();
+        
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(PROTO_PERIOD_MS));
+        // Don't burst to catch up after a blocking connect
+        TickType_t ticks = xTaskGetTickCount();
+        if (ticks - wake > pdMS_TO_TICKS(PROTO_PERIOD_MS)) wake = ticks;
+    }
 }
 
-void loop() {
-    unsigned long now = millis();
+// Runs in the render task, from alerts.update()
+static void onAlert(void* ctx, const AlertRule& rule, bool raised) {
+    Serial.printf("[ALERT] %s: %s\n", raised ? "Raised" : "Cleared", rule.text);
+    if (!raised || rule.severity < ALERT_WARN) return;
     
-    ble.update();
+    // Back to full brightness first so the flash is visible
+    uint32_t now = millis();
+    power.notifyActivity(now);
+    uint8_t times = rule.severity >= ALERT_CRIT ? 3 : 1;
+    ui.flashBacklight(times);
+    buzzer.beep(times, now);
+}
+
+// ========== Render task (core 1) ==========
+// Owns DisplayUI and PowerManager. Sleeps on the touch queue until the
+// next frame is due, so touches are handled as soon as they arrive.
+static void renderTask(void* arg) {
+    TickType_t lastFrame = xTaskGetTickCount();
+    uint32_t lastReport = millis();
+    LinkState lastState = LinkState::DISCONNECTED;
+    bool statusShown = true;
     
-    // UI update at 20 FPS
-    if (now - lastUIUpdate >= UI_INTERVAL) {
-        lastUIUpdate = now;
+    for (;;) {
+        TickType_t interval = pdMS_TO_TICKS(power.uiIntervalMs());
+        TickType_t elapsed = xTaskGetTickCount() - lastFrame;
+        uint32_t waitMs = elapsed < interval ? (interval - elapsed) * portTICK_PERIOD_MS : 0;
         
-        if (ble.isConnected()) {
-            ui.update(ble.getData());
-        } else {
-            static BLEState lastState = BLEState::DISCONNECTED;
-            BLEState currentState = ble.getState();
-            
-            if (currentState != lastState) {
-                ui.showStatus(ble.getStateName());
-                lastState = currentState;
+        TouchEvent evt;
+        uint32_t waitStart = micros();
+        bool got = touchInput.poll(evt, waitMs);
+        power.accountWait(micros() - waitStart);
+        
+        renderStats.beginWork();
+        health.begin(LOOP_RENDER, SEC_TOUCH);
+        
+        while (got) {
+            // First touch on a dimmed screen only wakes it
+            if (!power.notifyActivity(millis())) {
+                ui.handleTouch(evt);
             }
+            got = touchInput.poll(evt);
         }
-    }
-    
-    // Touch handling
-    if (digitalRead(TOUCH_IRQ) == LOW && now - lastTouch >= TOUCH_DEBOUNCE) {
-        delay(3);
-        TS_Point p = touch.getPoint();
         
-        if (p.z > 50) {
-            ui.handleTouch(160, 120);
-            lastTouch = now;
+        TickType_t now = xTaskGetTickCount();
+        if (now - lastFrame >= interval) {
+            lastFrame = (now - lastFrame >= 2 * interval) ? now : lastFrame + interval;
+            renderStats.tick();
+            health.cadence(CAD_FRAME);
             
-            while(digitalRead(TOUCH_IRQ) == LOW) delay(5);
+            ScooterData data = scooter.getData();
+            health.section(LOOP_RENDER, SEC_POWER);
+            power.update(data, millis());
+            
+            // The fleet overview doesn't depend on the first scooter, nor
+            // do the loop figures, which matter most while connecting
+            Screen screen = ui.getScreen();
+            if (scooter.isConnected() || screen == FLEET_SCREEN || screen == LOOP_SCREEN) {
+                health.section(LOOP_RENDER, SEC_ALERTS);
+                if (scooter.isConnected()) alerts.update(data, millis());
+                health.section(LOOP_RENDER, SEC_DRAW);
+                MemScope scope(MEM_PATH_RENDER);
+                ui.update(data);
+                statusShown = false;
+            } else {
+                health.section(LOOP_RENDER, SEC_STATUS);
+                LinkState currentState = scooter.getState();
+                if (!statusShown || currentState != lastState) {
+                    ui.showStatus(scooter.getStateName());
+                    lastState = currentState;
+                    statusShown = true;
+                }
+                ui.prepare();
+            }
         }
+        
+        health.section(LOOP_RENDER, SEC_MISC);
+        buzzer.update(millis());
+        memTelemetry.update(millis());
+        renderStats.endWork();
+        
+        if (millis() - lastReport >= TASK_REPORT_MS) {
+            health.section(LOOP_RENDER, SEC_REPORT);
+            lastReport = millis();
+            protoStats.report();
+            renderStats.report();
+            logger.report();
+            scooter.report();
+            health.report();
+        }
+        health.end(LOOP_RENDER);
+    }
+}
+
+static size_t readReplayFile(void* ctx, uint8_t* buf, size_t len) {
+    return static_cast<File*>(ctx)->read(buf, len);
+}
+
+// Returns true if a replay capture was found and started
+static bool startReplay(bool sdReady) {
+    if (!sdReady) return false;
+    
+    bool realtime = SD.exists(REPLAY_PATH);
+    if (!realtime && !SD.exists(REPLAY_FAST_PATH)) return false;
+    
+    replayFile = SD.open(realtime ? REPLAY_PATH : REPLAY_FAST_PATH, FILE_READ);
+    if (!replayFile) return false;
+    
+    replay = new M365Replay(scooter.getProtocol());
+    if (!replay->begin(readReplayFile, &replayFile)) {
+        Serial.println("[BLE] Replay file is not a capture");
+        delete replay;
+        replay = nullptr;
+        replayFile.close();
+        return false;
     }
+    scooter.startReplay(replay, realtime);
+    return true;
+}
+
+// A layout only replaces the screens it defines; a bad one is ignored
+static void loadLayout() {
+    File f = LittleFS.open(LAYOUT_PATH, FILE_READ);
+    if (!f) return;
+    
+    size_t len = f.size();
+    uint8_t* blob = len <= LAYOUT_MAX_BYTES ? (uint8_t*)malloc(len) : nullptr;
+    uint32_t start = micros();
+    bool ok = blob && f.read(blob, len) == len && layout.load(blob, len);
+    f.close();
+    free(blob);
+    
+    if (!ok) {
+        Serial.printf("[UI] %s ignored: %s\n", LAYOUT_PATH, layout.getError() ? layout.getError() : "unreadable");
+        return;
+    }
+    ui.setLayout(&layout);
+    Serial.printf("[UI] Layout: %u widgets, loaded in %lu us\n", layout.widgets(), micros() - start);
+}
+
+void setup() {
+    bootMark(BOOT_RESET);
+    
+    // Room for whole stream frames so writes never wait on the UART
+    Serial.setTxBufferSize(STREAM_TX_BUFFER);
+    Serial.begin(115200);
+    Serial.println("\n[M365 Dashboard]");
+    
+    // Radio first: it has the longest way to go before telemetry flows
+    scooter.addCapture(&stream);
+#ifdef M365_FLEET
+    fleet.add(&scooter);
+    for (uint8_t i = 0; i < FLEET_MAX_SCOOTERS - 1; i++) {
+        fleet.add(new M365Client(fleetLinks[i]));
+    }
+#endif
+    TaskHandle_t handle;
+    xTaskCreatePinnedToCore(protocolTask, "proto", PROTO_STACK, nullptr, PROTO_PRIORITY, &handle, PROTO_CORE);
+    protoStats.attach(handle, PROTO_CORE);
+    
+    ui.begin();
+    ui.showStatus("Starting...");
+    bootMark(BOOT_FIRST_PIXEL);
+    
+    // Touch is bit-banged and sampled by its own task; VSPI is the SD card
+    touchInput.begin();
+    bool sdReady = logger.begin();
+    if (journal.begin()) {
+        ui.setJournal(&journal);
+        trip.begin();
+        loadLayout();
+    }
+    ui.setTrip(&trip);
+    ui.setMemTelemetry(&memTelemetry);
+    ui.setLoopHealth(&health);
+    ui.setClient(&scooter);
+#ifdef M365_FLEET
+    // A depot dashboard opens on the overview
+    ui.setFleet(&fleet);
+    ui.setScreen(FLEET_SCREEN);
+#endif
+    
+    alerts.setHook(onAlert, nullptr);
+    ui.setAlerts(&alerts);
+    buzzer.begin();
+    
+    // Raw notifications go to the PC on request and to SD if asked for
+    if (sdReady && SD.exists(CAPTURE_TRIGGER_PATH) && sdCapture.begin()) {
+        scooter.addCapture(&sdCapture);
+    }
+    
+    // The radio is already up by now; a replay simply takes over from it
+    if (startReplay(sdReady)) ui.showStatus("Replay");
+    power.begin();
+    consumersReady = true;
+    
+    xTaskCreatePinnedToCore(renderTask, "render", RENDER_STACK, nullptr, RENDER_PRIORITY, &handle, RENDER_CORE);
+    renderStats.attach(handle, RENDER_CORE);
+}
+
+void loop() {
+    // All work happens in the protocol and render tasks
+    vTaskDelete(nullptr);
 }
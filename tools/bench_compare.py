@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Compares two core_bench JSON results and flags regressions.
+
+    tools/bench_compare.py baseline.json current.json [--threshold 10]
+
+Exits 1 if any case got slower than the threshold (percent) or started
+allocating more per op. Cases present in only one file are listed but
+don't fail the comparison.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    if data.get("schema") != 1:
+        sys.exit("%s: unsupported schema %r" % (path, data.get("schema")))
+    return {r["name"]: r for r in data["results"]}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("baseline")
+    ap.add_argument("current")
+    ap.add_argument("--threshold", type=float, default=10.0, help="allowed slowdown in percent")
+    args = ap.parse_args()
+
+    base = load(args.baseline)
+    cur = load(args.current)
+
+    failed = False
+    print("%-34s %10s %10s %8s  %s" % ("case", "base ns", "now ns", "delta", ""))
+    for name in list(base) + [n for n in cur if n not in base]:
+        if name not in cur or name not in base:
+            print("%-34s %s" % (name, "only in baseline" if name in base else "new"))
+            continue
+        b, c = base[name], cur[name]
+        delta = (c["ns_per_op"] - b["ns_per_op"]) / b["ns_per_op"] * 100 if b["ns_per_op"] else 0
+        flags = []
+        if delta > args.threshold:
+            flags.append("SLOWER")
+        if c["allocs_per_op"] > b["allocs_per_op"]:
+            flags.append("ALLOCS %.3f -> %.3f" % (b["allocs_per_op"], c["allocs_per_op"]))
+        failed = failed or bool(flags)
+        print("%-34s %10.2f %10.2f %+7.1f%%  %s" % (name, b["ns_per_op"], c["ns_per_op"], delta, " ".join(flags)))
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Decodes a ride log (R####.M3L from the SD card) to CSV.
+
+    tools/decode_ridelog.py R0001.M3L > ride.csv
+
+The schema comes from the file's own header block, so logs from older
+firmware decode with the field set they were written with. Blocks with a
+bad magic or CRC (torn write at power loss) are reported and skipped.
+"""
+import struct
+import sys
+import zlib
+
+BLOCK_MAGIC = 0x424C334D
+HEADER = 12
+TRAILER = 8
+
+
+def read_varint(buf, pos):
+    value = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if b < 0x80:
+            return value, pos
+        shift += 7
+
+
+def parse_schema(block):
+    if block[:8] != b"M365LOG\0":
+        raise ValueError("not a ride log")
+    if zlib.crc32(block[:-4]) != struct.unpack_from("<I", block, len(block) - 4)[0]:
+        raise ValueError("schema block CRC mismatch")
+    version, block_size, count = struct.unpack_from("<HHB", block, 8)
+    pos = 13
+    fields = []
+    for _ in range(count):
+        scale, = struct.unpack_from("<H", block, pos)
+        pos += 2
+        name = block[pos + 1:pos + 1 + block[pos]].decode()
+        pos += 1 + block[pos]
+        unit = block[pos + 1:pos + 1 + block[pos]].decode()
+        pos += 1 + block[pos]
+        fields.append((name, unit, scale))
+    return version, block_size, fields
+
+
+def decode_block(block, nfields):
+    """Yields (time_ms, values) for every record in one data block."""
+    magic, seq, base = struct.unpack_from("<III", block, 0)
+    used, count, crc = struct.unpack_from("<HHI", block, len(block) - TRAILER)
+    if magic != BLOCK_MAGIC or zlib.crc32(block[:-4]) != crc:
+        return None, []
+    values = [0] * nfields
+    time = base
+    pos = HEADER
+    end = HEADER + used
+    records = []
+    while pos < end and len(records) < count:
+        dt, pos = read_varint(block, pos)
+        mask, pos = read_varint(block, pos)
+        time += dt
+        for i in range(nfields):
+            if mask & (1 << i):
+                z, pos = read_varint(block, pos)
+                values[i] += (z >> 1) ^ -(z & 1)
+        records.append((time, list(values)))
+    return seq, records
+
+
+def decode(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    # Block size from the header, so 4 KB and 512 byte logs both decode
+    block_size, = struct.unpack_from("<H", data, 10)
+    version, block_size, fields = parse_schema(data[:block_size])
+    blocks = [data[i:i + block_size] for i in range(block_size, len(data), block_size)]
+    return version, fields, blocks
+
+
+def fmt(raw, scale):
+    if scale == 1:
+        return str(raw)
+    digits = len(str(scale)) - 1
+    return "%.*f" % (digits, raw / scale)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    version, fields, blocks = decode(sys.argv[1])
+    out = sys.stdout
+    out.write("time_ms," + ",".join(
+        "%s_%s" % (n, u.replace("/", "")) if u else n for n, u, _ in fields) + "\n")
+
+    bad = 0
+    for i, block in enumerate(blocks):
+        if len(block) < HEADER + TRAILER:
+            break
+        seq, records = decode_block(block, len(fields))
+        if seq is None:
+            bad += 1
+            sys.stderr.write("block %d: bad magic/CRC, skipped\n" % (i + 1))
+            continue
+        for time, values in records:
+            out.write("%d,%s\n" % (time, ",".join(
+                fmt(v, s) for v, (_, _, s) in zip(values, fields))))
+
+    sys.stderr.write("v%d, %d fields, %d blocks, %d skipped\n" % (version, len(fields), len(blocks), bad))
+
+
+if __name__ == "__main__":
+    main()
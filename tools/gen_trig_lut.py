@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Regenerates include/TrigLUT.h (quarter-wave sine table, Q15, 1 degree steps)."""
+import math
+import os
+
+OUT = os.path.join(os.path.dirname(__file__), "..", "include", "TrigLUT.h")
+
+values = [round(math.sin(math.radians(d)) * 32767) for d in range(91)]
+rows = []
+for i in range(0, len(values), 10):
+    rows.append("    " + ", ".join("%5d" % v for v in values[i:i + 10]) + ",")
+
+with open(OUT, "w") as f:
+    f.write("""#ifndef TRIG_LUT_H
+#define TRIG_LUT_H
+
+#include <stdint.h>
+
+// Generated by tools/gen_trig_lut.py - do not edit by hand.
+// sin(0..90 deg) in Q15, 1 degree per entry.
+static const int16_t SIN_LUT_Q15[91] = {
+%s
+};
+
+// Angles are in tenths of a degree. Values between table entries are
+// linearly interpolated, which keeps the error below 1/3000 of full scale.
+inline int32_t lutSin(int32_t deciDeg) {
+    deciDeg %%= 3600;
+    if (deciDeg < 0) deciDeg += 3600;
+
+    int32_t sign = 1;
+    if (deciDeg >= 1800) {
+        deciDeg -= 1800;
+        sign = -1;
+    }
+    if (deciDeg > 900) deciDeg = 1800 - deciDeg;
+
+    int32_t idx = deciDeg / 10;
+    int32_t frac = deciDeg - idx * 10;
+    int32_t v = SIN_LUT_Q15[idx];
+    if (frac) v += (SIN_LUT_Q15[idx + 1] - v) * frac / 10;
+    return sign * v;
+}
+
+inline int32_t lutCos(int32_t deciDeg) {
+    return lutSin(deciDeg + 900);
+}
+
+#endif
+""" % "\n".join(rows))
@@ -0,0 +1,408 @@
+#!/usr/bin/env python3
+"""Compiles a text screen layout into the blob the dashboard loads.
+
+    tools/layout_compile.py layouts/classic.lyt -o data/layout.bin
+    tools/layout_compile.py layouts/classic.lyt --svg preview.svg
+    pio run -t uploadfs          # data/layout.bin -> /layout.bin
+
+One widget per line, '#' starts a comment, strings in double quotes:
+
+    screen main                      # main stats battery gauge rides trip diag loop fleet
+    label "ODO" at=5,160 font=1 color=gray
+    hline at=0,30 w=320 color=darkgray
+    vline at=158,32 h=84
+    frame at=0,40 size=100,60
+    value voltage at=3,44 w=75 font=4 decimals=1 deadband=20 color=cyan
+    value current at=3,84 w=75 font=4 decimals=1 abs when=<0:green color=yellow
+    value temp_esc at=317,44 w=72 align=tr font=4 suffix="C"
+          when=alert(temp_esc)>=crit:red when=alert(temp_esc)>=warn:yellow
+    bar battery at=5,120 size=90,6 span=100 color=green when=<20:red
+    graph power at=10,45 size=300,80 color=orange label="POWER (W)"
+    status                           # the built-in status bar (icons, battery)
+    cells                            # the built-in cell grid
+
+'at' is the text anchor for 'align' (tl tc tr ml mc mr bl bc br); 'w' and
+'h' size the box cleared before a value is redrawn (h defaults to the font
+height). 'when' rules are tried in order, first match wins. 'deadband' is
+in the field's raw units. '--svg' renders the screens with sample values.
+"""
+import argparse
+import shlex
+import struct
+import sys
+import zlib
+
+VERSION = 1
+MAX_SCREENS = 8
+MAX_WIDGETS = 96
+MAX_RULES = 32
+MAX_STRINGS = 1024
+NO_TEXT = 0xFFFF
+
+SCREENS = ["main", "stats", "battery", "gauge", "rides", "trip", "diag", "loop", "fleet"]
+
+TYPES = ["label", "hline", "vline", "frame", "value", "bar", "graph", "status", "cells"]
+
+# TelemetryFieldId order: (name, raw units per shown unit, sample raw value)
+FIELDS = [
+    ("speed", 1000, 18400), ("avg_speed", 1000, 14200), ("current", 100, 1235),
+    ("voltage", 100, 3962), ("power", 1, 489), ("range", 100, 1850),
+    ("temp_esc", 10, 412), ("temp_bms1", 1, 29), ("temp_bms2", 1, 30),
+    ("battery", 1, 72), ("cap_remain", 1, 5120), ("cap_full", 1, 7650),
+    ("odometer", 1000, 1234567), ("trip", 1000, 8420), ("ride_time", 1, 1843),
+    ("error", 1, 0), ("mode", 1, 1), ("flags", 1, 0x10), ("rssi", 1, -62),
+] + [("cell%d" % i, 1000, 3960 + (i % 3) * 4) for i in range(16)]
+
+# LayoutField, from 0x80
+DERIVED = [
+    ("speed_shown", 1, 18), ("temp_bms", 10, 295), ("avg_trip_speed", 10, 164),
+    ("trip_max_speed", 1, 27), ("imbalance", 1, 8),
+]
+
+GRAPHS = ["power", "current", "speed", "voltage", "temp_esc", "temp_bms", "imbalance"]
+
+ALERT_INPUTS = ["temp_esc", "temp_bms", "imbalance", "sag"]
+SEVERITIES = ["none", "info", "warn", "crit"]
+
+COLORS = {
+    "bg": 0x0000, "black": 0x0000, "orange": 0xFD20, "white": 0xFFFF,
+    "green": 0x07E0, "yellow": 0xFFE0, "red": 0xF800, "gray": 0x7BEF,
+    "darkgray": 0x4208, "cyan": 0x07FF, "blue": 0x001F,
+}
+
+DATUMS = ["tl", "tc", "tr", "ml", "mc", "mr", "bl", "bc", "br"]
+
+# TFT_eSPI built-in fonts: height, approximate advance per character
+FONTS = {1: (8, 6), 2: (16, 9), 4: (26, 14), 6: (48, 26), 7: (48, 32), 8: (75, 55)}
+
+FLAG_ABS = 0x01
+FLAG_TIME = 0x02
+
+OP_LT, OP_GT, OP_ALERT = 0, 1, 2
+
+
+class LayoutError(Exception):
+    pass
+
+
+def parse_color(text):
+    if text in COLORS:
+        return COLORS[text]
+    if text.startswith("#") and len(text) == 7:
+        r, g, b = (int(text[i:i + 2], 16) for i in (1, 3, 5))
+        return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+    if text.startswith("0x"):
+        return int(text, 16) & 0xFFFF
+    raise LayoutError("unknown colour '%s'" % text)
+
+
+def parse_field(name, kind):
+    if kind == "graph":
+        if name not in GRAPHS:
+            raise LayoutError("unknown graph channel '%s'" % name)
+        return GRAPHS.index(name)
+    for i, f in enumerate(FIELDS):
+        if f[0] == name:
+            return i
+    for i, f in enumerate(DERIVED):
+        if f[0] == name:
+            return 0x80 + i
+    raise LayoutError("unknown field '%s'" % name)
+
+
+def field_info(field):
+    return FIELDS[field] if field < 0x80 else DERIVED[field - 0x80]
+
+
+def parse_pair(text):
+    a, b = text.split(",")
+    return int(a), int(b)
+
+
+def parse_rule(text):
+    """'<0:green', '>600:red', 'alert(temp_esc)>=warn:red'"""
+    cond, _, color = text.rpartition(":")
+    color = parse_color(color)
+    if cond.startswith("alert("):
+        name, _, level = cond[6:].partition(")>=")
+        if name not in ALERT_INPUTS or level not in SEVERITIES:
+            raise LayoutError("bad alert rule '%s'" % text)
+        return (OP_ALERT, ALERT_INPUTS.index(name), color, SEVERITIES.index(level))
+    if cond[:1] in "<>" and cond[1:].lstrip("-").isdigit():
+        return (OP_LT if cond[0] == "<" else OP_GT, 0, color, int(cond[1:]))
+    raise LayoutError("bad rule '%s'" % text)
+
+
+def new_widget(kind):
+    return {"type": TYPES.index(kind), "kind": kind, "field": 0, "font": 2, "datum": 0,
+            "x": 0, "y": 0, "w": 0, "h": 0, "color": COLORS["white"], "decimals": 0,
+            "flags": 0, "rules": [], "text": None, "deadband": 0, "span": 0}
+
+
+def parse_widget(kind, args):
+    wd = new_widget(kind)
+    if kind == "label":
+        if not args:
+            raise LayoutError("label needs its text")
+        wd["text"] = args.pop(0)
+    elif kind in ("value", "bar", "graph"):
+        if not args or "=" in args[0]:
+            raise LayoutError("%s needs a field" % kind)
+        wd["field"] = parse_field(args.pop(0), kind)
+    if kind in ("hline", "vline", "frame", "bar", "graph"):
+        wd["color"] = COLORS["darkgray"] if kind != "bar" else COLORS["green"]
+
+    for arg in args:
+        key, eq, val = arg.partition("=")
+        if not eq and key in ("abs", "time"):
+            wd["flags"] |= FLAG_ABS if key == "abs" else FLAG_TIME
+        elif key == "at":
+            wd["x"], wd["y"] = parse_pair(val)
+        elif key == "size":
+            wd["w"], wd["h"] = parse_pair(val)
+        elif key in ("w", "h", "decimals", "deadband", "span"):
+            wd[key] = int(val)
+        elif key == "font":
+            wd["font"] = int(val)
+            if wd["font"] not in FONTS:
+                raise LayoutError("font %s is not on the panel" % val)
+        elif key == "align":
+            if val not in DATUMS:
+                raise LayoutError("bad align '%s'" % val)
+            wd["datum"] = DATUMS.index(val)
+        elif key == "color":
+            wd["color"] = parse_color(val)
+        elif key == "when":
+            wd["rules"].append(parse_rule(val))
+        elif key in ("suffix", "label"):
+            wd["text"] = val
+        else:
+            raise LayoutError("unknown option '%s'" % arg)
+
+    if kind == "bar" and wd["span"] <= 0:
+        raise LayoutError("bar needs span=")
+    if kind == "value" and wd["w"] <= 0:
+        raise LayoutError("value needs w= for its clear box")
+    if wd["decimals"] > 4:
+        raise LayoutError("at most 4 decimals")
+    return wd
+
+
+def parse(path):
+    screens = []
+    with open(path) as f:
+        lines = f.read().splitlines()
+    pending = None
+    for num, raw in enumerate(lines, 1):
+        line = raw.rstrip()
+        if not line or line.lstrip().startswith("#"):
+            continue
+        # Indented lines continue the widget above
+        if line[0].isspace() and pending:
+            pending[1].extend(shlex.split(line, comments=True))
+            continue
+        if pending:
+            screens[-1][1].append(build(*pending))
+        try:
+            tokens = shlex.split(line, comments=True)
+        except ValueError as e:
+            raise LayoutError("%s:%d: %s" % (path, num, e))
+        if not tokens:
+            pending = None
+            continue
+        kind = tokens[0]
+        if kind == "screen":
+            if len(tokens) != 2 or tokens[1] not in SCREENS:
+                raise LayoutError("%s:%d: screen is one of %s" % (path, num, " ".join(SCREENS)))
+            screens.append((SCREENS.index(tokens[1]), []))
+            pending = None
+            continue
+        if kind not in TYPES:
+            raise LayoutError("%s:%d: unknown widget '%s'" % (path, num, kind))
+        if not screens:
+            raise LayoutError("%s:%d: widget before the first 'screen'" % (path, num))
+        pending = (kind, tokens[1:], "%s:%d" % (path, num))
+    if pending:
+        screens[-1][1].append(build(*pending))
+    return screens
+
+
+def build(kind, args, where):
+    try:
+        return parse_widget(kind, list(args))
+    except (LayoutError, ValueError) as e:
+        raise LayoutError("%s: %s" % (where, e))
+
+
+def compile_blob(screens):
+    if not screens or len(screens) > MAX_SCREENS:
+        raise LayoutError("1 to %d screens" % MAX_SCREENS)
+    if len(set(s for s, _ in screens)) != len(screens):
+        raise LayoutError("a screen is listed twice")
+
+    widgets, rules = [], []
+    strings = bytearray()
+    offsets = {}
+
+    def intern(text):
+        if text is None:
+            return NO_TEXT
+        if text not in offsets:
+            offsets[text] = len(strings)
+            strings.extend(text.encode() + b"\0")
+        return offsets[text]
+
+    table = bytearray()
+    for screen, items in screens:
+        table += struct.pack("<BBBB", screen, len(widgets), len(items), 0)
+        for wd in items:
+            first = len(rules)
+            rules.extend(wd["rules"])
+            widgets.append(struct.pack(
+                "<BBBBhhHHHBBBBHHH", wd["type"], wd["field"], wd["font"], wd["datum"],
+                wd["x"], wd["y"], wd["w"], wd["h"], wd["color"], wd["decimals"], wd["flags"],
+                first, len(wd["rules"]), intern(wd["text"]), wd["deadband"], wd["span"]))
+
+    if len(widgets) > MAX_WIDGETS or len(rules) > MAX_RULES or len(strings) > MAX_STRINGS:
+        raise LayoutError("too large: %d widgets (max %d), %d rules (max %d), %d string bytes (max %d)"
+                          % (len(widgets), MAX_WIDGETS, len(rules), MAX_RULES, len(strings), MAX_STRINGS))
+
+    blob = bytearray(b"M365LYT\0")
+    blob += struct.pack("<HBBBBH", VERSION, len(screens), len(widgets), len(rules), 0, len(strings))
+    blob += table
+    for w in widgets:
+        blob += w
+    for op, arg, color, value in rules:
+        blob += struct.pack("<BBHi", op, arg, color, value)
+    blob += strings
+    blob += struct.pack("<I", zlib.crc32(blob) & 0xFFFFFFFF)
+    return bytes(blob)
+
+
+# ========== Preview ==========
+
+def sample_text(wd):
+    name, scale, raw = field_info(wd["field"])
+    if wd["flags"] & FLAG_ABS:
+        raw = abs(raw)
+    if wd["flags"] & FLAG_TIME:
+        h, rem = divmod(raw, 3600)
+        text = ("%d:%02d:%02d" % (h, rem // 60, rem % 60)) if h else "%02d:%02d" % (rem // 60, rem % 60)
+    else:
+        shown = raw / scale
+        text = "%.*f" % (wd["decimals"], shown) if wd["decimals"] else str(int(round(shown)))
+    return text + (wd["text"] or "")
+
+
+def sample_color(wd):
+    raw = field_info(wd["field"])[2]
+    for op, _, color, value in wd["rules"]:
+        if (op == OP_LT and raw < value) or (op == OP_GT and raw > value):
+            return color
+    return wd["color"]
+
+
+def css(c):
+    r, g, b = (c >> 11) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3
+    return "#%02x%02x%02x" % (r, g, b)
+
+
+def svg_text(x, y, text, font, datum, color):
+    anchor = ["start", "middle", "end"][datum % 3]
+    base = ["hanging", "central", "text-after-edge"][datum // 3]
+    size = FONTS[font][0]
+    text = text.replace("&", "&amp;").replace("<", "&lt;")
+    return ('<text x="%d" y="%d" font-size="%d" fill="%s" text-anchor="%s" dominant-baseline="%s">%s</text>'
+            % (x, y, size, css(color), anchor, base, text))
+
+
+def preview(screens, path):
+    parts = []
+    for row, (screen, items) in enumerate(screens):
+        oy = row * 250
+        parts.append('<g transform="translate(0,%d)">' % oy)
+        parts.append('<rect width="320" height="240" fill="#000"/>')
+        parts.append('<text x="325" y="12" font-size="10" fill="#888">%s</text>' % SCREENS[screen])
+        for wd in items:
+            k, x, y, w, h = wd["kind"], wd["x"], wd["y"], wd["w"], wd["h"]
+            if k == "label":
+                parts.append(svg_text(x, y, wd["text"], wd["font"], wd["datum"], wd["color"]))
+            elif k == "hline":
+                parts.append('<rect x="%d" y="%d" width="%d" height="1" fill="%s"/>' % (x, y, w, css(wd["color"])))
+            elif k == "vline":
+                parts.append('<rect x="%d" y="%d" width="1" height="%d" fill="%s"/>' % (x, y, h, css(wd["color"])))
+            elif k in ("frame", "graph"):
+                parts.append('<rect x="%d.5" y="%d.5" width="%d" height="%d" fill="none" stroke="%s"/>'
+                             % (x, y, w - 1, h - 1, css(COLORS["darkgray"] if k == "graph" else wd["color"])))
+                if k == "graph":
+                    pts = " ".join("%d,%d" % (x + 5 + i * (w - 10) // 20, y + h - 8 - (h - 25) * ((i * 7) % 11) // 10)
+                                   for i in range(21))
+                    parts.append('<polyline points="%s" fill="none" stroke="%s"/>' % (pts, css(wd["color"])))
+                    parts.append(svg_text(x + 5, y + 3, wd["text"] or "", 1, 0, wd["color"]))
+            elif k == "value":
+                text = sample_text(wd)
+                est = len(text) * FONTS[wd["font"]][1]
+                if est > w:
+                    sys.stderr.write("warning: %s '%s' is ~%d px in a %d px box\n"
+                                     % (field_info(wd["field"])[0], text, est, w))
+                parts.append(svg_text(x, y, text, wd["font"], wd["datum"], sample_color(wd)))
+            elif k == "bar":
+                _, _, raw = field_info(wd["field"])
+                fill = max(0, min(w, raw * w // wd["span"]))
+                parts.append('<rect x="%d" y="%d" width="%d" height="%d" fill="%s"/>' % (x, y, fill, h, css(sample_color(wd))))
+                parts.append('<rect x="%d" y="%d" width="%d" height="%d" fill="%s"/>'
+                             % (x + fill, y, w - fill, h, css(COLORS["darkgray"])))
+            elif k == "status":
+                parts.append(svg_text(8, 6, "BLE  LIGHT  CC  ECO", 2, 0, COLORS["cyan"]))
+                parts.append(svg_text(290, 6, "72%", 2, 0, COLORS["white"]))
+            elif k == "cells":
+                for i in range(10):
+                    parts.append(svg_text(5 + (i % 5) * 63, 154 + (i // 5) * 22, "%.2fV" % (FIELDS[19 + i][2] / 1000),
+                                          2, 0, COLORS["green"]))
+        parts.append("</g>")
+    height = len(screens) * 250 - 10
+    with open(path, "w") as f:
+        f.write('<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" viewBox="0 0 380 %d" '
+                'font-family="monospace">\n' % (760, height * 2, height))
+        f.write("\n".join(parts))
+        f.write("\n</svg>\n")
+
+
+def write_header(blob, path, name):
+    rows = ["    " + ", ".join("0x%02X" % b for b in blob[i:i + 12]) + "," for i in range(0, len(blob), 12)]
+    guard = name.upper() + "_H"
+    with open(path, "w") as f:
+        f.write("#ifndef %s\n#define %s\n\n#include <stdint.h>\n\n" % (guard, guard))
+        f.write("// Generated by tools/layout_compile.py - do not edit by hand.\n")
+        f.write("static const uint8_t %s[%d] = {\n%s\n};\n\n#endif\n" % (name, len(blob), "\n".join(rows)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source")
+    ap.add_argument("-o", "--out", help="blob to write (data/layout.bin for uploadfs)")
+    ap.add_argument("--svg", help="preview of every screen with sample values")
+    ap.add_argument("--header", help="also write the blob as a C array")
+    ap.add_argument("--name", default="LAYOUT_BLOB", help="array name for --header")
+    args = ap.parse_args()
+
+    try:
+        screens = parse(args.source)
+        blob = compile_blob(screens)
+    except LayoutError as e:
+        sys.exit("error: %s" % e)
+
+    if args.out:
+        with open(args.out, "wb") as f:
+            f.write(blob)
+    if args.header:
+        write_header(blob, args.header, args.name)
+    if args.svg:
+        preview(screens, args.svg)
+
+    counts = ", ".join("%s %d" % (SCREENS[s], len(items)) for s, items in screens)
+    sys.stderr.write("%d bytes: %s\n" % (len(blob), counts))
+
+
+if __name__ == "__main__":
+    main()
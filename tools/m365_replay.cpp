@@ -0,0 +1,136 @@
+// Host replay of a raw BLE notification capture (*.CAP)
+//
+//   g++ -O2 -Iinclude tools/m365_replay.cpp src/M365Protocol.cpp src/CellPack.cpp src/M365Replay.cpp src/TelemetryFields.cpp -o m365_replay
+//   ./m365_replay ride.cap                 parse as fast as possible, print rates
+//   ./m365_replay ride.cap --repeat 50     same, 50 passes (steadier numbers)
+//   ./m365_replay ride.cap --csv out.csv   one row per decoded frame
+//   ./m365_replay ride.cap --realtime      honour the capture timestamps
+//
+// Runs the firmware's own M365Protocol and M365Replay, so a parser change
+// can be checked against a recorded ride without a scooter. Captures come
+// from /captures on the SD card or from tools/stream_reader.py --capture.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "M365Protocol.h"
+#include "M365Replay.h"
+#include "TelemetryFields.h"
+
+struct MemReader {
+    const std::vector<uint8_t>* data;
+    size_t pos;
+};
+
+static size_t readMem(void* ctx, uint8_t* buf, size_t len) {
+    MemReader* r = static_cast<MemReader*>(ctx);
+    size_t left = r->data->size() - r->pos;
+    if (len > left) len = left;
+    memcpy(buf, r->data->data() + r->pos, len);
+    r->pos += len;
+    return len;
+}
+
+static void writeCsvRow(FILE* csv, uint32_t timeMs, const ScooterData& d) {
+    fprintf(csv, "%u", timeMs);
+    for (uint8_t i = 0; i < TF_COUNT; i++) {
+        fprintf(csv, ",%d", telemetryValue(d, i));
+    }
+    fputc('\n', csv);
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* csvPath = nullptr;
+    bool realtime = false;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--realtime")) realtime = true;
+        else if (!strcmp(argv[i], "--csv") && i + 1 < argc) csvPath = argv[++i];
+        else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !path) path = argv[i];
+        else {
+            fprintf(stderr, "usage: %s capture.cap [--realtime] [--csv out.csv] [--repeat N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!path || repeat < 1) {
+        fprintf(stderr, "usage: %s capture.cap [--realtime] [--csv out.csv] [--repeat N]\n", argv[0]);
+        return 2;
+    }
+
+    // Load up front so the timing measures the parser, not the disk
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    FILE* csv = nullptr;
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) {
+            perror(csvPath);
+            return 1;
+        }
+        fprintf(csv, "time_ms");
+        for (uint8_t i = 0; i < TF_COUNT; i++) fprintf(csv, ",%s", TELEMETRY_FIELDS[i].name);
+        fputc('\n', csv);
+    }
+
+    M365Protocol protocol;
+    M365Replay replay(protocol);
+
+    uint64_t records = 0, bytes = 0;
+    uint32_t duration = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int pass = 0; pass < repeat; pass++) {
+        MemReader reader = { &data, 0 };
+        if (!replay.begin(readMem, &reader)) {
+            fprintf(stderr, "%s: not a capture file\n", path);
+            return 1;
+        }
+
+        auto passStart = std::chrono::steady_clock::now();
+        uint32_t lastFrames = protocol.getFrames();
+        for (;;) {
+            uint32_t elapsed = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - passStart).count();
+            // One record at a time when writing CSV so every frame gets a row
+            int32_t fed = replay.feed(elapsed, realtime, csv ? 1 : 256);
+            if (fed < 0) break;
+            if (csv && protocol.getFrames() != lastFrames) {
+                lastFrames = protocol.getFrames();
+                writeCsvRow(csv, replay.getDuration(), protocol.data());
+            }
+            if (realtime && fed == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        records += replay.getRecords();
+        bytes += replay.getBytes();
+        duration = replay.getDuration();
+    }
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (csv) fclose(csv);
+
+    printf("%llu notifications, %llu bytes, %u frames, %u fields (%d pass%s, capture %.1f s)\n",
+           (unsigned long long)records, (unsigned long long)bytes,
+           protocol.getFrames(), protocol.getFields(), repeat, repeat == 1 ? "" : "es", duration / 1000.0);
+    if (!realtime && secs > 0) {
+        printf("%.3f s: %.0f frames/s, %.0f fields/s, %.1f MB/s\n",
+               secs, protocol.getFrames() / secs, protocol.getFields() / secs, bytes / secs / 1e6);
+    }
+    return 0;
+}
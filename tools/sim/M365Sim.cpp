@@ -0,0 +1,196 @@
+#include "M365Sim.h"
+#include <math.h>
+#include <string.h>
+
+#define RIDER_MASS_KG   100.0
+#define CDA_M2          0.5
+#define CRR             0.012
+#define MOTOR_EFF       0.85
+#define MOTOR_MAX_W     600.0
+#define REGEN_MAX_W     150.0
+#define IDLE_W          3.0
+#define CELL_R_OHM      0.03
+#define AMBIENT_C       22.0
+
+// 18650 open-circuit voltage by state of charge
+static double cellOcv(double soc) {
+    static const double points[][2] = {
+        { 0.0, 3.00 }, { 0.1, 3.45 }, { 0.2, 3.55 }, { 0.5, 3.70 }, { 0.8, 3.95 }, { 1.0, 4.15 }
+    };
+    if (soc <= 0) return points[0][1];
+    for (int i = 1; i < 6; i++) {
+        if (soc <= points[i][0]) {
+            double f = (soc - points[i - 1][0]) / (points[i][0] - points[i - 1][0]);
+            return points[i - 1][1] + f * (points[i][1] - points[i - 1][1]);
+        }
+    }
+    return points[5][1];
+}
+
+M365Sim::M365Sim(uint32_t seed, uint8_t cellCount)
+    : rng(seed), phase(PHASE_STOPPED), phaseUntil(2000), lastStep(0), target(0), speed(0),
+      current(0), voltage(0), cells(cellCount > SIM_CELLS_MAX ? SIM_CELLS_MAX : cellCount),
+      tempEsc(AMBIENT_C), tempBms(AMBIENT_C), odometer(1234567),
+      trip(0), rideSeconds(0), error(0), errorUntil(0), rejected(0), speedNoise(0) {
+    memset(esc, 0, sizeof(esc));
+    memset(bms, 0, sizeof(bms));
+
+    socPack = rng.range(0.6, 0.95);
+    for (int i = 0; i < cells; i++) {
+        cellSoc[i] = socPack + rng.range(-0.01, 0.01);
+        cellCapScale[i] = rng.range(0.98, 1.02);
+        cellR[i] = CELL_R_OHM * rng.range(0.9, 1.1);
+    }
+    battery(0);
+    publish();
+}
+
+void M365Sim::injectError(uint8_t code, uint32_t untilMs) {
+    error = code;
+    errorUntil = untilMs;
+}
+
+void M365Sim::step(uint32_t now) {
+    while (now - lastStep >= SIM_STEP_MS) {
+        lastStep += SIM_STEP_MS;
+        double dt = SIM_STEP_MS / 1000.0;
+        ride(dt, lastStep);
+        battery(dt);
+    }
+    if (error && now >= errorUntil) error = 0;
+    publish();
+}
+
+void M365Sim::ride(double dt, uint32_t now) {
+    double a = 0;
+    switch (phase) {
+        case PHASE_STOPPED:
+            if (now >= phaseUntil) {
+                phase = PHASE_ACCEL;
+                target = rng.range(4.0, 7.0);
+            }
+            break;
+
+        case PHASE_ACCEL:
+            a = fmin(rng.range(1.0, 1.4), (target - speed) / dt);
+            if (speed >= target - 0.05) {
+                phase = PHASE_CRUISE;
+                phaseUntil = now + (uint32_t)rng.range(10000, 60000);
+            }
+            break;
+
+        case PHASE_CRUISE:
+            // Rider wobbles around the target, with the odd hill
+            target += rng.range(-0.02, 0.02);
+            if (target < 3.0) target = 3.0;
+            if (target > 7.5) target = 7.5;
+            a = fmax(-0.5, fmin(0.5, (target - speed) * 0.5));
+            if (now >= phaseUntil) phase = PHASE_BRAKE;
+            break;
+
+        case PHASE_BRAKE:
+            a = -2.0;
+            if (speed <= 0) {
+                phase = PHASE_STOPPED;
+                phaseUntil = now + (uint32_t)rng.range(3000, 20000);
+            }
+            break;
+    }
+
+    speed += a * dt;
+    if (speed < 0) speed = 0;
+
+    double force = RIDER_MASS_KG * a + 0.5 * 1.2 * CDA_M2 * speed * speed;
+    if (speed > 0.05) force += CRR * RIDER_MASS_KG * 9.81;
+    double mech = force * speed;
+    double elec = mech >= 0 ? fmin(mech / MOTOR_EFF, MOTOR_MAX_W) : fmax(mech * 0.6, -REGEN_MAX_W);
+    current = (elec + IDLE_W) / (voltage > 1 ? voltage : 36.0);
+
+    odometer += speed * dt;
+    trip += speed * dt;
+    if (speed > 0) rideSeconds += dt;
+}
+
+void M365Sim::battery(double dt) {
+    double ah = current * dt / 3600.0;
+    double capAh = SIM_CAPACITY_MAH / 1000.0;
+    socPack -= ah / capAh;
+
+    voltage = 0;
+    for (int i = 0; i < cells; i++) {
+        // Mismatched cells drift apart as the pack is used
+        cellSoc[i] -= ah / (capAh * cellCapScale[i]);
+        voltage += cellOcv(cellSoc[i]) - current * cellR[i];
+    }
+
+    tempEsc += dt * (current * current * 0.0005 - (tempEsc - AMBIENT_C) * 0.004);
+    tempBms += dt * (current * current * 0.00005 - (tempBms - AMBIENT_C) * 0.001);
+}
+
+void M365Sim::publish() {
+    double socClamped = socPack < 0 ? 0 : (socPack > 1 ? 1 : socPack);
+    uint32_t odo = (uint32_t)odometer;
+    uint32_t up = (uint32_t)rideSeconds;
+
+    esc[REG_ESC_ERROR] = error;
+    esc[REG_ESC_MODE] = 0;
+    esc[REG_ESC_BATTERY] = (uint16_t)lround(socClamped * 100);
+    esc[REG_ESC_RANGE] = (uint16_t)(socClamped * 2500);
+    double shownKmh = speed * 3.6;
+    if (speedNoise > 0 && shownKmh > 0) shownKmh = fmax(0, shownKmh + rng.range(-speedNoise, speedNoise));
+    esc[REG_ESC_SPEED] = (uint16_t)(int16_t)lround(shownKmh * 1000);
+    esc[REG_ESC_ODOMETER] = odo & 0xFFFF;
+    esc[REG_ESC_ODOMETER + 1] = odo >> 16;
+    esc[REG_ESC_TRIP] = (uint16_t)trip;
+    esc[REG_ESC_UPTIME] = up & 0xFFFF;
+    esc[REG_ESC_UPTIME + 1] = up >> 16;
+    esc[REG_ESC_FRAME_TEMP] = (uint16_t)(int16_t)lround(tempEsc * 10);
+    esc[REG_ESC_AVERAGE] = rideSeconds > 0 ? (uint16_t)lround(trip / rideSeconds * 3600) : 0;
+
+    bms[REG_BMS_CAPACITY] = (uint16_t)(socClamped * SIM_CAPACITY_MAH);
+    bms[REG_BMS_FULL_CAP] = SIM_CAPACITY_MAH;
+    bms[REG_BMS_CURRENT] = (uint16_t)(int16_t)lround(current * 100);
+    bms[REG_BMS_VOLTAGE] = (uint16_t)lround(voltage * 100);
+    uint8_t t = (uint8_t)lround(tempBms + 20);
+    bms[REG_BMS_TEMP] = t | ((t + 1) << 8);
+    bms[REG_BMS_HEALTH] = 100;
+    for (int i = 0; i < cells; i++) {
+        bms[REG_BMS_CELLS + i] = (uint16_t)lround((cellOcv(cellSoc[i]) - current * cellR[i]) * 1000);
+    }
+}
+
+size_t M365Sim::handle(const uint8_t* cmd, size_t len, uint8_t* reply) {
+    if (len < M365_COMMAND_LEN || cmd[0] != 0x55 || cmd[1] != 0xAA) {
+        rejected++;
+        return 0;
+    }
+    uint8_t pktLen = cmd[2];
+    if (len < (size_t)pktLen + 6 ||
+        (cmd[pktLen + 4] | (cmd[pktLen + 5] << 8)) != M365Protocol::checksum(&cmd[2], pktLen + 2)) {
+        rejected++;
+        return 0;
+    }
+
+    uint8_t addr = cmd[3];
+    uint8_t reg = cmd[5];
+    uint8_t n = cmd[6];
+    if (cmd[4] != CMD_READ || (addr != ADDR_ESC && addr != ADDR_BMS)) return 0;
+
+    const uint16_t* words = addr == ADDR_ESC ? esc : bms;
+    if ((size_t)reg * 2 + n > sizeof(esc) || n > 0x40) n = 0;
+
+    reply[0] = 0x55;
+    reply[1] = 0xAA;
+    reply[2] = n + 2;
+    reply[3] = addr + 3;
+    reply[4] = CMD_READ;
+    reply[5] = reg;
+    for (uint8_t i = 0; i < n; i++) {
+        uint16_t w = words[reg + i / 2];
+        reply[6 + i] = (i & 1) ? w >> 8 : w & 0xFF;
+    }
+    uint16_t sum = M365Protocol::checksum(&reply[2], n + 4);
+    reply[6 + n] = sum & 0xFF;
+    reply[7 + n] = sum >> 8;
+    return 8 + n;
+}
@@ -0,0 +1,94 @@
+#ifndef M365_SIM_H
+#define M365_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "M365Protocol.h"
+
+#define SIM_CELLS_MAX       CELLS_MAX
+#define SIM_STEP_MS         10
+#define SIM_CAPACITY_MAH    7800
+
+// Tiny deterministic PRNG so runs are repeatable from --seed
+class SimRandom {
+public:
+    SimRandom(uint32_t seed = 1) : state(seed ? seed : 1) {}
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    double uniform() { return (next() >> 8) / 16777216.0; }
+    double range(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+    bool chance(double p) { return p > 0 && uniform() < p; }
+
+private:
+    uint32_t state;
+};
+
+enum RidePhase : uint8_t {
+    PHASE_STOPPED,
+    PHASE_ACCEL,
+    PHASE_CRUISE,
+    PHASE_BRAKE
+};
+
+// Virtual M365: a ride model behind the ESC (0x20) and BMS (0x22)
+// register files, answering 55 AA read requests the way the scooter
+// does. Registers are 16-bit words; a read returns 'len' bytes starting
+// at word 'reg'.
+class M365Sim {
+public:
+    // 'cells' in series, 10 for a stock pack
+    M365Sim(uint32_t seed, uint8_t cells = 10);
+
+    void step(uint32_t now);
+
+    // Returns the reply length (0 = no answer, like a real ESC on a bad frame)
+    size_t handle(const uint8_t* cmd, size_t len, uint8_t* reply);
+
+    void injectError(uint8_t code, uint32_t untilMs);
+    // Uniform +-kmh on every speed read, like the hall sensor's jitter
+    void setSpeedNoise(double kmh) { speedNoise = kmh; }
+
+    double speedKmh() const { return speed * 3.6; }
+    double currentA() const { return current; }
+    double packVoltage() const { return voltage; }
+    double soc() const { return socPack; }
+    double distanceM() const { return odometer; }
+    uint32_t getRejected() const { return rejected; }
+
+private:
+    SimRandom rng;
+    uint16_t esc[256];
+    uint16_t bms[256];
+
+    RidePhase phase;
+    uint32_t phaseUntil;
+    uint32_t lastStep;
+    double target;          // m/s
+    double speed;           // m/s
+    double current;         // A, + discharge
+    double voltage;
+    double socPack;
+    uint8_t cells;
+    double cellSoc[SIM_CELLS_MAX];
+    double cellCapScale[SIM_CELLS_MAX];
+    double cellR[SIM_CELLS_MAX];
+    double tempEsc;
+    double tempBms;
+    double odometer;        // m
+    double trip;            // m
+    double rideSeconds;
+    uint8_t error;
+    uint32_t errorUntil;
+    uint32_t rejected;
+    double speedNoise;
+
+    void ride(double dt, uint32_t now);
+    void battery(double dt);
+    void publish();
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "SimLink.h"
+
+SimLink::SimLink(const SimLinkConfig& config, SimRandom& r)
+    : cfg(config), rng(r), up(true), downAt(0), lastUpAt(0), downEvent(0), downEventCount(0),
+      sent(0), lost(0), corrupted(0) {
+    if (cfg.connIntervalMs == 0) cfg.connIntervalMs = 1;
+    if (cfg.mtu == 0) cfg.mtu = 20;
+    if (cfg.perEvent == 0) cfg.perEvent = 1;
+}
+
+void SimLink::setUp(bool on, uint32_t now) {
+    if (on == up) return;
+    up = on;
+    if (!on) {
+        downAt = now;
+        lost += toScooter.size() + toDash.size();
+        toScooter.clear();
+        toDash.clear();
+    }
+}
+
+uint32_t SimLink::nextEvent(uint32_t t) const {
+    uint32_t ci = cfg.connIntervalMs;
+    return (t + ci - 1) / ci * ci;
+}
+
+uint32_t SimLink::delay() {
+    uint32_t d = cfg.latencyMs;
+    if (cfg.jitterMs) d += rng.next() % (cfg.jitterMs + 1);
+    return d;
+}
+
+// Returns false if the packet is lost
+bool SimLink::damage(SimPacket& p) {
+    sent++;
+    if (!up || rng.chance(cfg.loss)) {
+        lost++;
+        return false;
+    }
+    if (cfg.ber > 0) {
+        bool hit = false;
+        for (size_t i = 0; i < p.bytes.size(); i++) {
+            for (uint8_t b = 0; b < 8; b++) {
+                if (rng.chance(cfg.ber)) {
+                    p.bytes[i] ^= 1 << b;
+                    hit = true;
+                }
+            }
+        }
+        if (hit) corrupted++;
+    }
+    return true;
+}
+
+void SimLink::sendUp(uint32_t now, const uint8_t* data, size_t len) {
+    SimPacket p;
+    p.bytes.assign(data, data + len);
+    p.sampledAt = now;
+    p.addr = len > 3 ? data[3] : 0;
+    p.reg = len > 5 ? data[5] : 0;
+    p.last = true;
+    if (!damage(p)) return;
+
+    uint32_t at = nextEvent(now) + delay();
+    if (at < lastUpAt) at = lastUpAt;
+    lastUpAt = at;
+    p.at = at;
+    toScooter.push_back(p);
+}
+
+void SimLink::sendDown(uint32_t now, const uint8_t* data, size_t len, uint32_t sampledAt, uint8_t addr, uint8_t reg) {
+    uint32_t extra = delay();
+    for (size_t off = 0; off < len; off += cfg.mtu) {
+        size_t n = len - off < cfg.mtu ? len - off : cfg.mtu;
+
+        // Fill the current connection event, then move to the next one
+        uint32_t ev = nextEvent(now);
+        if (ev < downEvent) ev = downEvent;
+        if (ev == downEvent && downEventCount >= cfg.perEvent) ev += cfg.connIntervalMs;
+        if (ev != downEvent) {
+            downEvent = ev;
+            downEventCount = 0;
+        }
+        downEventCount++;
+
+        SimPacket p;
+        p.bytes.assign(data + off, data + off + n);
+        p.sampledAt = sampledAt;
+        p.addr = addr;
+        p.reg = reg;
+        p.last = off + n >= len;
+        if (!damage(p)) continue;
+
+        p.at = ev + extra;
+        if (!toDash.empty() && p.at < toDash.back().at) p.at = toDash.back().at;
+        toDash.push_back(p);
+    }
+}
+
+bool SimLink::receiveUp(uint32_t now, SimPacket& out) {
+    if (toScooter.empty() || toScooter.front().at > now) return false;
+    out = toScooter.front();
+    toScooter.pop_front();
+    return true;
+}
+
+bool SimLink::receiveDown(uint32_t now, SimPacket& out) {
+    if (toDash.empty() || toDash.front().at > now) return false;
+    out = toDash.front();
+    toDash.pop_front();
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef SIM_LINK_H
+#define SIM_LINK_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include "M365Sim.h"
+
+struct SimLinkConfig {
+    uint16_t connIntervalMs;    // BLE connection event spacing
+    uint16_t latencyMs;         // extra one-way delay
+    uint16_t jitterMs;          // uniform 0..jitter added per packet
+    double loss;                // probability a packet vanishes
+    double ber;                 // per-bit flip probability
+    uint8_t mtu;                // notification payload size
+    uint8_t perEvent;           // notifications per connection event
+
+    SimLinkConfig()
+        : connIntervalMs(15), latencyMs(0), jitterMs(0), loss(0), ber(0), mtu(20), perEvent(4) {}
+};
+
+struct SimPacket {
+    uint32_t at;                // delivery time
+    std::vector<uint8_t> bytes;
+    uint32_t sampledAt;         // when the scooter read its registers
+    uint8_t addr;
+    uint8_t reg;
+    bool last;                  // final fragment of a reply
+};
+
+// Both directions of a BLE UART link between the dashboard and the
+// scooter. Writes go out on the next connection event, replies are cut
+// into MTU-sized notifications and spread over events at most
+// 'perEvent' at a time. Order is preserved like the real link layer;
+// loss, corruption and outages are injected on top.
+class SimLink {
+public:
+    SimLink(const SimLinkConfig& config, SimRandom& rng);
+
+    void setUp(bool up, uint32_t now);
+    bool isUp() const { return up; }
+    uint32_t downSince() const { return downAt; }
+
+    void sendUp(uint32_t now, const uint8_t* data, size_t len);
+    void sendDown(uint32_t now, const uint8_t* data, size_t len, uint32_t sampledAt, uint8_t addr, uint8_t reg);
+
+    bool receiveUp(uint32_t now, SimPacket& out);
+    bool receiveDown(uint32_t now, SimPacket& out);
+
+    uint32_t getSent() const { return sent; }
+    uint32_t getLost() const { return lost; }
+    uint32_t getCorrupted() const { return corrupted; }
+
+private:
+    SimLinkConfig cfg;
+    SimRandom& rng;
+    bool up;
+    uint32_t downAt;
+
+    std::deque<SimPacket> toScooter;
+    std::deque<SimPacket> toDash;
+    uint32_t lastUpAt;
+    uint32_t downEvent;
+    uint8_t downEventCount;
+
+    uint32_t sent;
+    uint32_t lost;
+    uint32_t corrupted;
+
+    uint32_t nextEvent(uint32_t t) const;
+    uint32_t delay();
+    bool damage(SimPacket& p);
+};
+
+#endif
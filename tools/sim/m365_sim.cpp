@@ -0,0 +1,373 @@
+// Host-side M365 simulator: virtual scooter, BLE link and dashboard
+//
+//   g++ -O2 -Iinclude -Itools/sim tools/sim/*.cpp src/M365Protocol.cpp src/M365Poller.cpp src/CellPack.cpp src/SpeedFilter.cpp -o m365_sim
+//   ./m365_sim --seconds 600
+//   ./m365_sim --loss 0.02 --ber 1e-4 --jitter-ms 20
+//   ./m365_sim --outage-every 120 --outage-ms 6000 --error-every 90
+//   ./m365_sim --cap sim.cap           record what the dashboard received
+//   ./m365_sim --speed-noise 0.3       raw vs filtered speed readout
+//   ./m365_sim --cells 13              extended pack, checks detection
+//
+// The dashboard side runs the firmware's own M365Poller and M365Protocol
+// on the same 10 ms tick as the protocol task, plus the connect/rescan
+// timing of BleTransport. Everything runs in virtual time, so an hour of
+// riding takes well under a second. Reports poll and reply rates, round
+// trip, and how old each value is whenever the UI would draw it. The
+// speed readout is scored both raw and through SpeedFilter: lag and
+// noise against the true speed, and how often the digits change.
+//
+// A --cap file can be copied to the SD card as REPLAY.CAP to put the
+// same traffic through the real UI.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "M365Sim.h"
+#include "SimLink.h"
+#include "M365Poller.h"
+#include "CaptureFormat.h"
+#include "SpeedFilter.h"
+
+#define DASH_TICK_MS            10      // protocol task period
+#define DASH_FRAME_MS           100     // render period while riding
+#define ESC_TURNAROUND_MS       3       // bus round trip inside the scooter
+#define SUPERVISION_MS          4000    // BLE_SUPERVISION_TIMEOUT
+#define RESCAN_MS               5000    // BleTransport retries a scan this often
+#define CONNECT_MS              400     // connect + service discovery
+
+enum DashState { DASH_CONNECTED, DASH_DISCONNECTED, DASH_SCANNING, DASH_CONNECTING };
+
+// Values the UI cares about, with the register that carries them
+struct Tracked {
+    const char* name;
+    uint8_t addr;
+    uint8_t reg;
+};
+
+static const Tracked TRACKED[] = {
+    { "speed",   ADDR_ESC, REG_ESC_SPEED },
+    { "current", ADDR_BMS, REG_BMS_CURRENT },
+    { "battery", ADDR_ESC, REG_ESC_BATTERY },
+    { "cells",   ADDR_BMS, REG_BMS_CELLS },
+    { "escTemp", ADDR_ESC, REG_ESC_FRAME_TEMP },
+    { "odo",     ADDR_ESC, REG_ESC_ODOMETER },
+};
+#define TRACKED_COUNT   (sizeof(TRACKED) / sizeof(TRACKED[0]))
+
+struct Stats {
+    std::vector<double> v;
+    void add(double x) { v.push_back(x); }
+    double mean() const {
+        double s = 0;
+        for (double x : v) s += x;
+        return v.empty() ? 0 : s / v.size();
+    }
+    double pct(double p) {
+        if (v.empty()) return 0;
+        std::sort(v.begin(), v.end());
+        return v[(size_t)(p * (v.size() - 1))];
+    }
+    double max() const { return v.empty() ? 0 : *std::max_element(v.begin(), v.end()); }
+};
+
+// One way of turning speed samples into the readout
+struct Readout {
+    std::vector<double> value;      // km/h behind the digits, per frame
+    std::vector<uint32_t> at;
+    int16_t shown = -1;
+    int8_t lastDir = 0;
+    uint32_t lastChange = 0;
+    uint32_t changes = 0;
+    uint32_t flicker = 0;           // direction reversals within a second
+
+    void frame(uint32_t t, double kmh, int16_t digits) {
+        value.push_back(kmh);
+        at.push_back(t);
+        if (digits == shown) return;
+        int8_t dir = digits > shown ? 1 : -1;
+        if (shown >= 0) {
+            changes++;
+            if (dir == -lastDir && t - lastChange < 1000) flicker++;
+        }
+        lastDir = dir;
+        lastChange = t;
+        shown = digits;
+    }
+};
+
+// Lag is the delay that best lines the readout up with the true speed;
+// noise is what is left over once it's lined up (RMS, km/h)
+static void scoreReadout(const char* name, const Readout& r, const std::vector<double>& truth,
+                         double minutes) {
+    double bestErr = 1e30;
+    uint32_t bestLag = 0;
+    for (uint32_t lag = 0; lag <= 1500; lag += DASH_TICK_MS) {
+        double err = 0;
+        size_t n = 0;
+        for (size_t i = 0; i < r.value.size(); i++) {
+            if (r.at[i] < lag) continue;
+            double d = r.value[i] - truth[(r.at[i] - lag) / DASH_TICK_MS];
+            err += d * d;
+            n++;
+        }
+        if (n && err / n < bestErr) {
+            bestErr = err / n;
+            bestLag = lag;
+        }
+    }
+    printf("        %-8s lag %4u ms  noise %.3f km/h  digit changes %6.1f/min  flicker %5.1f/min\n",
+           name, bestLag, sqrt(bestErr), r.changes / minutes, r.flicker / minutes);
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--seconds N] [--seed N] [--poll-ms N] [--reduced]\n"
+            "          [--conn-ms N] [--latency-ms N] [--jitter-ms N] [--per-event N]\n"
+            "          [--loss P] [--ber P] [--outage-every S] [--outage-ms N]\n"
+            "          [--error-every S] [--speed-noise KMH] [--cells N] [--cap out.cap]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    uint32_t seconds = 600;
+    uint32_t seed = 1;
+    uint16_t pollMs = POLL_INTERVAL_DEFAULT;
+    bool reduced = false;
+    uint32_t outageEvery = 0, outageMs = 6000, errorEvery = 0;
+    const char* capPath = nullptr;
+    double speedNoise = 0;
+    uint8_t cells = 10;
+    SimLinkConfig link;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!strcmp(a, "--reduced")) { reduced = true; continue; }
+        if (!v) usage(argv[0]);
+        i++;
+        if (!strcmp(a, "--seconds")) seconds = atoi(v);
+        else if (!strcmp(a, "--seed")) seed = atoi(v);
+        else if (!strcmp(a, "--poll-ms")) pollMs = atoi(v);
+        else if (!strcmp(a, "--conn-ms")) link.connIntervalMs = atoi(v);
+        else if (!strcmp(a, "--latency-ms")) link.latencyMs = atoi(v);
+        else if (!strcmp(a, "--jitter-ms")) link.jitterMs = atoi(v);
+        else if (!strcmp(a, "--per-event")) link.perEvent = atoi(v);
+        else if (!strcmp(a, "--loss")) link.loss = atof(v);
+        else if (!strcmp(a, "--ber")) link.ber = atof(v);
+        else if (!strcmp(a, "--outage-every")) outageEvery = atoi(v);
+        else if (!strcmp(a, "--outage-ms")) outageMs = atoi(v);
+        else if (!strcmp(a, "--error-every")) errorEvery = atoi(v);
+        else if (!strcmp(a, "--speed-noise")) speedNoise = atof(v);
+        else if (!strcmp(a, "--cells")) cells = atoi(v);
+        else if (!strcmp(a, "--cap")) capPath = v;
+        else usage(argv[0]);
+    }
+
+    SimRandom rng(seed * 2654435761u);
+    M365Sim scooter(seed, cells);
+    scooter.setSpeedNoise(speedNoise);
+    SimLink bleLink(link, rng);
+    M365Protocol protocol;
+    M365Poller poller;
+    poller.setInterval(pollMs);
+    poller.setReduced(reduced);
+
+    FILE* cap = nullptr;
+    if (capPath) {
+        cap = fopen(capPath, "wb");
+        if (!cap) {
+            perror(capPath);
+            return 1;
+        }
+        uint8_t header[CAPTURE_HEADER_BYTES];
+        captureWriteHeader(header);
+        fwrite(header, 1, sizeof(header), cap);
+    }
+
+    DashState state = DASH_CONNECTED;
+    uint32_t stateAt = 0;
+    uint32_t lastScan = 0;
+    uint32_t outageEnd = 0;
+    uint32_t reconnects = 0;
+    bool awaitingFresh = false;
+    uint32_t linkBackAt = 0;
+
+    uint32_t fresh[2][256];
+    uint32_t sentAt[2][256];
+    bool have[2][256];
+    memset(have, 0, sizeof(have));
+    memset(sentAt, 0, sizeof(sentAt));
+
+    Stats rtt, speedErr, recovery;
+    Stats age[TRACKED_COUNT];
+    uint32_t errorsShown = 0, errorsInjected = 0;
+    uint8_t lastError = 0;
+
+    SpeedFilter speedFilter;
+    uint32_t speedSamples = 0;
+    Readout rawReadout, smoothReadout;
+    std::vector<double> trueSpeed;
+
+    static const uint8_t ERROR_CODES[] = { 10, 14, 18, 21, 24 };
+    const uint32_t end = seconds * 1000;
+
+    for (uint32_t t = 0; t <= end; t++) {
+        scooter.step(t);
+
+        // Fault injection
+        if (outageEvery && t > 0 && t % (outageEvery * 1000) == 0 && bleLink.isUp()) {
+            bleLink.setUp(false, t);
+            outageEnd = t + outageMs;
+        }
+        if (!bleLink.isUp() && t >= outageEnd) {
+            bleLink.setUp(true, t);
+            linkBackAt = t;
+            awaitingFresh = true;
+        }
+        if (errorEvery && t > 0 && t % (errorEvery * 1000) == 0) {
+            scooter.injectError(ERROR_CODES[rng.next() % sizeof(ERROR_CODES)], t + 3000);
+            errorsInjected++;
+        }
+
+        // Scooter side
+        SimPacket pkt;
+        while (bleLink.receiveUp(t, pkt)) {
+            uint8_t reply[CAPTURE_MAX_PAYLOAD];
+            size_t n = scooter.handle(pkt.bytes.data(), pkt.bytes.size(), reply);
+            if (n) bleLink.sendDown(t + ESC_TURNAROUND_MS, reply, n, t, pkt.addr + 3, pkt.reg);
+        }
+
+        if (t % DASH_TICK_MS) continue;
+        trueSpeed.push_back(scooter.speedKmh());
+
+        // Dashboard protocol task: drain notifications, then the state machine
+        while (bleLink.receiveDown(t, pkt)) {
+            if (state != DASH_CONNECTED) continue;
+            if (cap) {
+                uint8_t rec[CAPTURE_RECORD_BYTES];
+                captureWriteRecord(rec, pkt.at, pkt.bytes.size());
+                fwrite(rec, 1, sizeof(rec), cap);
+                fwrite(pkt.bytes.data(), 1, pkt.bytes.size(), cap);
+            }
+            uint32_t before = protocol.getFrames();
+            protocol.processResponse(pkt.bytes.data(), pkt.bytes.size());
+            poller.setCellReadLen(protocol.getCellReadLen());
+            if (protocol.getFrames() != before && pkt.last) {
+                uint8_t side = pkt.addr == ADDR_BMS_REPLY;
+                fresh[side][pkt.reg] = pkt.sampledAt;
+                have[side][pkt.reg] = true;
+                rtt.add(t - sentAt[side][pkt.reg]);
+                if (awaitingFresh) {
+                    recovery.add(t - linkBackAt);
+                    awaitingFresh = false;
+                }
+            }
+            if (protocol.getSpeedSamples() != speedSamples) {
+                speedSamples = protocol.getSpeedSamples();
+                speedFilter.add(protocol.data().speedRaw, t);
+            }
+        }
+
+        switch (state) {
+            case DASH_CONNECTED:
+                if (!bleLink.isUp() && t - bleLink.downSince() >= SUPERVISION_MS) {
+                    state = DASH_DISCONNECTED;
+                    stateAt = t;
+                    lastScan = t;
+                    break;
+                }
+                {
+                    M365Request req;
+                    if (poller.due(t, req)) {
+                        uint8_t packet[M365_COMMAND_LEN];
+                        M365Protocol::buildCommand(packet, req.addr, CMD_READ, req.reg, req.len);
+                        sentAt[req.addr == ADDR_BMS][req.reg] = t;
+                        bleLink.sendUp(t, packet, sizeof(packet));
+                    }
+                }
+                break;
+
+            case DASH_DISCONNECTED:
+                if (t - lastScan > RESCAN_MS) {
+                    state = DASH_SCANNING;
+                    stateAt = t;
+                    lastScan = t;
+                }
+                break;
+
+            case DASH_SCANNING:
+                // Advertising is only heard once the radio path is back
+                if (bleLink.isUp() && t - stateAt >= 300) {
+                    state = DASH_CONNECTING;
+                    stateAt = t;
+                } else if (t - stateAt >= 5000) {
+                    state = DASH_DISCONNECTED;
+                    lastScan = t;
+                }
+                break;
+
+            case DASH_CONNECTING:
+                if (t - stateAt >= CONNECT_MS) {
+                    state = DASH_CONNECTED;
+                    reconnects++;
+                    poller.reset(t);
+                    protocol.reset();
+                }
+                break;
+        }
+
+        // Render side: what the rider would see this frame
+        if (t % DASH_FRAME_MS == 0 && state == DASH_CONNECTED && bleLink.isUp()) {
+            for (size_t i = 0; i < TRACKED_COUNT; i++) {
+                uint8_t side = TRACKED[i].addr == ADDR_BMS;
+                if (have[side][TRACKED[i].reg]) age[i].add(t - fresh[side][TRACKED[i].reg]);
+            }
+            speedErr.add(fabs(protocol.data().speedKmh() - scooter.speedKmh()));
+            rawReadout.frame(t, protocol.data().speedKmh(), protocol.data().speedKmhInt());
+            int32_t est = speedFilter.estimate(t);
+            smoothReadout.frame(t, est / 1000.0, SpeedFilter::hold(smoothReadout.shown < 0 ? 0 : smoothReadout.shown, est));
+            uint8_t shown = protocol.data().errorCode;
+            if (shown && shown != lastError) errorsShown++;
+            lastError = shown;
+        }
+    }
+
+    if (cap) fclose(cap);
+
+    double secs = seconds;
+    printf("[SIM] %u s virtual, poll %u ms%s, conn %u ms, latency %u+%u ms, loss %.2f%%, BER %g\n",
+           seconds, pollMs, reduced ? " (reduced)" : "", link.connIntervalMs, link.latencyMs,
+           link.jitterMs, link.loss * 100, link.ber);
+    printf("[SIM] ride: %.1f km, SoC %.0f%%, pack %.2f V\n",
+           scooter.distanceM() / 1000 - 1234.567, scooter.soc() * 100, scooter.packVoltage());
+    const CellPackInfo* pack = protocol.getCellPack();
+    const ScooterData& shown = protocol.data();
+    printf("[SIM] pack: %uS simulated, %uS detected, cells %u-%u mV\n", cells, pack ? pack->cells : 0,
+           shown.minCellMv, shown.maxCellMv);
+    printf("[SIM] polls %u (%.2f/s), replies %u (%.2f/s), bad frames %u\n",
+           poller.getPolls(), poller.getPolls() / secs, protocol.getFrames(),
+           protocol.getFrames() / secs, protocol.getBadFrames());
+    printf("[SIM] link: %u packets, %u lost, %u corrupted, %u commands rejected by ESC\n",
+           bleLink.getSent(), bleLink.getLost(), bleLink.getCorrupted(), scooter.getRejected());
+    printf("[SIM] round trip: mean %.1f ms, p95 %.0f ms\n", rtt.mean(), rtt.pct(0.95));
+    printf("[SIM] age at render (ms):\n");
+    for (size_t i = 0; i < TRACKED_COUNT; i++) {
+        printf("        %-8s mean %6.0f  p95 %6.0f  max %6.0f\n",
+               TRACKED[i].name, age[i].mean(), age[i].pct(0.95), age[i].max());
+    }
+    printf("[SIM] speed error at render: mean %.2f km/h, p95 %.2f km/h\n",
+           speedErr.mean(), speedErr.pct(0.95));
+    printf("[SIM] speed readout (%u ms frames, noise +-%.2f km/h):\n", DASH_FRAME_MS, speedNoise);
+    scoreReadout("raw", rawReadout, trueSpeed, secs / 60);
+    scoreReadout("filtered", smoothReadout, trueSpeed, secs / 60);
+    if (errorsInjected) printf("[SIM] errors: %u injected, %u shown\n", errorsInjected, errorsShown);
+    if (outageEvery) {
+        printf("[SIM] outages: %u reconnects, time to fresh data after link returns: mean %.0f ms, max %.0f ms\n",
+               reconnects, recovery.mean(), recovery.max());
+    }
+    return 0;
+}
@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""Reads the dashboard's binary telemetry stream (SerialStream) over USB.
+
+    tools/stream_reader.py /dev/ttyUSB0             live table
+    tools/stream_reader.py /dev/ttyUSB0 --csv out.csv
+    tools/stream_reader.py /dev/ttyUSB0 --plot speed current
+    tools/stream_reader.py --file capture.bin       decode a raw capture
+    tools/stream_reader.py /dev/ttyUSB0 --capture ride.cap
+
+Sends the start byte on open. Frames are COBS encoded and 0x00
+terminated; anything between frames that fails the CRC is the firmware's
+normal text log and is echoed to stderr.
+
+--capture also asks for the raw BLE notifications and writes them as a
+.CAP file that tools/m365_replay can feed back through the parser.
+"""
+import argparse
+import collections
+import struct
+import sys
+import time
+
+CMD_START = b"\x02"
+CMD_CAPTURE_ON = b"\x04"
+FRAME_SCHEMA, FRAME_KEY, FRAME_DELTA, FRAME_CAPTURE = 1, 2, 3, 4
+CAPTURE_HEADER = b"M365CAP\x00" + struct.pack("<HH", 1, 0)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def varint(buf, pos):
+    value = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if b < 0x80:
+            return value, pos
+        shift += 7
+
+
+class StreamState:
+    """Rebuilds the scooter state from schema, key and delta frames."""
+
+    def __init__(self):
+        self.fields = []        # (name, unit, scale)
+        self.raw = []
+        self.time = 0
+        self.synced = False
+        self.seq = None
+        self.lost = 0
+
+    def feed(self, frame):
+        """Returns True when the state changed."""
+        if len(frame) < 4 or crc16(frame[:-2]) != frame[-2] | frame[-1] << 8:
+            return None
+        kind, seq, body = frame[0], frame[1], frame[2:-2]
+
+        if kind == FRAME_SCHEMA:
+            self.fields = []
+            pos = 1
+            for _ in range(body[0]):
+                scale = body[pos] | body[pos + 1] << 8
+                name = body[pos + 3:pos + 3 + body[pos + 2]].decode()
+                pos += 3 + body[pos + 2]
+                unit = body[pos + 1:pos + 1 + body[pos]].decode()
+                pos += 1 + body[pos]
+                self.fields.append((name, unit, scale))
+            self.raw = [0] * len(self.fields)
+            self.synced = False
+            return False
+
+        if not self.fields:
+            return False
+        if kind == FRAME_DELTA:
+            # A gap means a missed delta; wait for the next key frame
+            if not self.synced or self.seq is None or seq != (self.seq + 1) & 0xFF:
+                self.synced = False
+                self.lost += 1
+                self.seq = seq
+                return False
+        elif kind == FRAME_KEY:
+            self.raw = [0] * len(self.fields)
+            self.synced = True
+        else:
+            return None
+
+        self.seq = seq
+        self.time, pos = varint(body, 0)
+        mask, pos = varint(body, pos)
+        for i in range(len(self.fields)):
+            if mask & (1 << i):
+                z, pos = varint(body, pos)
+                self.raw[i] += (z >> 1) ^ -(z & 1)
+        return True
+
+    def value(self, i):
+        scale = self.fields[i][2]
+        return self.raw[i] / scale if scale != 1 else self.raw[i]
+
+    def named(self):
+        return {f[0]: self.value(i) for i, f in enumerate(self.fields)}
+
+
+def frames(source):
+    """Yields (frame_bytes or None, raw_chunk) split on 0x00."""
+    buf = bytearray()
+    while True:
+        chunk = source()
+        if chunk is None:
+            return
+        buf += chunk
+        while True:
+            end = buf.find(0)
+            if end < 0:
+                break
+            raw = bytes(buf[:end])
+            del buf[:end + 1]
+            yield cobs_decode(raw) if raw else None, raw
+
+
+def print_table(state, out):
+    out.write("\x1b[H\x1b[2J")
+    out.write("t=%.1fs  seq=%s  resyncs=%d\n\n" % (state.time / 1000, state.seq, state.lost))
+    for i, (name, unit, _) in enumerate(state.fields):
+        out.write("%-12s %10s %s\n" % (name, state.value(i), unit))
+    out.flush()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("port", nargs="?")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--file", help="decode a raw capture instead of a port")
+    ap.add_argument("--csv", help="write one row per frame")
+    ap.add_argument("--plot", nargs="+", metavar="FIELD", help="live plot of these fields")
+    ap.add_argument("--capture", help="write raw BLE notifications to a .CAP file")
+    args = ap.parse_args()
+
+    if args.file:
+        data = open(args.file, "rb").read()
+        chunks = iter([data, None])
+        source = lambda: next(chunks)
+    elif args.port:
+        import serial
+        port = serial.Serial(args.port, args.baud, timeout=0.1)
+        port.write(CMD_START)
+        if args.capture:
+            port.write(CMD_CAPTURE_ON)
+        source = lambda: port.read(4096)
+    else:
+        ap.error("need a port or --file")
+
+    state = StreamState()
+    csv = open(args.csv, "w") if args.csv else None
+    header_written = False
+    plot = None
+    if args.plot:
+        import matplotlib.pyplot as plt
+        plt.ion()
+        fig, ax = plt.subplots()
+        series = {f: (collections.deque(maxlen=600), collections.deque(maxlen=600)) for f in args.plot}
+        lines = {f: ax.plot([], [], label=f)[0] for f in args.plot}
+        ax.legend()
+        plot = (plt, ax, series, lines)
+
+    cap = None
+    cap_seq = None
+    cap_lost = 0
+    if args.capture:
+        cap = open(args.capture, "wb")
+        cap.write(CAPTURE_HEADER)
+
+    last_draw = 0
+    text = bytearray()
+    for frame, raw in frames(source):
+        if frame and len(frame) >= 4 and frame[0] == FRAME_CAPTURE \
+                and crc16(frame[:-2]) == frame[-2] | frame[-1] << 8:
+            if cap:
+                if cap_seq is not None and frame[1] != (cap_seq + 1) & 0xFF:
+                    cap_lost += 1
+                cap_seq = frame[1]
+                t, pos = varint(frame, 2)
+                payload = frame[pos:-2]
+                cap.write(struct.pack("<IH", t & 0xFFFFFFFF, len(payload)) + payload)
+            continue
+        changed = state.feed(frame) if frame else None
+        if changed is None:
+            # Not a frame: firmware text log
+            text += raw
+            if b"\n" in text:
+                sys.stderr.write(text.decode(errors="replace"))
+                text.clear()
+            continue
+        if not changed:
+            continue
+
+        if csv:
+            if not header_written:
+                csv.write("time_ms," + ",".join(f[0] for f in state.fields) + "\n")
+                header_written = True
+            csv.write("%d,%s\n" % (state.time, ",".join(str(state.value(i)) for i in range(len(state.fields)))))
+
+        now = time.monotonic()
+        if plot:
+            plt, ax, series, lines = plot
+            values = state.named()
+            for f in args.plot:
+                series[f][0].append(state.time / 1000)
+                series[f][1].append(values.get(f, 0))
+            if now - last_draw > 0.2:
+                for f in args.plot:
+                    lines[f].set_data(*series[f])
+                ax.relim()
+                ax.autoscale_view()
+                plt.pause(0.001)
+                last_draw = now
+        elif not csv and now - last_draw > 0.2:
+            print_table(state, sys.stdout)
+            last_draw = now
+
+    if csv:
+        csv.close()
+    if cap:
+        cap.close()
+        sys.stderr.write("%d capture gaps\n" % cap_lost)
+    sys.stderr.write("%d resyncs\n" % state.lost)
+
+
+if __name__ == "__main__":
+    main()